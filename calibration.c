@@ -0,0 +1,389 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * On-target calibration of the workload's costs, for the host simulator's
+ * timing model (host/host_sim.c). Timer_A1 counts MCLK cycles directly
+ * (SMCLK = MCLK = DCO, undivided) while the fixture's own code runs on a
+ * scratch instance. Each measurement is split into batches short enough for
+ * the 16-bit counter. Only the P8.1 power-loss interrupt is masked; the
+ * uptime timer keeps running as it does during a real run, so its share is
+ * part of the measured costs.
+ *
+ * The profile is printed as key=value lines; capture the console output and
+ * hand it to the simulator with -P.
+ *
+ * The AES benchmark times chunks of blocks through each of the stream's AES
+ * engines in every cipher mode, to show what pipelining the module buys.
+ */
+
+#include <stddef.h>
+#include "driverlib.h"
+#include "calibration.h"
+#include "checkpointing_test_fixture.h"
+#include "checkpoint.h"
+#include "utils.h"
+
+// Batches per measurement, averaged
+#define CALIBRATION_BATCHES             (32)
+// AES blocks per batch, one AES256_encryptBlocks() call, ~15k cycles
+#define CALIBRATION_AES_BLOCKS          (64)
+// Single block chunks per batch
+#define CALIBRATION_SMALL_CHUNKS        (16)
+// Size of the chunk whose per-block cost is measured
+#define CALIBRATION_LARGE_CHUNK_SIZE    (1024UL)
+// Dead-time measured, and waits per batch
+#define CALIBRATION_DEAD_TIME_US        (100)
+#define CALIBRATION_DEAD_TIMES          (16)
+// Checkpoint commits per batch
+#define CALIBRATION_CHECKPOINTS         (16)
+#define CALIBRATION_CYCLES_PER_US       (16)
+// Blocks per AES engine benchmark batch
+#define CALIBRATION_BENCH_BLOCKS        (64)
+
+typedef enum
+{
+    CALIBRATION_EMPTY = 0,
+    CALIBRATION_AES = 1,
+    CALIBRATION_SMALL_CHUNK = 2,
+    CALIBRATION_LARGE_CHUNK = 3,
+    CALIBRATION_LOOP_TAIL = 4,
+    CALIBRATION_DEAD_TIME = 5,
+    CALIBRATION_CHECKPOINT = 6,
+} calibrationItem_e;
+
+// Scratch checkpoint store in FRAM, so the fixture's own checkpoint is left
+// alone
+#pragma PERSISTENT(calibrationStore)
+static checkpointStore_t calibrationStore = {0};
+
+/**
+ * @brief      Time one batch of an item, in MCLK cycles
+ */
+static uint16_t Calibration_TimeBatch(calibrationItem_e item, checkpointingObj_t *ctx)
+{
+    uint16_t start;
+    uint16_t end;
+    uint16_t i;
+    uint32_t progressTicks = 0;
+    uint32_t checkpointStart;
+    // Encrypted in place, FRAM to FRAM as a run of the blocking engine goes
+    uint16_t *blocks = (uint16_t *)cipherDestination;
+    volatile bool sink;
+
+    start = Timer_A_getCounterValue(TIMER_A1_BASE);
+    switch (item)
+    {
+        case CALIBRATION_EMPTY:
+        {
+            break;
+        }
+        case CALIBRATION_AES:
+        {
+            AES256_encryptBlocks(AES256_BASE, blocks, blocks, CALIBRATION_AES_BLOCKS);
+            break;
+        }
+        case CALIBRATION_SMALL_CHUNK:
+        {
+            for (i = 0; i < CALIBRATION_SMALL_CHUNKS; i++)
+            {
+                Checkpointing_DoChunk(ctx);
+            }
+            break;
+        }
+        case CALIBRATION_LARGE_CHUNK:
+        {
+            Checkpointing_DoChunk(ctx);
+            break;
+        }
+        case CALIBRATION_LOOP_TAIL:
+        {
+            // What Checkpointing_WorkloadLoop() does between chunks, besides
+            // the dead-time
+            for (i = 0; i < CALIBRATION_SMALL_CHUNKS; i++)
+            {
+                sink = ((Utils_GetUptimeMicroseconds() - progressTicks) > 1000000UL);
+                sink = (ctx->bytesProcessed >= ctx->totalWorkloadSizeBytes);
+                sink = (Console_CheckForKey() != 0);
+            }
+            break;
+        }
+        case CALIBRATION_DEAD_TIME:
+        {
+            for (i = 0; i < CALIBRATION_DEAD_TIMES; i++)
+            {
+                Checkpointing_WaitDeadTime(ctx);
+            }
+            break;
+        }
+        case CALIBRATION_CHECKPOINT:
+        {
+            // As Checkpointing_DoChunk() commits, with its timing
+            for (i = 0; i < CALIBRATION_CHECKPOINTS; i++)
+            {
+                checkpointStart = Utils_GetUptimeMicroseconds();
+                Checkpoint_Commit(&calibrationStore, ctx);
+                ctx->stats.checkpointMicroseconds += Utils_GetUptimeMicroseconds() - checkpointStart;
+            }
+            break;
+        }
+    }
+    end = Timer_A_getCounterValue(TIMER_A1_BASE);
+
+    (void)sink;
+
+    return end - start;
+}
+
+/**
+ * @brief      Time one chunk of blocks through a stream, in MCLK cycles
+ */
+static uint16_t Calibration_TimeEngineBatch(cipherStream_t *stream)
+{
+    uint16_t start;
+    uint16_t end;
+    uint16_t i;
+
+    start = Timer_A_getCounterValue(TIMER_A1_BASE);
+    Cipher_BeginChunk(stream, CALIBRATION_BENCH_BLOCKS);
+    if (Cipher_RunsWholeChunks(stream))
+    {
+        Cipher_WaitChunk(stream);
+    }
+    else
+    {
+        for (i = 0; i < CALIBRATION_BENCH_BLOCKS; i++)
+        {
+            Cipher_EncryptBlock(stream);
+        }
+    }
+    Cipher_EndChunk(stream);
+    end = Timer_A_getCounterValue(TIMER_A1_BASE);
+
+    return end - start;
+}
+
+/**
+ * @brief      Start Timer_A1 counting MCLK cycles
+ */
+static void Calibration_StartTimer(void)
+{
+    Timer_A_initContinuousModeParam timerParam = {0};
+
+    timerParam.clockSource = TIMER_A_CLOCKSOURCE_SMCLK;
+    timerParam.clockSourceDivider = TIMER_A_CLOCKSOURCE_DIVIDER_1;
+    timerParam.timerInterruptEnable_TAIE = TIMER_A_TAIE_INTERRUPT_DISABLE;
+    timerParam.timerClear = TIMER_A_DO_CLEAR;
+    timerParam.startTimer = true;
+    Timer_A_initContinuousMode(TIMER_A1_BASE, &timerParam);
+}
+
+/**
+ * @brief      Average cycles of a batch of an item, timer overhead removed
+ */
+static uint32_t Calibration_TimeItem(calibrationItem_e item, checkpointingObj_t *ctx, uint32_t emptyCycles)
+{
+    uint32_t total = 0;
+    uint16_t batch;
+
+    for (batch = 0; batch < CALIBRATION_BATCHES; batch++)
+    {
+        total += Calibration_TimeBatch(item, ctx);
+    }
+    total = (total + (CALIBRATION_BATCHES / 2)) / CALIBRATION_BATCHES;
+
+    return (total > emptyCycles) ? (total - emptyCycles) : 0;
+}
+
+/**
+ * @brief      Measure the workload's costs on this board
+ *
+ * @param[out] profile  The measured costs
+ */
+void Calibration_Measure(calibrationProfile_t *profile)
+{
+    checkpointingObj_t ctx;
+    uint32_t emptyCycles;
+    uint32_t aesCycles;
+    uint32_t smallChunkCycles;
+    uint32_t largeChunkCycles;
+    uint32_t loopTailCycles;
+    uint32_t deadTimeCycles;
+    uint32_t checkpointCycles;
+    uint32_t blockCycles;
+    uint32_t blocks;
+
+    Calibration_StartTimer();
+
+    // A scratch instance, so the real one and its settings are left alone.
+    // No scaling, so every chunk stays the size it is given. Its chunks
+    // aren't checkpointed; commits are measured on their own.
+    Checkpointing_Init(&ctx);
+    ctx.policy = WORKLOAD_SCALING_NONE;
+    ctx.deadTimeMicroseconds = CALIBRATION_DEAD_TIME_US;
+    // Measured with the real instance's workload and its settings
+    ctx.workload = checkpointingObj.workload;
+    ctx.workloadState = checkpointingObj.workloadState;
+    workloadTable[(unsigned int)ctx.workload].init(&ctx.workloadState);
+    blocks = CALIBRATION_LARGE_CHUNK_SIZE / workloadTable[(unsigned int)ctx.workload].unitSize;
+
+    emptyCycles = Calibration_TimeItem(CALIBRATION_EMPTY, &ctx, 0);
+    aesCycles = Calibration_TimeItem(CALIBRATION_AES, &ctx, emptyCycles);
+    // One unit a chunk
+    Checkpointing_SetChunkBounds(&ctx, 0, 0, CALIBRATION_LARGE_CHUNK_SIZE);
+    smallChunkCycles = Calibration_TimeItem(CALIBRATION_SMALL_CHUNK, &ctx, emptyCycles);
+    Checkpointing_SetChunkSize(&ctx, CALIBRATION_LARGE_CHUNK_SIZE);
+    largeChunkCycles = Calibration_TimeItem(CALIBRATION_LARGE_CHUNK, &ctx, emptyCycles);
+    loopTailCycles = Calibration_TimeItem(CALIBRATION_LOOP_TAIL, &ctx, emptyCycles);
+    deadTimeCycles = Calibration_TimeItem(CALIBRATION_DEAD_TIME, &ctx, emptyCycles);
+    Checkpoint_Restore(&calibrationStore, &ctx);
+    checkpointCycles = Calibration_TimeItem(CALIBRATION_CHECKPOINT, &ctx, emptyCycles);
+
+    Timer_A_stop(TIMER_A1_BASE);
+
+    // A chunk costs a fixed part plus one AES call and poll per block
+    smallChunkCycles /= CALIBRATION_SMALL_CHUNKS;
+    blockCycles = (largeChunkCycles > smallChunkCycles) ?
+                  ((largeChunkCycles - smallChunkCycles) / (blocks - 1)) : 0;
+    aesCycles /= CALIBRATION_AES_BLOCKS;
+    deadTimeCycles /= CALIBRATION_DEAD_TIMES;
+    checkpointCycles /= CALIBRATION_CHECKPOINTS;
+
+    if ((ctx.workload != WORKLOAD_AES) || (ctx.workloadState.stream.engine != CIPHER_ENGINE_BLOCKING))
+    {
+        // The module works through a block while the CPU (or the DMA) does
+        // the rest of the previous one; the whole block is charged as AES.
+        // Other workloads have their whole unit charged the same way.
+        aesCycles = blockCycles;
+    }
+    profile->aesBlockCycles = aesCycles;
+    profile->blockPollCycles = (blockCycles > aesCycles) ? (blockCycles - aesCycles) : 0;
+    profile->chunkOverheadCycles = ((smallChunkCycles > blockCycles) ? (smallChunkCycles - blockCycles) : 0) +
+                                   (loopTailCycles / CALIBRATION_SMALL_CHUNKS);
+    profile->deadTimeOverheadCycles =
+        (deadTimeCycles > (CALIBRATION_DEAD_TIME_US * CALIBRATION_CYCLES_PER_US)) ?
+        (deadTimeCycles - (CALIBRATION_DEAD_TIME_US * CALIBRATION_CYCLES_PER_US)) : 0;
+    profile->checkpointCycles = checkpointCycles;
+}
+
+/**
+ * @brief      Print a cost profile in the form the host simulator reads
+ */
+void Calibration_PrintProfile(const calibrationProfile_t *profile)
+{
+    Console_Print("# Checkpointing fixture cost profile, MCLK cycles");
+    Console_Print("profile_version=%u", CALIBRATION_PROFILE_VERSION);
+    Console_Print("mclk_hz=%lu", (uint32_t)CALIBRATION_CYCLES_PER_US * 1000000UL);
+    Console_Print("aes_block_cycles=%lu", profile->aesBlockCycles);
+    Console_Print("block_poll_cycles=%lu", profile->blockPollCycles);
+    Console_Print("chunk_overhead_cycles=%lu", profile->chunkOverheadCycles);
+    Console_Print("dead_time_overhead_cycles=%lu", profile->deadTimeOverheadCycles);
+    Console_Print("checkpoint_cycles=%lu", profile->checkpointCycles);
+}
+
+/**
+ * @brief      Measure and print the cost profile
+ */
+functionResult_e Calibration_Run(unsigned int numArgs, int args[])
+{
+    calibrationProfile_t profile;
+
+    Console_Print("Calibrating...");
+    // The measurements run on a scratch instance; don't let power losses
+    // land on the real one meanwhile
+    GPIO_disableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    Calibration_Measure(&profile);
+    GPIO_clearInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    GPIO_enableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    Console_PrintDivider();
+    Calibration_PrintProfile(&profile);
+    Console_PrintDivider();
+
+    return SUCCESS;
+}
+
+/**
+ * @brief      An engine's cycles per block as a percentage of the blocking
+ *             engine's
+ */
+static uint32_t Calibration_Percent(const uint32_t cycles[CIPHER_ENGINE_NUM], cipherEngine_e engine)
+{
+    if (cycles[CIPHER_ENGINE_BLOCKING] == 0)
+    {
+        return 0;
+    }
+
+    return (100UL * cycles[engine]) / cycles[CIPHER_ENGINE_BLOCKING];
+}
+
+/**
+ * @brief      Benchmark the AES engines: cycles per block of each engine in
+ *             every cipher mode, and the gain over the blocking engine
+ */
+functionResult_e Calibration_BenchmarkAes(unsigned int numArgs, int args[])
+{
+    cipherStream_t stream;
+    uint32_t cycles[CIPHER_ENGINE_NUM];
+    uint32_t emptyCycles;
+    uint16_t batch;
+    unsigned int mode;
+    unsigned int engine;
+    static const char *modeNames[CIPHER_MODE_NUM] = {"ECB", "CBC", "CTR"};
+
+    Console_Print("Benchmarking AES engines...");
+    GPIO_disableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    Calibration_StartTimer();
+    emptyCycles = Calibration_TimeBatch(CALIBRATION_EMPTY, NULL);
+
+    Console_PrintDivider();
+    Console_Print("Cycles per block, %u block chunks:", CALIBRATION_BENCH_BLOCKS);
+    for (mode = 0; mode < CIPHER_MODE_NUM; mode++)
+    {
+        for (engine = 0; engine < CIPHER_ENGINE_NUM; engine++)
+        {
+            // The DMA engine only reads the FRAM source, so they all do
+            Cipher_Init(&stream, (cipherMode_e)mode, CIPHER_SOURCE_FRAM, (cipherEngine_e)engine);
+            cycles[engine] = 0;
+            for (batch = 0; batch < CALIBRATION_BATCHES; batch++)
+            {
+                cycles[engine] += Calibration_TimeEngineBatch(&stream);
+            }
+            cycles[engine] /= CALIBRATION_BATCHES;
+            cycles[engine] = (cycles[engine] > emptyCycles) ? (cycles[engine] - emptyCycles) : 0;
+            cycles[engine] /= CALIBRATION_BENCH_BLOCKS;
+        }
+        Console_Print("%s: blocking %lu, pipelined %lu (%lu%%), DMA %lu (%lu%%)", modeNames[mode],
+                      cycles[CIPHER_ENGINE_BLOCKING],
+                      cycles[CIPHER_ENGINE_PIPELINED], Calibration_Percent(cycles, CIPHER_ENGINE_PIPELINED),
+                      cycles[CIPHER_ENGINE_DMA], Calibration_Percent(cycles, CIPHER_ENGINE_DMA));
+    }
+    Console_PrintDivider();
+
+    Timer_A_stop(TIMER_A1_BASE);
+    GPIO_clearInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    GPIO_enableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    return SUCCESS;
+}
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include "console.h"
+
+// Version of the cost profile printed by Calibration_Run()
+#define CALIBRATION_PROFILE_VERSION     (1)
+
+typedef struct
+{
+    // A block of a multi-block AES256_encryptBlocks() call, its
+    // AESADIN/AESADOUT loops included
+    uint32_t aesBlockCycles;
+    // Checkpointing_DoChunk() loop overhead per block beyond the AES call (the
+    // plaintext fetch, the cipher mode's chaining and the powerLoss poll)
+    uint32_t blockPollCycles;
+    // Fixed cost of every chunk: the state copy, the work start/end GPIO
+    // marks, Checkpointing_ExecutePolicy() and the workload loop bookkeeping
+    uint32_t chunkOverheadCycles;
+    // Time Checkpointing_WaitDeadTime() takes beyond the dead-time itself
+    uint32_t deadTimeOverheadCycles;
+    // One Checkpoint_Commit() to FRAM after a committed chunk, its timing
+    // included
+    uint32_t checkpointCycles;
+} calibrationProfile_t;
+
+void Calibration_Measure(calibrationProfile_t *profile);
+void Calibration_PrintProfile(const calibrationProfile_t *profile);
+functionResult_e Calibration_Run(unsigned int numArgs, int args[]);
+functionResult_e Calibration_BenchmarkAes(unsigned int numArgs, int args[]);
+
+#endif // CALIBRATION_H
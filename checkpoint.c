@@ -0,0 +1,277 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Checkpoints of the workload's progress in FRAM. Every committed chunk
+ * writes the run's settings, progress and workload state to one of two
+ * slots in turn, tagged with a sequence number and a CRC32 from the CRC32
+ * module. A brown-out in the middle of a commit leaves a slot that fails its
+ * CRC, and the other slot still holds the commit before it. On boot the
+ * newest slot that checks out is restored.
+ *
+ * In just-in-time commit mode the power-loss interrupt also snapshots how
+ * many units the chunk in progress had finished. The snapshot is tagged with
+ * the sequence of the newest slot and restored on top of it.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "driverlib.h"
+#include "checkpoint.h"
+
+// Slot size in 32-bit words, as written by FRAMCtl_write32()
+#define CHECKPOINT_SLOT_WORDS       (sizeof(checkpointSlot_t) / sizeof(uint32_t))
+// Words covered by the slot CRC, everything before it
+#define CHECKPOINT_CRC_WORDS        (offsetof(checkpointSlot_t, crc) / sizeof(uint32_t))
+
+#pragma PERSISTENT(checkpointStore)
+checkpointStore_t checkpointStore = {0};
+
+/**
+ * @brief      Compute the CRC32 of a slot with the CRC32 module
+ */
+static uint32_t Checkpoint_Crc(const checkpointSlot_t *slot)
+{
+    const uint32_t *words = (const uint32_t *)slot;
+    unsigned int i;
+
+    CRC32_setSeed(CHECKPOINT_CRC_SEED, CRC32_MODE);
+    for (i = 0; i < CHECKPOINT_CRC_WORDS; i++)
+    {
+        CRC32_set32BitData(words[i]);
+    }
+
+    return CRC32_getResult(CRC32_MODE);
+}
+
+/**
+ * @brief      Check that a chunk size is whole units of a commit's workload,
+ *             within its bounds
+ */
+static bool Checkpoint_IsValidChunkSize(const checkpointState_t *state, uint32_t chunkSize)
+{
+    return ((chunkSize % workloadTable[state->workload].unitSize) == 0) &&
+           (chunkSize >= state->minChunkSize) &&
+           (chunkSize <= state->maxChunkSize);
+}
+
+/**
+ * @brief      Check that a commit's bandit arms add up to its pulls, and its
+ *             epoch is their log2
+ */
+static bool Checkpoint_IsValidBandit(const checkpointState_t *state)
+{
+    uint32_t pulls = 0;
+    unsigned int i;
+
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        pulls += state->banditArmPulls[i];
+    }
+    if (pulls != state->banditPulls)
+    {
+        return false;
+    }
+
+    return (pulls == 0) ? (state->banditEpoch == 0) :
+           ((state->banditEpoch < 32) && ((pulls >> state->banditEpoch) == 1));
+}
+
+/**
+ * @brief      Check that a slot holds a whole commit
+ */
+static bool Checkpoint_IsValid(const checkpointSlot_t *slot)
+{
+    workloadState_t workloadState;
+
+    return (slot->layout == CHECKPOINT_LAYOUT) &&
+           (slot->crc == Checkpoint_Crc(slot)) &&
+           (slot->state.workload < WORKLOAD_NUM) &&
+           (slot->state.minChunkSize >= workloadTable[slot->state.workload].unitSize) &&
+           (slot->state.minChunkSize <= slot->state.maxChunkSize) &&
+           (slot->state.maxChunkSize <= CHUNK_SIZE_LIMIT) &&
+           Checkpoint_IsValidChunkSize(&slot->state, slot->state.startingChunkSize) &&
+           Checkpoint_IsValidChunkSize(&slot->state, slot->state.currentChunkSize) &&
+           (slot->state.policy < WORKLOAD_SCALING_NUM) &&
+           (slot->state.commitMode < COMMIT_MODE_NUM) &&
+           Checkpoint_IsValidBandit(&slot->state) &&
+           workloadTable[slot->state.workload].restoreState(&workloadState, slot->state.workloadState,
+                                                            slot->state.bytesProcessed);
+}
+
+/**
+ * @brief      Restore the newest checkpoint in a store. Also picks the slot
+ *             the next commit goes to, so call it before the first commit.
+ *
+ * @param      store  The store
+ * @param      ctx    The fixture instance, left alone if nothing is restored
+ *
+ * @return     true if a checkpoint was restored
+ */
+bool Checkpoint_Restore(checkpointStore_t *store, checkpointingObj_t *ctx)
+{
+    const checkpointSlot_t *newest = NULL;
+    const checkpointState_t *state;
+    const workload_t *workload;
+    unsigned int i;
+
+    for (i = 0; i < CHECKPOINT_NUM_SLOTS; i++)
+    {
+        if (!Checkpoint_IsValid(&store->slots[i]))
+        {
+            continue;
+        }
+        // Sequence numbers are compared across a wrap
+        if ((newest == NULL) || ((int32_t)(store->slots[i].sequence - newest->sequence) > 0))
+        {
+            newest = &store->slots[i];
+        }
+    }
+
+    if (newest == NULL)
+    {
+        // Never committed, or both slots damaged
+        store->nextSequence = 1;
+        return false;
+    }
+    store->nextSequence = newest->sequence + 1;
+
+    state = &newest->state;
+    workload = &workloadTable[state->workload];
+    ctx->totalWorkloadSizeBytes = state->totalWorkloadSizeBytes;
+    ctx->bytesProcessed = state->bytesProcessed;
+    ctx->deadTimeMicroseconds = state->deadTimeMicroseconds;
+    ctx->randomState = state->randomState;
+    ctx->successThresh = state->successThresh;
+    ctx->failThresh = state->failThresh;
+    ctx->workloadFails = state->workloadFails;
+    ctx->workloadSuccesses = state->workloadSuccesses;
+    ctx->startingChunkSize = state->startingChunkSize;
+    ctx->currentChunkSize = state->currentChunkSize;
+    ctx->minChunkSize = state->minChunkSize;
+    ctx->maxChunkSize = state->maxChunkSize;
+    ctx->policy = (workloadScalingPolicy_e)state->policy;
+    ctx->aimdIncreaseUnits = state->aimdIncreaseUnits;
+    ctx->aimdDecreasePercent = state->aimdDecreasePercent;
+    ctx->predictiveMarginPercent = state->predictiveMarginPercent;
+    ctx->unitCostQ8 = state->unitCostQ8;
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        ctx->banditArms[i].pulls = state->banditArmPulls[i];
+        ctx->banditArms[i].meanQ12 = state->banditArmMeansQ12[i];
+    }
+    ctx->banditPulls = state->banditPulls;
+    ctx->banditArm = state->banditArm;
+    ctx->banditEpoch = state->banditEpoch;
+    Checkpointing_RestoreBandit(ctx);
+    ctx->commitMode = (commitMode_e)state->commitMode;
+    ctx->workload = (workloadType_e)state->workload;
+    workload->restoreState(&ctx->workloadState, state->workloadState, state->bytesProcessed);
+
+    // Units of an interrupted chunk checkpointed just in time since. The
+    // workload works out their state again from what they left in FRAM.
+    if ((ctx->commitMode == COMMIT_MODE_JIT) && (store->jit.sequence == newest->sequence))
+    {
+        ctx->bytesProcessed += (uint64_t)store->jit.units * workload->unitSize;
+        workload->advance(&ctx->workloadState, store->jit.units);
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Commit the progress of a fixture instance to its next slot
+ *
+ * @param      store  The store
+ * @param[in]  ctx    The fixture instance
+ */
+void Checkpoint_Commit(checkpointStore_t *store, const checkpointingObj_t *ctx)
+{
+    checkpointSlot_t slot;
+    checkpointState_t *state = &slot.state;
+    unsigned int i;
+
+    // Padding is covered by the CRC too
+    memset(&slot, 0, sizeof(slot));
+    slot.layout = CHECKPOINT_LAYOUT;
+    slot.sequence = store->nextSequence;
+    state->totalWorkloadSizeBytes = ctx->totalWorkloadSizeBytes;
+    state->bytesProcessed = ctx->bytesProcessed;
+    state->deadTimeMicroseconds = ctx->deadTimeMicroseconds;
+    state->randomState = ctx->randomState;
+    state->successThresh = ctx->successThresh;
+    state->failThresh = ctx->failThresh;
+    state->workloadFails = ctx->workloadFails;
+    state->workloadSuccesses = ctx->workloadSuccesses;
+    state->startingChunkSize = ctx->startingChunkSize;
+    state->currentChunkSize = ctx->currentChunkSize;
+    state->minChunkSize = ctx->minChunkSize;
+    state->maxChunkSize = ctx->maxChunkSize;
+    state->policy = (uint8_t)ctx->policy;
+    state->aimdIncreaseUnits = ctx->aimdIncreaseUnits;
+    state->aimdDecreasePercent = ctx->aimdDecreasePercent;
+    state->predictiveMarginPercent = ctx->predictiveMarginPercent;
+    state->unitCostQ8 = ctx->unitCostQ8;
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        state->banditArmPulls[i] = ctx->banditArms[i].pulls;
+        state->banditArmMeansQ12[i] = ctx->banditArms[i].meanQ12;
+    }
+    state->banditPulls = ctx->banditPulls;
+    state->banditArm = ctx->banditArm;
+    state->banditEpoch = ctx->banditEpoch;
+    state->commitMode = (uint8_t)ctx->commitMode;
+    state->workload = (uint8_t)ctx->workload;
+    workloadTable[(unsigned int)ctx->workload].saveState(&ctx->workloadState, state->workloadState);
+    slot.crc = Checkpoint_Crc(&slot);
+
+    // The CRC is written last; a slot cut short fails it
+    FRAMCtl_write32((uint32_t *)&slot, (uint32_t *)&store->slots[slot.sequence % CHECKPOINT_NUM_SLOTS],
+                    CHECKPOINT_SLOT_WORDS);
+    store->nextSequence++;
+}
+
+/**
+ * @brief      Snapshot the units finished by the chunk a power loss
+ *             interrupted. Called from the power-loss interrupt, so it only
+ *             does two plain FRAM stores.
+ *
+ * @param      store  The store
+ * @param[in]  units  Workload units the chunk finished
+ */
+void Checkpoint_CommitJit(checkpointStore_t *store, uint16_t units)
+{
+    store->jit.units = units;
+    store->jit.sequence = store->nextSequence - 1;
+}
+
+/**
+ * @brief      Get the sequence number of the last commit to a store
+ *
+ * @return     The sequence number, 0 if nothing was committed
+ */
+uint32_t Checkpoint_GetSequence(const checkpointStore_t *store)
+{
+    return (store->nextSequence != 0) ? (store->nextSequence - 1) : 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "checkpointing_test_fixture.h"
+
+// Slots written in turn, so a commit torn by a brown-out leaves the previous
+// one intact
+#define CHECKPOINT_NUM_SLOTS        (2)
+
+// Seed of the slot CRC32
+#define CHECKPOINT_CRC_SEED         (0xFFFFFFFFUL)
+
+// Layout of checkpointState_t, bumped whenever it changes. A slot of another
+// layout, from other firmware, is not restored.
+#define CHECKPOINT_LAYOUT           (2)
+
+typedef struct
+{
+    // Settings of the run, so a resumed run carries on with them
+    uint64_t totalWorkloadSizeBytes;
+    // Bytes committed so far
+    uint64_t bytesProcessed;
+    uint32_t deadTimeMicroseconds;
+    // Policy state, chunk sizes in bytes
+    uint32_t randomState;
+    uint32_t startingChunkSize;
+    uint32_t currentChunkSize;
+    uint32_t minChunkSize;
+    uint32_t maxChunkSize;
+    uint16_t successThresh;
+    uint16_t failThresh;
+    uint16_t workloadFails;
+    uint16_t workloadSuccesses;
+    uint16_t aimdIncreaseUnits;
+    uint16_t predictiveMarginPercent;
+    // Predictive policy's unit cost estimate, so a resumed run doesn't have
+    // to learn it again. Its inter-arrival estimate is in uptime, which a
+    // reset starts over, and is learnt again.
+    uint32_t unitCostQ8;
+    // Bandit policy's arms, so a resumed run doesn't explore them all again:
+    // the chunks each ran and their mean reward, the chunks run by all arms
+    // and the arm of the last one. The bonuses are worked out again.
+    uint32_t banditArmPulls[CHUNK_STATS_BUCKETS];
+    uint32_t banditArmMeansQ12[CHUNK_STATS_BUCKETS];
+    uint32_t banditPulls;
+    uint8_t banditArm;
+    uint8_t banditEpoch;
+    uint16_t reserved;
+    uint8_t aimdDecreasePercent;
+    uint8_t policy;
+    uint8_t commitMode;
+    // The workload and its state, packed by its saveState(). Its position
+    // is bytesProcessed.
+    uint8_t workload;
+    uint8_t workloadState[WORKLOAD_SAVED_STATE_SIZE];
+} checkpointState_t;
+
+typedef struct
+{
+    // CHECKPOINT_LAYOUT of the firmware that wrote it
+    uint32_t layout;
+    // Commit number, a slot with a later one is newer
+    uint32_t sequence;
+    checkpointState_t state;
+    // CRC32 of everything above
+    uint32_t crc;
+} checkpointSlot_t;
+
+typedef struct
+{
+    // Workload units an interrupted chunk finished
+    uint16_t units;
+    uint16_t reserved;
+    // Sequence of the commit the chunk started from. Written after blocks,
+    // so a snapshot cut short doesn't match any commit.
+    uint32_t sequence;
+} checkpointJit_t;
+
+typedef struct checkpointStore
+{
+    // Written with FRAMCtl_write32(), slot (sequence % CHECKPOINT_NUM_SLOTS)
+    checkpointSlot_t slots[CHECKPOINT_NUM_SLOTS];
+    // Just-in-time snapshot of the chunk a power loss interrupted, on top of
+    // the newest slot
+    checkpointJit_t jit;
+    // Sequence of the next commit. Worked out again by Checkpoint_Restore()
+    // on every boot, before the first commit.
+    uint32_t nextSequence;
+} checkpointStore_t;
+
+// The store the fixture instance commits to and resumes from
+extern checkpointStore_t checkpointStore;
+
+bool Checkpoint_Restore(checkpointStore_t *store, checkpointingObj_t *ctx);
+void Checkpoint_Commit(checkpointStore_t *store, const checkpointingObj_t *ctx);
+void Checkpoint_CommitJit(checkpointStore_t *store, uint16_t units);
+uint32_t Checkpoint_GetSequence(const checkpointStore_t *store);
+
+#endif // CHECKPOINT_H
@@ -24,23 +24,48 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "driverlib.h"
 #include "checkpointing_test_fixture.h"
 #include "console.h"
 #include "utils.h"
-
-#define AES_MINIMUM_CHUNK_SIZE (16) // Size of data to be encrypted/decrypted (must be multiple of 16)
-static uint8_t dataAESencrypted[AES_MINIMUM_CHUNK_SIZE]; // Encrypted data
-//static uint8_t dataAESdecrypted[AES_MINIMUM_CHUNK_SIZE]; // Decrypted data, not used right now
-static char message[AES_MINIMUM_CHUNK_SIZE] = {0};
+#include "trace.h"
+#include "sampler.h"
+#include "checkpoint.h"
 
 #define DEFAULT_FAILURE_THRESHOLD (2) // The amount of consecutive failures that will trigger a workload policy update
 #define DEFAULT_SUCCESS_THRESHOLD (2) // The amount of consecutive successes that will trigger a workload policy update
+#define DEFAULT_AIMD_INCREASE_UNITS (4) // Workload units an AIMD success adds to the chunk size
+#define DEFAULT_AIMD_DECREASE_PERCENT (50) // Share of the chunk size an AIMD failure keeps
+#define DEFAULT_PREDICTIVE_MARGIN_PERCENT (50) // Standard deviations, in percent, of confidence margin on a predicted window
+
+// Power-loss interval and unit cost averages weigh a new sample 1/8. Until
+// that many intervals are in, the interval average weighs a new one by the
+// power of two at or below the count, so the ISR only ever shifts.
+#define PREDICTIVE_EWMA_SHIFT (3)
+// Power losses seen before the predictive policy trusts its estimate
+#define PREDICTIVE_MIN_EVENTS (4)
+
+// Bandit rewards are in 1/4096 byte per microsecond, a whole chunk's bytes
+// still fit 32 bits shifted up
+#define BANDIT_REWARD_SHIFT (12)
+// ln 2 in 1/256, to turn a log2 of the chunks run into the ln UCB1 wants
+#define BANDIT_LN2_Q8 (177)
+// banditArm before the first arm is picked
+#define BANDIT_NO_ARM (0xFF)
+
+// Chunk sizes in bytes
+#define DEFAULT_STARTING_CHUNK_SIZE (1024UL)
+#define DEFAULT_MIN_CHUNK_SIZE (AES_MINIMUM_CHUNK_SIZE)
+#define DEFAULT_MAX_CHUNK_SIZE (1024UL)
 
 // Our total workload size
 #define TOTAL_WORKLOAD_SIZE_BYTES (5 * 1024ULL * 1024ULL)
 
-volatile checkpointingObj_t checkpointingObj;
+// Time between goodput samples, a 5 MB run fits in the sample ring
+#define DEFAULT_SAMPLE_INTERVAL_MICROSECONDS (100000UL)
+
+checkpointingObj_t checkpointingObj;
 
 static arrayOfStrings_t workloadScalingStrings =
 {
@@ -49,58 +74,333 @@ static arrayOfStrings_t workloadScalingStrings =
     ANSI_COLOR_MAGENTA"Random Scaling"ANSI_COLOR_RESET,
     ANSI_COLOR_MAGENTA"Random Adaptive Scaling"ANSI_COLOR_RESET,
     ANSI_COLOR_MAGENTA"Linear Adaptive Scaling"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"AIMD Scaling"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"Predictive Scaling"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"Bandit Scaling"ANSI_COLOR_RESET,
+};
+
+static arrayOfStrings_t commitModeStrings =
+{
+    ANSI_COLOR_MAGENTA"Chunk Abort"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"Just-in-time"ANSI_COLOR_RESET,
 };
 
-static const uint16_t chunkScaleLut[CHUNK_SCALE_MAX] =
+static arrayOfStrings_t cipherModeStrings =
 {
-    1024,   // CHUNK_SCALE_1024
-    512,    // CHUNK_SCALE_512
-    256,    // CHUNK_SCALE_256
-    128,    // CHUNK_SCALE_128
-    64,     // CHUNK_SCALE_64
-    32,     // CHUNK_SCALE_32
-    16,     // CHUNK_SCALE_16
+    ANSI_COLOR_MAGENTA"ECB"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"CBC"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"CTR"ANSI_COLOR_RESET,
 };
 
-void Checkpointing_Init(void)
+static arrayOfStrings_t cipherSourceStrings =
+{
+    ANSI_COLOR_MAGENTA"Generated Pattern"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"FRAM Region"ANSI_COLOR_RESET,
+};
+
+static arrayOfStrings_t cipherEngineStrings =
+{
+    ANSI_COLOR_MAGENTA"Blocking"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"Pipelined"ANSI_COLOR_RESET,
+    ANSI_COLOR_MAGENTA"DMA (ECB/CBC, FRAM source)"ANSI_COLOR_RESET,
+};
+
+static uint32_t Checkpointing_BoardMicroseconds(const checkpointingObj_t *ctx);
+static void Checkpointing_BoardMarkWork(bool working);
+static uint32_t Checkpointing_BoardRunChunk(checkpointingObj_t *ctx, workloadState_t *state, uint32_t chunkSize);
+static bool Checkpointing_BoardCommit(checkpointingObj_t *ctx);
+
+// The board: Timer_A0 uptime, the workload's own units and the FRAM store.
+// The dead-time polls the clock.
+static const checkpointingPlatform_t checkpointingBoard =
+{
+    Checkpointing_BoardMicroseconds,
+    Checkpointing_BoardMarkWork,
+    Checkpointing_BoardRunChunk,
+    NULL,
+    Checkpointing_BoardCommit,
+    NULL,
+};
+
+/**
+ * @brief      Put a fixture instance in its default settings
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_Init(checkpointingObj_t *ctx)
 {
     // Reset our runtime variables
-    checkpointingObj.powerLoss = false;
-    checkpointingObj.currentlyWorking = false;
-    checkpointingObj.startingChunkScale = CHUNK_SCALE_1024;
-    checkpointingObj.deadTimeMicroseconds = 1000;
-    checkpointingObj.totalWorkloadSizeBytes = TOTAL_WORKLOAD_SIZE_BYTES;
-    checkpointingObj.successThresh = DEFAULT_SUCCESS_THRESHOLD;
-    checkpointingObj.failThresh = DEFAULT_FAILURE_THRESHOLD;
-    checkpointingObj.policy = WORKLOAD_SCALING_LINEAR;
+    ctx->powerLoss = false;
+    ctx->powerLossCount = 0;
+    ctx->currentlyWorking = false;
+    // The chunk sizes are whole units of the workload
+    ctx->workload = WORKLOAD_AES;
+    Cipher_Init(&ctx->workloadState.stream, CIPHER_MODE_ECB, CIPHER_SOURCE_PATTERN, CIPHER_ENGINE_BLOCKING);
+    Checkpointing_SetChunkBounds(ctx, DEFAULT_STARTING_CHUNK_SIZE, DEFAULT_MIN_CHUNK_SIZE, DEFAULT_MAX_CHUNK_SIZE);
+    ctx->deadTimeMicroseconds = 1000;
+    ctx->totalWorkloadSizeBytes = TOTAL_WORKLOAD_SIZE_BYTES;
+    ctx->successThresh = DEFAULT_SUCCESS_THRESHOLD;
+    ctx->failThresh = DEFAULT_FAILURE_THRESHOLD;
+    ctx->policy = WORKLOAD_SCALING_LINEAR;
+    ctx->aimdIncreaseUnits = DEFAULT_AIMD_INCREASE_UNITS;
+    ctx->aimdDecreasePercent = DEFAULT_AIMD_DECREASE_PERCENT;
+    ctx->predictiveMarginPercent = DEFAULT_PREDICTIVE_MARGIN_PERCENT;
+    ctx->unitCostQ8 = 0;
+    ctx->arrivalDeviationMicroseconds = 0;
+    memset((void *)&ctx->arrivals, 0, sizeof(ctx->arrivals));
+    ctx->arrivalDeviationSequence = ctx->arrivals.sequence;
+    Checkpointing_ResetBandit(ctx);
+    ctx->commitMode = COMMIT_MODE_CHUNK_ABORT;
+    ctx->sampleIntervalMicroseconds = DEFAULT_SAMPLE_INTERVAL_MICROSECONDS;
+    ctx->workloadFails = 0;
+    ctx->workloadSuccesses = 0;
+    ctx->chunkMicroseconds = 0;
+    ctx->chunkEndMicroseconds = 0;
+    ctx->chunkBytesRun = 0;
+    ctx->chunkUnitsDone = 0;
+    ctx->salvageUnits = 0;
+    ctx->checkpoints = NULL;
+    ctx->resumeRun = false;
+    ctx->platform = &checkpointingBoard;
+    Checkpointing_ResetStats(ctx);
+    Checkpointing_Seed(ctx, 1);
 };
 
+/**
+ * @brief      Checkpoint an instance's committed chunks to a store, and
+ *             restore the store's newest checkpoint. If that run didn't
+ *             finish, the next run resumes it.
+ *
+ * @param      ctx    The fixture instance
+ * @param      store  The checkpoint store
+ */
+void Checkpointing_AttachStore(checkpointingObj_t *ctx, struct checkpointStore *store)
+{
+    ctx->checkpoints = store;
+    ctx->resumeRun = Checkpoint_Restore(store, ctx) && (ctx->bytesProcessed < ctx->totalWorkloadSizeBytes);
+}
+
+/**
+ * @brief      Clear the accounting of a run
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_ResetStats(checkpointingObj_t *ctx)
+{
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+}
+
+/**
+ * @brief      Print one line of the run breakdown
+ */
+static void Checkpointing_PrintShare(const char *label, uint64_t value, const char *unit, uint64_t total)
+{
+    Console_Print("%s: %llu %s (%.1f%%)", label, value, unit,
+                  (total != 0) ? ((100.0 * (double)value) / (double)total) : 0.0);
+}
+
+/**
+ * @brief      Print where a run's time and work went
+ *
+ * @param[in]  ctx              The fixture instance, after its run
+ * @param[in]  runMicroseconds  Length of the run
+ */
+void Checkpointing_PrintStats(const checkpointingObj_t *ctx, uint32_t runMicroseconds)
+{
+    const checkpointingStats_t *stats = &ctx->stats;
+    uint32_t accounted = stats->committedMicroseconds + stats->abortedMicroseconds + stats->deadTimeMicroseconds +
+                         stats->checkpointMicroseconds;
+    uint64_t abortBytes = ctx->bytesProcessed;
+    uint64_t jitBytes = ctx->bytesProcessed;
+    double seconds = (double)runMicroseconds / 1000000.0;
+
+    Console_Print("Run breakdown:");
+    Checkpointing_PrintShare("Wasted work", stats->wastedBytes, "B", stats->wastedBytes + ctx->bytesProcessed);
+    Checkpointing_PrintShare("Salvageable work", stats->salvageableBytes, "B",
+                             stats->wastedBytes + ctx->bytesProcessed);
+    Checkpointing_PrintShare("Committed chunks", stats->committedMicroseconds, "us", runMicroseconds);
+    Checkpointing_PrintShare("Aborted chunks", stats->abortedMicroseconds, "us", runMicroseconds);
+    Checkpointing_PrintShare("Dead-time", stats->deadTimeMicroseconds, "us", runMicroseconds);
+    Checkpointing_PrintShare("  lost to restarts", stats->deadTimeRestartMicroseconds, "us", runMicroseconds);
+    Checkpointing_PrintShare("Checkpoint commits", stats->checkpointMicroseconds, "us", runMicroseconds);
+    Console_Print("  per commit: %.1f us",
+                  (stats->checkpointCommits != 0) ?
+                  ((double)stats->checkpointMicroseconds / (double)stats->checkpointCommits) : 0.0);
+    Checkpointing_PrintShare("Other", (runMicroseconds > accounted) ? (runMicroseconds - accounted) : 0, "us",
+                             runMicroseconds);
+
+    // The same power losses under the other commit mode. Only the salvaged
+    // blocks differ, the policy sees a power loss as a failure either way.
+    if (ctx->commitMode == COMMIT_MODE_JIT)
+    {
+        abortBytes -= stats->salvageableBytes;
+    }
+    else
+    {
+        jitBytes += stats->salvageableBytes;
+    }
+    Console_Print("Goodput, chunk abort: %.1f B/s%s", (seconds > 0.0) ? ((double)abortBytes / seconds) : 0.0,
+                  (ctx->commitMode == COMMIT_MODE_CHUNK_ABORT) ? "" : " (estimated)");
+    Console_Print("Goodput, just-in-time: %.1f B/s%s", (seconds > 0.0) ? ((double)jitBytes / seconds) : 0.0,
+                  (ctx->commitMode == COMMIT_MODE_JIT) ? "" : " (estimated)");
+}
+
+/**
+ * @brief      Print the outcomes of a run for each chunk size
+ *
+ * @param[in]  ctx   The fixture instance, after its run
+ */
+void Checkpointing_PrintChunkStats(const checkpointingObj_t *ctx)
+{
+    const checkpointingChunkStats_t *chunkStats;
+    uint32_t attempts;
+    unsigned int i;
+
+    Console_Print(" Chunk sizes  Attempts   Commits    Aborts  Success  Mean size  Mean time     Kept");
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        chunkStats = &ctx->stats.chunks[i];
+        attempts = chunkStats->commits + chunkStats->aborts;
+        if (attempts == 0)
+        {
+            continue;
+        }
+        // The sizes the chunks actually had, within the bucket's
+        Console_Print("%5lu-%5lu B %9lu %9lu %9lu %7.1f%% %8lu B %8lu us %7.1f%%",
+                      chunkStats->smallestChunkSize, chunkStats->largestChunkSize,
+                      attempts, chunkStats->commits, chunkStats->aborts,
+                      (100.0 * (double)chunkStats->commits) / (double)attempts,
+                      (uint32_t)(chunkStats->attemptedBytes / attempts),
+                      chunkStats->totalMicroseconds / attempts,
+                      (100.0 * (double)chunkStats->committedBytes) / (double)chunkStats->attemptedBytes);
+    }
+}
+
+/**
+ * @brief      Seed an instance's random number generator
+ *
+ * @param      ctx   The fixture instance
+ * @param[in]  seed  The seed (zero is remapped, xorshift can't leave it)
+ */
+void Checkpointing_Seed(checkpointingObj_t *ctx, uint32_t seed)
+{
+    ctx->randomState = (seed != 0) ? seed : 0x2545F491UL;
+}
+
+/**
+ * @brief      Get the next random number of an instance, like rand()
+ *
+ * @param      ctx   The fixture instance
+ *
+ * @return     A random number from 0 to 0x7FFF
+ */
+uint16_t Checkpointing_Random(checkpointingObj_t *ctx)
+{
+    // xorshift32
+    uint32_t x = ctx->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ctx->randomState = x;
+    return (uint16_t)(x >> 17);
+}
+
 functionResult_e PowerLossEmu_Setup(unsigned int numArgs, int args[])
 {
+    checkpointingObj_t *ctx = &checkpointingObj;
+    cipherMode_e mode;
+    cipherSource_e source;
+    cipherEngine_e engine;
+    workloadType_e workload;
+    uint32_t startingChunkSize;
+    uint32_t minChunkSize;
+    uint32_t maxChunkSize;
+    int units;
+    int percent;
     unsigned int i;
 
     // Print current settings
     Checkpointing_CurrentSettings(0, 0);
 
     // Get new settings
-    checkpointingObj.totalWorkloadSizeBytes = (1024ULL * 1024ULL * Console_PromptForInt("Total workload size (MB): "));
-    Console_Print("Choose a starting chunk size:");
-    for (i = 0; i < CHUNK_SCALE_MAX; i++)
-    {
-        Console_Print(" [%u] - %u", i, chunkScaleLut[i]);
-    }
-    Console_PrintNewLine();
-    checkpointingObj.startingChunkScale = (chunkScale_e)((0x7) & Console_PromptForInt("Starting chunk size: "));
-    checkpointingObj.deadTimeMicroseconds = Console_PromptForInt("Enter dead-time (us): ");
-    checkpointingObj.successThresh = Console_PromptForInt("Enter success threshold: ");
-    checkpointingObj.failThresh = Console_PromptForInt("Enter fail threshold: ");
+    ctx->totalWorkloadSizeBytes = (1024ULL * 1024ULL * Console_PromptForInt("Total workload size (MB): "));
+    Console_Print("Chunk sizes are whole workload units up to %lu B", CHUNK_SIZE_LIMIT);
+    startingChunkSize = (uint32_t)Console_PromptForInt("Starting chunk size (B): ");
+    minChunkSize = (uint32_t)Console_PromptForInt("Minimum chunk size (B): ");
+    maxChunkSize = (uint32_t)Console_PromptForInt("Maximum chunk size (B): ");
+    ctx->deadTimeMicroseconds = Console_PromptForInt("Enter dead-time (us): ");
+    ctx->successThresh = Console_PromptForInt("Enter success threshold: ");
+    ctx->failThresh = Console_PromptForInt("Enter fail threshold: ");
     Console_Print("Choose a workload policy:");
     for (i = 0; i < WORKLOAD_SCALING_NUM; i++)
     {
         Console_Print(" [%u] - %s", i, workloadScalingStrings[i]);
     }
     Console_PrintNewLine();
-    checkpointingObj.policy = (workloadScalingPolicy_e)((0x7) & Console_PromptForInt("Enter workload policy: "));
+    ctx->policy = (workloadScalingPolicy_e)((0x7) & Console_PromptForInt("Enter workload policy: "));
+    if (ctx->policy >= WORKLOAD_SCALING_NUM)
+    {
+        ctx->policy = WORKLOAD_SCALING_NONE;
+    }
+    if (ctx->policy == WORKLOAD_SCALING_AIMD)
+    {
+        units = Console_PromptForInt("Enter AIMD increase (workload units): ");
+        ctx->aimdIncreaseUnits = (units > 0) ? (uint16_t)units : DEFAULT_AIMD_INCREASE_UNITS;
+        percent = Console_PromptForInt("Enter AIMD decrease (% of size kept): ");
+        // A failure has to shrink the chunk
+        ctx->aimdDecreasePercent = ((percent > 0) && (percent < 100)) ? (uint8_t)percent : DEFAULT_AIMD_DECREASE_PERCENT;
+    }
+    if (ctx->policy == WORKLOAD_SCALING_PREDICTIVE)
+    {
+        percent = Console_PromptForInt("Enter predictive margin (% of std dev): ");
+        ctx->predictiveMarginPercent = (percent >= 0) ? (uint16_t)percent : DEFAULT_PREDICTIVE_MARGIN_PERCENT;
+    }
+    Console_Print("Choose a commit mode:");
+    for (i = 0; i < COMMIT_MODE_NUM; i++)
+    {
+        Console_Print(" [%u] - %s", i, commitModeStrings[i]);
+    }
+    Console_PrintNewLine();
+    ctx->commitMode = (commitMode_e)((0x1) & Console_PromptForInt("Enter commit mode: "));
+    Console_Print("Choose a workload:");
+    for (i = 0; i < WORKLOAD_NUM; i++)
+    {
+        Console_Print(" [%u] - "ANSI_COLOR_MAGENTA"%s"ANSI_COLOR_RESET, i, workloadTable[i].name);
+    }
+    Console_PrintNewLine();
+    workload = (workloadType_e)((0x7) & Console_PromptForInt("Enter workload: "));
+    ctx->workload = (workload < WORKLOAD_NUM) ? workload : WORKLOAD_AES;
+    if (ctx->workload == WORKLOAD_AES)
+    {
+        Console_Print("Choose a cipher mode:");
+        for (i = 0; i < CIPHER_MODE_NUM; i++)
+        {
+            Console_Print(" [%u] - %s", i, cipherModeStrings[i]);
+        }
+        Console_PrintNewLine();
+        mode = (cipherMode_e)((0x3) & Console_PromptForInt("Enter cipher mode: "));
+        Console_Print("Choose a plaintext source:");
+        for (i = 0; i < CIPHER_SOURCE_NUM; i++)
+        {
+            Console_Print(" [%u] - %s", i, cipherSourceStrings[i]);
+        }
+        Console_PrintNewLine();
+        source = (cipherSource_e)((0x1) & Console_PromptForInt("Enter plaintext source: "));
+        Console_Print("Choose an AES engine:");
+        for (i = 0; i < CIPHER_ENGINE_NUM; i++)
+        {
+            Console_Print(" [%u] - %s", i, cipherEngineStrings[i]);
+        }
+        Console_PrintNewLine();
+        engine = (cipherEngine_e)((0x3) & Console_PromptForInt("Enter AES engine: "));
+        Cipher_Init(&ctx->workloadState.stream, (mode < CIPHER_MODE_NUM) ? mode : CIPHER_MODE_ECB, source,
+                    (engine < CIPHER_ENGINE_NUM) ? engine : CIPHER_ENGINE_BLOCKING);
+    }
+    // Chunk sizes are whole units of the workload just chosen
+    Checkpointing_SetChunkBounds(ctx, startingChunkSize, minChunkSize, maxChunkSize);
+    ctx->sampleIntervalMicroseconds = 1000UL * (uint16_t)Console_PromptForInt("Enter sample interval (ms, 0 for none): ");
+    // New settings start a new run
+    ctx->resumeRun = false;
 
     // Print new settings
     Checkpointing_CurrentSettings(0, 0);
@@ -109,44 +409,100 @@ functionResult_e PowerLossEmu_Setup(unsigned int numArgs, int args[])
 }
 
 functionResult_e Checkpointing_CurrentSettings(unsigned int numArgs, int args[])
+{
+    Checkpointing_PrintSettings(&checkpointingObj);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief      Print the settings of a fixture instance
+ *
+ * @param[in]  ctx   The fixture instance
+ */
+void Checkpointing_PrintSettings(const checkpointingObj_t *ctx)
 {
     Console_Print("Current settings:");
     Console_PrintDivider();
-    Console_Print("Total workload size size: %llu B", checkpointingObj.totalWorkloadSizeBytes);
-    Console_Print("Starting chunk size: %u B", chunkScaleLut[(unsigned int)checkpointingObj.startingChunkScale]);
-    Console_Print("Dead-time between workloads: %lu us", checkpointingObj.deadTimeMicroseconds);
-    Console_Print("Success policy change threshold: %u", checkpointingObj.successThresh);
-    Console_Print("Failure policy change threshold: %u", checkpointingObj.failThresh);
-    Console_Print("Current workload scaling policy: %s", workloadScalingStrings[(unsigned int)checkpointingObj.policy]);
+    Console_Print("Total workload size size: %llu B", ctx->totalWorkloadSizeBytes);
+    Console_Print("Starting chunk size: %lu B", ctx->startingChunkSize);
+    Console_Print("Chunk size bounds: %lu to %lu B", ctx->minChunkSize, ctx->maxChunkSize);
+    Console_Print("Dead-time between workloads: %lu us", ctx->deadTimeMicroseconds);
+    Console_Print("Success policy change threshold: %u", ctx->successThresh);
+    Console_Print("Failure policy change threshold: %u", ctx->failThresh);
+    Console_Print("Current workload scaling policy: %s", workloadScalingStrings[(unsigned int)ctx->policy]);
+    if (ctx->policy == WORKLOAD_SCALING_AIMD)
+    {
+        Console_Print("AIMD increase: %lu B per success, decrease: to %u%% per failure",
+                      (uint32_t)ctx->aimdIncreaseUnits * workloadTable[(unsigned int)ctx->workload].unitSize,
+                      ctx->aimdDecreasePercent);
+    }
+    if (ctx->policy == WORKLOAD_SCALING_PREDICTIVE)
+    {
+        Console_Print("Predictive margin: %u%% of std dev", ctx->predictiveMarginPercent);
+    }
+    Console_Print("Commit mode: %s", commitModeStrings[(unsigned int)ctx->commitMode]);
+    Console_Print("Workload: "ANSI_COLOR_MAGENTA"%s"ANSI_COLOR_RESET, workloadTable[(unsigned int)ctx->workload].name);
+    if (ctx->workload == WORKLOAD_AES)
+    {
+        Console_Print("Cipher mode: %s over %s", cipherModeStrings[(unsigned int)ctx->workloadState.stream.mode],
+                      cipherSourceStrings[(unsigned int)ctx->workloadState.stream.source]);
+        Console_Print("AES engine: %s", cipherEngineStrings[(unsigned int)ctx->workloadState.stream.engine]);
+    }
+    Console_Print("Goodput sample interval: %lu us", ctx->sampleIntervalMicroseconds);
     Console_PrintDivider();
-
-    return SUCCESS;
 }
 
 functionResult_e Checkpointing_WorkloadLoop(unsigned int numArgs, int args[])
 {
-    uint32_t startTicks;
-    uint32_t currentTicks;
+    checkpointingObj_t *ctx = &checkpointingObj;
     uint32_t workloadStart;
     uint32_t workloadEnd;
     uint32_t progressTicks;
+    uint32_t sampleTicks;
+    uint32_t powerLossesStart;
 
-    // Reset runtime variables
-    checkpointingObj.currentChunkScale = checkpointingObj.startingChunkScale;
-    checkpointingObj.bytesProcessed = 0;
-    checkpointingObj.workloadFails = 0;
+    if (ctx->resumeRun)
+    {
+        // Carry on from the checkpoint restored at boot, settings included
+        ctx->resumeRun = false;
+        Checkpointing_CurrentSettings(0, 0);
+        Console_Print("Resuming from checkpoint %lu: %llu of %llu B done",
+                      Checkpoint_GetSequence(ctx->checkpoints), ctx->bytesProcessed, ctx->totalWorkloadSizeBytes);
+    }
+    else
+    {
+        // Reset runtime variables
+        Checkpointing_SetChunkSize(ctx, ctx->startingChunkSize);
+        ctx->unitCostQ8 = 0;
+        Checkpointing_ResetBandit(ctx);
+        ctx->bytesProcessed = 0;
+        ctx->workloadFails = 0;
+        ctx->workloadSuccesses = 0;
+        workloadTable[(unsigned int)ctx->workload].init(&ctx->workloadState);
 
-    // Seed random value
-    srand(Utils_GetUptimeMicroseconds());
+        // Seed random value
+        Checkpointing_Seed(ctx, Utils_GetUptimeMicroseconds());
 
-    // Print current settings
-    Checkpointing_CurrentSettings(0, 0);
+        // Print current settings
+        Checkpointing_CurrentSettings(0, 0);
+    }
+    Checkpointing_ResetStats(ctx);
+
+    // Commit where the run starts from, so what a power loss salvages from
+    // its first chunk lands on it: not on the previous run's last commit, nor
+    // on a resumed commit without the units salvaged on top of it
+    if (ctx->checkpoints != NULL)
+    {
+        Checkpoint_Commit(ctx->checkpoints, ctx);
+    }
 
     // Wait for the first power-loss pulse from the power-loss emulator
-    checkpointingObj.powerLoss = false;
+    ctx->powerLoss = false;
     Console_Print("Waiting for power-loss emulator sync...");
-    while (!checkpointingObj.powerLoss);
-    checkpointingObj.powerLoss = false;
+    while (!ctx->powerLoss);
+    ctx->powerLoss = false;
+    Trace_MarkRunStart(ctx);
     Console_Print(ANSI_COLOR_GREEN"SYNC!"ANSI_COLOR_RESET);
 
     Console_Print("Beginning workload...");
@@ -155,28 +511,22 @@ functionResult_e Checkpointing_WorkloadLoop(unsigned int numArgs, int args[])
 
     workloadStart = Utils_GetUptimeMicroseconds();
     progressTicks = workloadStart;
+    sampleTicks = workloadStart;
+    powerLossesStart = Checkpointing_GetPowerLossCount(ctx);
+    Sampler_Reset(&samplerRing);
+    if (ctx->sampleIntervalMicroseconds != 0)
+    {
+        Sampler_Record(&samplerRing, ctx, 0, 0);
+    }
     // Main loop
     for (;;)
     {
-        // Perform our AES workload
-        Checkpointing_DoAes();
+        // Perform a chunk of our workload
+        Checkpointing_DoChunk(ctx);
 
         // Wait for a dead-time, simulates work that needs to be performed in
         // between our workloads.
-        startTicks = Utils_GetUptimeMicroseconds();
-        do
-        {
-            // If we encounter a power-loss here, that's ok!, But reset the
-            // timer. This will also reset the power-loss flag experienced
-            // during our workload.
-            if (checkpointingObj.powerLoss)
-            {
-                checkpointingObj.powerLoss = false;
-                startTicks = Utils_GetUptimeMicroseconds();
-            }
-            currentTicks = Utils_GetUptimeMicroseconds();
-        }
-        while ((currentTicks - startTicks) < checkpointingObj.deadTimeMicroseconds);
+        Checkpointing_WaitDeadTime(ctx);
 
         if ((Utils_GetUptimeMicroseconds() - progressTicks) > 1000000UL)
         {
@@ -185,7 +535,15 @@ functionResult_e Checkpointing_WorkloadLoop(unsigned int numArgs, int args[])
             fflush(stdout);
         }
 
-        if (checkpointingObj.bytesProcessed >= checkpointingObj.totalWorkloadSizeBytes)
+        if ((ctx->sampleIntervalMicroseconds != 0) &&
+            ((Utils_GetUptimeMicroseconds() - sampleTicks) >= ctx->sampleIntervalMicroseconds))
+        {
+            sampleTicks = Utils_GetUptimeMicroseconds();
+            Sampler_Record(&samplerRing, ctx, sampleTicks - workloadStart,
+                           Checkpointing_GetPowerLossCount(ctx) - powerLossesStart);
+        }
+
+        if (ctx->bytesProcessed >= ctx->totalWorkloadSizeBytes)
         {
             // We're done! Leave the workload loop
             break;
@@ -197,87 +555,701 @@ functionResult_e Checkpointing_WorkloadLoop(unsigned int numArgs, int args[])
         }
     }
     workloadEnd = Utils_GetUptimeMicroseconds();
+    if (ctx->sampleIntervalMicroseconds != 0)
+    {
+        Sampler_Record(&samplerRing, ctx, workloadEnd - workloadStart,
+                       Checkpointing_GetPowerLossCount(ctx) - powerLossesStart);
+    }
 
     Console_PrintNewLine();
     Console_Print("Workload complete!");
     Console_PrintDivider();
-    Console_Print("Processed %llu bytes", checkpointingObj.bytesProcessed);
+    Console_Print("Processed %llu bytes", ctx->bytesProcessed);
     Console_Print("Took "ANSI_COLOR_GREEN"%f"ANSI_COLOR_RESET" s", (workloadEnd - workloadStart)/1000000.0);
     Console_PrintDivider();
+    Checkpointing_PrintStats(ctx, workloadEnd - workloadStart);
+    Console_PrintDivider();
+    Checkpointing_PrintChunkStats(ctx);
+    Console_PrintDivider();
+    if (ctx->sampleIntervalMicroseconds != 0)
+    {
+        Console_Print("Goodput over time:");
+        Sampler_Print(&samplerRing);
+        Console_PrintDivider();
+    }
     // Turn on green LED for completion
     GPIO_setOutputHighOnPin(GPIO_PORT_P1, GPIO_PIN1);
 
     return SUCCESS;
 }
 
+/**
+ * @brief      Wait for the dead-time between chunks. A power loss during the
+ *             wait restarts it.
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_WaitDeadTime(checkpointingObj_t *ctx)
+{
+    const checkpointingPlatform_t *platform = ctx->platform;
+    uint32_t firstTicks;
+    uint32_t startTicks;
+    uint32_t currentTicks;
+
+    firstTicks = platform->getMicroseconds(ctx);
+    startTicks = firstTicks;
+    for (;;)
+    {
+        // If we encounter a power-loss here, that's ok!, But reset the
+        // timer. This will also reset the power-loss flag experienced
+        // during our workload.
+        if (ctx->powerLoss)
+        {
+            ctx->powerLoss = false;
+            startTicks = platform->getMicroseconds(ctx);
+        }
+        currentTicks = platform->getMicroseconds(ctx);
+        if ((currentTicks - startTicks) >= ctx->deadTimeMicroseconds)
+        {
+            break;
+        }
+        if (platform->waitUntil != NULL)
+        {
+            platform->waitUntil(ctx, startTicks + ctx->deadTimeMicroseconds);
+        }
+    }
+
+    ctx->stats.deadTimeMicroseconds += currentTicks - firstTicks;
+    ctx->stats.deadTimeRestartMicroseconds += startTicks - firstTicks;
+}
+
 /**
  * @brief      Mark that work has started
  */
-void Checkpointing_MarkWorkStart(void)
+void Checkpointing_MarkWorkStart(checkpointingObj_t *ctx)
 {
-    GPIO_setOutputHighOnPin(GPIO_PORT_P4, GPIO_PIN1);
-    checkpointingObj.currentlyWorking = true;
+    if (ctx->platform->markWork != NULL)
+    {
+        ctx->platform->markWork(true);
+    }
+    ctx->currentlyWorking = true;
 }
 
 /**
  * @brief      Mark that work has ended
  */
-void Checkpointing_MarkWorkEnd(void)
+void Checkpointing_MarkWorkEnd(checkpointingObj_t *ctx)
 {
-    GPIO_setOutputLowOnPin(GPIO_PORT_P4, GPIO_PIN1);
-    checkpointingObj.currentlyWorking = false;
+    if (ctx->platform->markWork != NULL)
+    {
+        ctx->platform->markWork(false);
+    }
+    ctx->currentlyWorking = false;
 }
 
 /**
- * @brief      Perform our work.
+ * @brief      Signal a power loss to a fixture instance. This is the path
+ *             every power loss takes, from the PORT8 ISR or from a replay.
+ *
+ * @param      ctx   The fixture instance
  */
-void Checkpointing_DoAes(void)
+void Checkpointing_SignalPowerLoss(checkpointingObj_t *ctx)
 {
-    uint16_t i;
-    // Copy the string we want to encrypt to our buffer
-    const char stringToEncrypt[] = "Meat popsicle";
-    memcpy(message, stringToEncrypt, sizeof(stringToEncrypt));
+    // Snapshot how far the chunk got before the first power loss to hit it.
+    // In just-in-time mode that is also checkpointed.
+    const workload_t *workload = &workloadTable[(unsigned int)ctx->workload];
+    uint16_t unitsDone;
 
-    // Do stuff
-    // Signal that work is starting
-    Checkpointing_MarkWorkStart();
-    for (i = 0; i < chunkScaleLut[(unsigned int)checkpointingObj.currentChunkScale]; i += AES_MINIMUM_CHUNK_SIZE)
-    {
-        // Encrypt data with preloaded cipher key. For this fixture, we will be
-        // performing work on the same message (no real work is being done, just
-        // counting how many successful chunks we've accomplished.
-        AES256_encryptData(AES256_BASE, (uint8_t*)(message), dataAESencrypted);
-        // Check if we need to abort our current chunk
-        if (checkpointingObj.powerLoss)
-        {
-            // If we raised a power-loss flag, it means that at some point during our
-            // current chunk we encountered a power-loss. This chunk is no
-            // longer valid. Break out of loop.
-            break;
+    if (ctx->currentlyWorking && !ctx->powerLoss)
+    {
+        // A chunk run off the CPU stops here, with the units it finished
+        if ((workload->abortChunk != NULL) && workload->abortChunk(&unitsDone))
+        {
+            ctx->chunkUnitsDone = unitsDone;
         }
+        ctx->salvageUnits = ctx->chunkUnitsDone;
+        if ((ctx->commitMode == COMMIT_MODE_JIT) && (ctx->checkpoints != NULL))
+        {
+            Checkpoint_CommitJit(ctx->checkpoints, ctx->chunkUnitsDone);
+        }
+    }
+    // Signal that power loss has occurred
+    ctx->powerLoss = true;
+    ctx->powerLossCount++;
+    Checkpointing_ObservePowerLoss(ctx, Utils_GetUptimeMicroseconds());
+    // Keep a record of it
+    Trace_RecordPowerLoss(ctx);
+}
+
+/**
+ * @brief      Fold a power loss into an instance's inter-arrival estimate.
+ *             Called with interrupts off, from the PORT8 ISR by way of
+ *             Checkpointing_SignalPowerLoss(), or by a simulation.
+ *
+ * @param      ctx                    The fixture instance
+ * @param[in]  timestampMicroseconds  Uptime of the power loss
+ */
+void Checkpointing_ObservePowerLoss(checkpointingObj_t *ctx, uint32_t timestampMicroseconds)
+{
+    volatile checkpointingArrivals_t *arrivals = &ctx->arrivals;
+    uint32_t interval = timestampMicroseconds - arrivals->lastMicroseconds;
+    unsigned int shift = 0;
+    int32_t deviationQ4;
+    int32_t deviation;
+    uint64_t squared;
+
+    // Keep intervals in 1/16 us within an int32_t, a gap of over two minutes
+    // is off the scale anyway
+    if (interval > (INT32_MAX >> 4))
+    {
+        interval = INT32_MAX >> 4;
+    }
+    if (arrivals->events == 0)
+    {
+        // Nothing to measure an interval from yet
+    }
+    else if (arrivals->events == 1)
+    {
+        arrivals->meanQ4 = interval << 4;
+        arrivals->variance = 0;
     }
+    else
+    {
+        deviationQ4 = (int32_t)(interval << 4) - (int32_t)arrivals->meanQ4;
+        deviation = deviationQ4 >> 4;
+        squared = (uint64_t)((int64_t)deviation * deviation);
+        // Weighed by 1/2 for the second and third intervals, 1/4 up to the
+        // seventh and 1/8 from then on
+        while ((shift < PREDICTIVE_EWMA_SHIFT) && ((arrivals->events >> (shift + 1)) != 0))
+        {
+            shift++;
+        }
+        arrivals->meanQ4 += deviationQ4 >> shift;
+        arrivals->variance = arrivals->variance - (arrivals->variance >> shift) + (squared >> shift);
+    }
+    arrivals->lastMicroseconds = timestampMicroseconds;
+    if (arrivals->events != UINT16_MAX)
+    {
+        arrivals->events++;
+    }
+    arrivals->sequence++;
+}
+
+/**
+ * @brief      Get the number of power losses signalled to an instance
+ *
+ * @param[in]  ctx   The fixture instance
+ *
+ * @return     The count, read consistently with the ISR updating it
+ */
+uint32_t Checkpointing_GetPowerLossCount(const checkpointingObj_t *ctx)
+{
+    uint32_t count;
+
+    // The MSP430 reads the count in two halves; read again if the ISR counted
+    // in between
+    do
+    {
+        count = ctx->powerLossCount;
+    }
+    while (count != ctx->powerLossCount);
+
+    return count;
+}
+
+static uint32_t Checkpointing_BoardMicroseconds(const checkpointingObj_t *ctx)
+{
+    return Utils_GetUptimeMicroseconds();
+}
+
+/**
+ * @brief      Raise P4.1 while a chunk is in flight, for the power-loss
+ *             emulator and the logic analyser
+ */
+static void Checkpointing_BoardMarkWork(bool working)
+{
+    if (working)
+    {
+        GPIO_setOutputHighOnPin(GPIO_PORT_P4, GPIO_PIN1);
+    }
+    else
+    {
+        GPIO_setOutputLowOnPin(GPIO_PORT_P4, GPIO_PIN1);
+    }
+}
+
+/**
+ * @brief      Run a chunk's units with the workload's own code
+ */
+static uint32_t Checkpointing_BoardRunChunk(checkpointingObj_t *ctx, workloadState_t *state, uint32_t chunkSize)
+{
+    const workload_t *workload = &workloadTable[(unsigned int)ctx->workload];
+    uint32_t i = 0;
+    uint16_t unitsDone;
+
+    if (workload->beginChunk != NULL)
+    {
+        workload->beginChunk(state, (uint16_t)(chunkSize / workload->unitSize));
+    }
+    if ((workload->waitChunk != NULL) && workload->waitChunk(state, &unitsDone))
+    {
+        // The chunk ran as a whole, off the CPU while it slept or in runs.
+        // A power loss stops it (and wakes the CPU up); the unit it cut
+        // short ran too.
+        ctx->chunkUnitsDone = unitsDone;
+        i = ctx->chunkUnitsDone * workload->unitSize;
+        if (ctx->powerLoss && (i < chunkSize))
+        {
+            i += workload->unitSize;
+        }
+    }
+    else if (workload->doUnit != NULL)
+    {
+        for (i = 0; i < chunkSize; i += workload->unitSize)
+        {
+            // Do the next unit of the workload
+            workload->doUnit(state);
+            ctx->chunkUnitsDone++;
+            // Check if we need to abort our current chunk
+            if (ctx->powerLoss)
+            {
+                // If we raised a power-loss flag, it means that at some point during our
+                // current chunk we encountered a power-loss. This chunk is no
+                // longer valid. Break out of loop.
+                i += workload->unitSize;
+                break;
+            }
+        }
+    }
+    if (workload->endChunk != NULL)
+    {
+        workload->endChunk(state);
+    }
+
+    return i;
+}
+
+/**
+ * @brief      Checkpoint to the instance's store, if it has one
+ */
+static bool Checkpointing_BoardCommit(checkpointingObj_t *ctx)
+{
+    if (ctx->checkpoints == NULL)
+    {
+        return false;
+    }
+    Checkpoint_Commit(ctx->checkpoints, ctx);
+
+    return true;
+}
+
+/**
+ * @brief      Perform a chunk of our workload.
+ */
+void Checkpointing_DoChunk(checkpointingObj_t *ctx)
+{
+    const checkpointingPlatform_t *platform = ctx->platform;
+    uint32_t chunkSize = ctx->currentChunkSize;
+    uint32_t chunkStart;
+    uint32_t checkpointStart;
+    uint64_t bytesProcessed = ctx->bytesProcessed;
+    const workload_t *workload = &workloadTable[(unsigned int)ctx->workload];
+    // The chunk works from where the last committed chunk left off
+    workloadState_t chunkState = ctx->workloadState;
+
+    // Do stuff
+    ctx->chunkUnitsDone = 0;
+    ctx->salvageUnits = 0;
+    // Signal that work is starting
+    Checkpointing_MarkWorkStart(ctx);
+    chunkStart = platform->getMicroseconds(ctx);
+    ctx->chunkBytesRun = platform->runChunk(ctx, &chunkState, chunkSize);
+    ctx->chunkEndMicroseconds = platform->getMicroseconds(ctx);
+    ctx->chunkMicroseconds = ctx->chunkEndMicroseconds - chunkStart;
     // Signal that work has halted
-    Checkpointing_MarkWorkEnd();
+    Checkpointing_MarkWorkEnd(ctx);
 
     // Execute workload policy
-    Checkpointing_ExecutePolicy();
+    Checkpointing_ExecutePolicy(ctx);
+
+    if (ctx->bytesProcessed == bytesProcessed)
+    {
+        // Nothing committed, the next chunk starts over from the same place
+        return;
+    }
+    if ((ctx->bytesProcessed - bytesProcessed) == chunkSize)
+    {
+        // The whole chunk committed, its state carries on
+        ctx->workloadState = chunkState;
+    }
+    else
+    {
+        // Only the units salvaged before a power loss committed
+        workload->advance(&ctx->workloadState,
+                          (uint32_t)((ctx->bytesProcessed - bytesProcessed) / workload->unitSize));
+    }
+
+    // Persist the progress of a chunk that committed, along with the workload
+    // and policy state it left behind
+    checkpointStart = platform->getMicroseconds(ctx);
+    if (platform->commit(ctx))
+    {
+        ctx->stats.checkpointMicroseconds += platform->getMicroseconds(ctx) - checkpointStart;
+        ctx->stats.checkpointCommits++;
+    }
+}
+
+/**
+ * @brief      Count the times the maximum chunk size can be halved while it
+ *             stays within the minimum
+ *
+ * @param      ctx   The fixture instance
+ *
+ * @return     The number of halvings
+ */
+static unsigned int Checkpointing_CountChunkHalvings(const checkpointingObj_t *ctx)
+{
+    unsigned int halvings = 0;
+
+    while ((ctx->maxChunkSize >> (halvings + 1)) >= ctx->minChunkSize)
+    {
+        halvings++;
+    }
+
+    return halvings;
+}
+
+/**
+ * @brief      Pick a random chunk size for the random policies, the maximum
+ *             halved a random number of times while it stays within the
+ *             minimum
+ *
+ * @param      ctx   The fixture instance
+ *
+ * @return     Chunk size in bytes
+ */
+static uint32_t Checkpointing_RandomChunkSize(checkpointingObj_t *ctx)
+{
+    return ctx->maxChunkSize >> (Checkpointing_Random(ctx) % (Checkpointing_CountChunkHalvings(ctx) + 1));
+}
+
+/**
+ * @brief      Integer square root
+ *
+ * @param[in]  value  The value
+ *
+ * @return     The square root, rounded down
+ */
+static uint32_t Checkpointing_SquareRoot(uint64_t value)
+{
+    uint64_t bit = 1ULL << 62;
+    uint64_t root = 0;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= (root + bit))
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)root;
+}
+
+/**
+ * @brief      Fold the chunk that just ended into the measured cost of a
+ *             workload unit, whether it committed or not
+ *
+ * @param      ctx   The fixture instance
+ */
+static void Checkpointing_UpdateUnitCost(checkpointingObj_t *ctx)
+{
+    uint32_t units = ctx->chunkBytesRun / workloadTable[(unsigned int)ctx->workload].unitSize;
+    uint32_t costQ8;
+
+    if ((units == 0) || (ctx->chunkMicroseconds >= (UINT32_MAX >> 8)))
+    {
+        return;
+    }
+    costQ8 = (ctx->chunkMicroseconds << 8) / units;
+    if (ctx->unitCostQ8 == 0)
+    {
+        ctx->unitCostQ8 = costQ8;
+    }
+    else
+    {
+        ctx->unitCostQ8 = (uint32_t)((int32_t)ctx->unitCostQ8 +
+                                      (((int32_t)costQ8 - (int32_t)ctx->unitCostQ8) >> PREDICTIVE_EWMA_SHIFT));
+    }
+}
+
+/**
+ * @brief      Size the next chunk for the predictive policy. The on-window is
+ *             predicted to last the mean time between power losses; one that
+ *             has already outlasted the mean is given another mean to go.
+ *             What is left of it once the dead-time is waited out is cut
+ *             short by mean / (mean + margin), the margin being its share of
+ *             the standard deviation, and the chunk gets the units that fit.
+ *
+ * @param      ctx   The fixture instance
+ *
+ * @return     Chunk size in bytes, the current one until the estimate is
+ *             trusted
+ */
+static uint32_t Checkpointing_PredictChunkSize(checkpointingObj_t *ctx)
+{
+    checkpointingArrivals_t arrivals;
+    uint16_t sequence;
+    uint32_t window;
+    uint32_t margin;
+    uint32_t age;
+    uint32_t remaining;
+    uint32_t units;
+    uint16_t unitSize = workloadTable[(unsigned int)ctx->workload].unitSize;
+
+    // The ISR updates the estimate in several writes; copy it again if one
+    // landed in between
+    do
+    {
+        sequence = ctx->arrivals.sequence;
+        arrivals = ctx->arrivals;
+    }
+    while (sequence != ctx->arrivals.sequence);
+
+    if ((arrivals.events < PREDICTIVE_MIN_EVENTS) || (arrivals.meanQ4 < 16) || (ctx->unitCostQ8 == 0))
+    {
+        return ctx->currentChunkSize;
+    }
+    // The square root is only worked out again when the estimate moves
+    if (sequence != ctx->arrivalDeviationSequence)
+    {
+        ctx->arrivalDeviationMicroseconds = Checkpointing_SquareRoot(arrivals.variance);
+        ctx->arrivalDeviationSequence = sequence;
+    }
+
+    window = arrivals.meanQ4 >> 4;
+    margin = (uint32_t)(((uint64_t)ctx->arrivalDeviationMicroseconds * ctx->predictiveMarginPercent) / 100);
+    age = (ctx->chunkEndMicroseconds + ctx->deadTimeMicroseconds) - arrivals.lastMicroseconds;
+    remaining = (age < window) ? (window - age) : window;
+    remaining = (uint32_t)(((uint64_t)remaining * window) / ((uint64_t)window + margin));
+    units = (uint32_t)(((uint64_t)remaining << 8) / ctx->unitCostQ8);
+
+    return (units < (CHUNK_SIZE_LIMIT / unitSize)) ? (units * unitSize) : CHUNK_SIZE_LIMIT;
+}
+
+/**
+ * @brief      Forget what the bandit policy has learned, its next pick tries
+ *             every arm again
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_ResetBandit(checkpointingObj_t *ctx)
+{
+    memset(ctx->banditArms, 0, sizeof(ctx->banditArms));
+    ctx->banditArm = BANDIT_NO_ARM;
+    ctx->banditEpoch = 0;
+    ctx->banditPulls = 0;
+    ctx->banditPendingArm = BANDIT_NO_ARM;
+}
+
+/**
+ * @brief      Work out an arm's UCB1 exploration bonus
+ *
+ * @param      ctx   The fixture instance
+ * @param      arm   The arm, pulled at least once
+ */
+static void Checkpointing_UpdateBanditBonus(const checkpointingObj_t *ctx, checkpointingBanditArm_t *arm)
+{
+    // 2 ln n in 1/2^24 over the pulls, its square root is in 1/4096
+    uint32_t lnQ8 = ((uint32_t)ctx->banditEpoch + 1) * BANDIT_LN2_Q8;
+
+    arm->bonusQ12 = Checkpointing_SquareRoot((lnQ8 << 17) / arm->pulls);
 }
 
-void Checkpointing_ExecutePolicy(void)
+/**
+ * @brief      Work out every pulled arm's exploration bonus
+ *
+ * @param      ctx   The fixture instance
+ */
+static void Checkpointing_UpdateBanditBonuses(checkpointingObj_t *ctx)
+{
+    unsigned int i;
+
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        if (ctx->banditArms[i].pulls != 0)
+        {
+            Checkpointing_UpdateBanditBonus(ctx, &ctx->banditArms[i]);
+        }
+    }
+}
+
+/**
+ * @brief      Pick the bandit policy up from the arms, pulls and epoch of a
+ *             checkpoint. The bonuses aren't checkpointed and are worked out
+ *             again. The reward of the chunk before it is lost, it was being
+ *             timed in the uptime of before the reset.
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_RestoreBandit(checkpointingObj_t *ctx)
+{
+    ctx->banditPendingArm = BANDIT_NO_ARM;
+    Checkpointing_UpdateBanditBonuses(ctx);
+}
+
+/**
+ * @brief      Reward the arm the chunk before the one that just ended ran
+ *             with the goodput it got, over its own time and the time from
+ *             its end to the start of this one: the dead-time as it was
+ *             waited out, restarts included, and its commit. This chunk's
+ *             reward waits for the dead-time after it. The bonuses only
+ *             shrink with ln n, so they are all worked out again only when n
+ *             doubles, in between just the pulled arm's is.
+ *
+ * @param      ctx             The fixture instance
+ * @param[in]  committedBytes  The bytes the chunk that just ended committed
+ */
+static void Checkpointing_UpdateBandit(checkpointingObj_t *ctx, uint32_t committedBytes)
+{
+    checkpointingBanditArm_t *arm;
+    uint32_t chunkStart = ctx->chunkEndMicroseconds - ctx->chunkMicroseconds;
+    uint32_t elapsed = ctx->banditPendingMicroseconds + (chunkStart - ctx->banditPendingEndMicroseconds);
+    uint32_t rewardedBytes = ctx->banditPendingBytes;
+    uint8_t rewardedArm = ctx->banditPendingArm;
+    uint32_t reward;
+    uint8_t epoch = 0;
+
+    ctx->banditPendingArm = ctx->banditArm;
+    ctx->banditPendingBytes = committedBytes;
+    ctx->banditPendingMicroseconds = ctx->chunkMicroseconds;
+    ctx->banditPendingEndMicroseconds = ctx->chunkEndMicroseconds;
+    if ((rewardedArm >= CHUNK_STATS_BUCKETS) || (elapsed == 0))
+    {
+        return;
+    }
+    arm = &ctx->banditArms[rewardedArm];
+    reward = (rewardedBytes << BANDIT_REWARD_SHIFT) / elapsed;
+    arm->pulls++;
+    arm->meanQ12 = (uint32_t)((int32_t)arm->meanQ12 + ((int32_t)reward - (int32_t)arm->meanQ12) / (int32_t)arm->pulls);
+
+    ctx->banditPulls++;
+    while ((ctx->banditPulls >> (epoch + 1)) != 0)
+    {
+        epoch++;
+    }
+    if (epoch == ctx->banditEpoch)
+    {
+        Checkpointing_UpdateBanditBonus(ctx, arm);
+        return;
+    }
+    ctx->banditEpoch = epoch;
+    Checkpointing_UpdateBanditBonuses(ctx);
+}
+
+/**
+ * @brief      Pick the bandit policy's next arm: one not tried yet, largest
+ *             first, otherwise the one with the highest mean plus bonus. The
+ *             bonus is scaled by the best mean, so the exploration it buys is
+ *             in proportion to the goodputs at stake.
+ *
+ * @param      ctx   The fixture instance
+ *
+ * @return     Chunk size in bytes
+ */
+static uint32_t Checkpointing_PickBanditArm(checkpointingObj_t *ctx)
+{
+    unsigned int arms = Checkpointing_CountChunkHalvings(ctx) + 1;
+    uint32_t bestMean = 0;
+    uint32_t bestIndex = 0;
+    uint32_t index;
+    unsigned int i;
+
+    ctx->banditArm = 0;
+    for (i = 0; i < arms; i++)
+    {
+        if (ctx->banditArms[i].pulls == 0)
+        {
+            ctx->banditArm = (uint8_t)i;
+            return ctx->maxChunkSize >> i;
+        }
+        if (ctx->banditArms[i].meanQ12 > bestMean)
+        {
+            bestMean = ctx->banditArms[i].meanQ12;
+        }
+    }
+    for (i = 0; i < arms; i++)
+    {
+        index = ctx->banditArms[i].meanQ12 +
+                (uint32_t)(((uint64_t)bestMean * ctx->banditArms[i].bonusQ12) >> BANDIT_REWARD_SHIFT);
+        if (index > bestIndex)
+        {
+            bestIndex = index;
+            ctx->banditArm = (uint8_t)i;
+        }
+    }
+
+    return ctx->maxChunkSize >> ctx->banditArm;
+}
+
+/**
+ * @brief      Account for the chunk that just ended and pick the next chunk
+ *             size. The caller fills in chunkMicroseconds,
+ *             chunkEndMicroseconds, chunkBytesRun and, for an interrupted
+ *             chunk, salvageUnits.
+ *
+ * @param      ctx   The fixture instance
+ */
+void Checkpointing_ExecutePolicy(checkpointingObj_t *ctx)
 {
-    bool powerLoss = checkpointingObj.powerLoss;
+    bool powerLoss = ctx->powerLoss;
+    uint32_t salvagedBytes;
+    uint32_t committedBytes;
+    checkpointingChunkStats_t *chunkStats = &ctx->stats.chunks[Checkpointing_GetChunkBucket(ctx->currentChunkSize, workloadTable[(unsigned int)ctx->workload].unitSize)];
+
+    if ((chunkStats->commits + chunkStats->aborts) == 0)
+    {
+        chunkStats->smallestChunkSize = ctx->currentChunkSize;
+        chunkStats->largestChunkSize = ctx->currentChunkSize;
+    }
+    else if (ctx->currentChunkSize < chunkStats->smallestChunkSize)
+    {
+        chunkStats->smallestChunkSize = ctx->currentChunkSize;
+    }
+    else if (ctx->currentChunkSize > chunkStats->largestChunkSize)
+    {
+        chunkStats->largestChunkSize = ctx->currentChunkSize;
+    }
+    chunkStats->totalMicroseconds += ctx->chunkMicroseconds;
+    chunkStats->attemptedBytes += ctx->currentChunkSize;
+    Checkpointing_UpdateUnitCost(ctx);
 
     // Successful work path (no power loss)
     if (!powerLoss)
     {
         // If we're here, the chunk successfully executed! Add to our total
         // bytes processed accumulator.
-        checkpointingObj.bytesProcessed += chunkScaleLut[(unsigned int)checkpointingObj.currentChunkScale];
+        committedBytes = ctx->currentChunkSize;
+        ctx->bytesProcessed += committedBytes;
 
         // Reset any previous failures since we've passed this one
-        checkpointingObj.workloadFails = 0;
+        ctx->workloadFails = 0;
         // Increment our successes
-        checkpointingObj.workloadSuccesses++;
+        ctx->workloadSuccesses++;
+
+        ctx->stats.committedMicroseconds += ctx->chunkMicroseconds;
+        chunkStats->commits++;
+        chunkStats->committedBytes += committedBytes;
 
     }
     // Failed work path (power loss has occurred)
@@ -286,13 +1258,32 @@ void Checkpointing_ExecutePolicy(void)
         // Chunk failed. We won't count this as work performed and we need to
         // modify our behaviour. Reset any previous successes since we've failed
         // this one.
-        checkpointingObj.workloadSuccesses = 0;
+        ctx->workloadSuccesses = 0;
         // Increment our failures
-        checkpointingObj.workloadFails++;
+        ctx->workloadFails++;
+
+        // The units finished before the power loss survive a just-in-time
+        // commit, the rest of the chunk is thrown away
+        salvagedBytes = (uint32_t)ctx->salvageUnits * workloadTable[(unsigned int)ctx->workload].unitSize;
+        if (salvagedBytes > ctx->chunkBytesRun)
+        {
+            salvagedBytes = ctx->chunkBytesRun;
+        }
+        ctx->stats.salvageableBytes += salvagedBytes;
+        if (ctx->commitMode != COMMIT_MODE_JIT)
+        {
+            salvagedBytes = 0;
+        }
+        committedBytes = salvagedBytes;
+        ctx->bytesProcessed += committedBytes;
+        ctx->stats.abortedMicroseconds += ctx->chunkMicroseconds;
+        ctx->stats.wastedBytes += ctx->chunkBytesRun - salvagedBytes;
+        chunkStats->aborts++;
+        chunkStats->committedBytes += committedBytes;
     }
 
     // Change the scaling based on current policy and variables
-    switch (checkpointingObj.policy)
+    switch (ctx->policy)
     {
         // Don't do any scaling
         case WORKLOAD_SCALING_NONE:
@@ -304,14 +1295,11 @@ void Checkpointing_ExecutePolicy(void)
         // Linearly scale the workload
         case WORKLOAD_SCALING_LINEAR:
         {
-            if (checkpointingObj.workloadFails >= checkpointingObj.failThresh)
+            if (ctx->workloadFails >= ctx->failThresh)
             {
-                checkpointingObj.workloadFails = 0;
+                ctx->workloadFails = 0;
                 // Workload scales linearly by 2 every failure. Don't go past min
-                if (checkpointingObj.currentChunkScale != CHUNK_SCALE_16)
-                {
-                    checkpointingObj.currentChunkScale = (chunkScale_e)((unsigned int)checkpointingObj.currentChunkScale + 1);
-                }
+                Checkpointing_SetChunkSize(ctx, ctx->currentChunkSize / 2);
             }
             // Scaling doesn't modify on successes
             break;
@@ -320,11 +1308,11 @@ void Checkpointing_ExecutePolicy(void)
         // Randomly scale the workload
         case WORKLOAD_SCALING_RANDOM:
         {
-            if (checkpointingObj.workloadFails >= checkpointingObj.failThresh)
+            if (ctx->workloadFails >= ctx->failThresh)
             {
-                checkpointingObj.workloadFails = 0;
+                ctx->workloadFails = 0;
                 // Pick a ramdom scaling value
-                checkpointingObj.currentChunkScale = (chunkScale_e)(rand() % CHUNK_SCALE_MAX);
+                Checkpointing_SetChunkSize(ctx, Checkpointing_RandomChunkSize(ctx));
             }
             // Scaling doesn't modify on successes
             break;
@@ -333,17 +1321,17 @@ void Checkpointing_ExecutePolicy(void)
         // Randomly scale the workload but in both directions
         case WORKLOAD_SCALING_RANDOM_ADAPTIVE:
         {
-            if (checkpointingObj.workloadFails >= checkpointingObj.failThresh)
+            if (ctx->workloadFails >= ctx->failThresh)
             {
-                checkpointingObj.workloadFails = 0;
+                ctx->workloadFails = 0;
                 // Pick a ramdom scaling value
-                checkpointingObj.currentChunkScale = (chunkScale_e)(rand() % CHUNK_SCALE_MAX);
+                Checkpointing_SetChunkSize(ctx, Checkpointing_RandomChunkSize(ctx));
             }
-            else if (checkpointingObj.workloadSuccesses >= checkpointingObj.successThresh)
+            else if (ctx->workloadSuccesses >= ctx->successThresh)
             {
-                checkpointingObj.workloadSuccesses = 0;
+                ctx->workloadSuccesses = 0;
                 // Pick a ramdom scaling value
-                checkpointingObj.currentChunkScale = (chunkScale_e)(rand() % CHUNK_SCALE_MAX);
+                Checkpointing_SetChunkSize(ctx, Checkpointing_RandomChunkSize(ctx));
             }
             break;
         }
@@ -351,24 +1339,54 @@ void Checkpointing_ExecutePolicy(void)
         // Linearly scale the workload but in both directions
         case WORKLOAD_SCALING_LINEAR_ADAPTIVE:
         {
-            if (checkpointingObj.workloadFails >= checkpointingObj.failThresh)
+            if (ctx->workloadFails >= ctx->failThresh)
             {
-                checkpointingObj.workloadFails = 0;
+                ctx->workloadFails = 0;
                 // Pick a ramdom scaling value
-                checkpointingObj.currentChunkScale = (chunkScale_e)(rand() % CHUNK_SCALE_MAX);
+                Checkpointing_SetChunkSize(ctx, Checkpointing_RandomChunkSize(ctx));
             }
-            else if (checkpointingObj.workloadSuccesses >= checkpointingObj.successThresh)
+            else if (ctx->workloadSuccesses >= ctx->successThresh)
             {
-                checkpointingObj.workloadSuccesses = 0;
+                ctx->workloadSuccesses = 0;
                 // Workload scales linearly by 2 every failure. Don't go past max;
-                if (checkpointingObj.currentChunkScale != CHUNK_SCALE_1024)
-                {
-                    checkpointingObj.currentChunkScale = (chunkScale_e)((unsigned int)checkpointingObj.currentChunkScale - 1);
-                }
+                Checkpointing_SetChunkSize(ctx, ctx->currentChunkSize * 2);
             }
             break;
         }
 
+        // Grow the chunk size a few units every success, cut it by a factor
+        // every failure
+        case WORKLOAD_SCALING_AIMD:
+        {
+            if (!powerLoss)
+            {
+                Checkpointing_SetChunkSize(ctx, ctx->currentChunkSize + (uint32_t)ctx->aimdIncreaseUnits *
+                                                workloadTable[(unsigned int)ctx->workload].unitSize);
+            }
+            else
+            {
+                Checkpointing_SetChunkSize(ctx, ((uint32_t)ctx->currentChunkSize * ctx->aimdDecreasePercent) / 100);
+            }
+            break;
+        }
+
+        // Fit the next chunk in what is predicted to be left of the on-window
+        case WORKLOAD_SCALING_PREDICTIVE:
+        {
+            Checkpointing_SetChunkSize(ctx, Checkpointing_PredictChunkSize(ctx));
+            break;
+        }
+
+        // Credit the size the chunk before ran with its goodput, now its
+        // dead-time is over, then run the size with the best goodput so far
+        // unless a less tried one might beat it
+        case WORKLOAD_SCALING_BANDIT:
+        {
+            Checkpointing_UpdateBandit(ctx, committedBytes);
+            Checkpointing_SetChunkSize(ctx, Checkpointing_PickBanditArm(ctx));
+            break;
+        }
+
         default:
         {
             Console_Print(ANSI_COLOR_RED"Invalid policy!"ANSI_COLOR_RESET);
@@ -377,5 +1395,76 @@ void Checkpointing_ExecutePolicy(void)
     }
 
     // Reset any power-loss since we've handled it by now
-    checkpointingObj.powerLoss = false;
+    ctx->powerLoss = false;
+}
+
+/**
+ * @brief      Set the starting chunk size and the bounds the policies keep
+ *             the chunk size within. Sizes are rounded down to whole units
+ *             of the instance's workload and kept within one unit and
+ *             CHUNK_SIZE_LIMIT, the maximum no smaller than the minimum and
+ *             the starting size between them. The current chunk size becomes
+ *             the starting one. Set the workload first.
+ *
+ * @param      ctx                The fixture instance
+ * @param[in]  startingChunkSize  The starting chunk size in bytes
+ * @param[in]  minChunkSize       The smallest chunk size in bytes
+ * @param[in]  maxChunkSize       The largest chunk size in bytes
+ */
+void Checkpointing_SetChunkBounds(checkpointingObj_t *ctx, uint32_t startingChunkSize, uint32_t minChunkSize,
+                                  uint32_t maxChunkSize)
+{
+    uint16_t unitSize = workloadTable[(unsigned int)ctx->workload].unitSize;
+
+    ctx->minChunkSize = unitSize;
+    ctx->maxChunkSize = CHUNK_SIZE_LIMIT - (CHUNK_SIZE_LIMIT % unitSize);
+    Checkpointing_SetChunkSize(ctx, minChunkSize);
+    ctx->minChunkSize = ctx->currentChunkSize;
+    Checkpointing_SetChunkSize(ctx, maxChunkSize);
+    ctx->maxChunkSize = ctx->currentChunkSize;
+    Checkpointing_SetChunkSize(ctx, startingChunkSize);
+    ctx->startingChunkSize = ctx->currentChunkSize;
+}
+
+/**
+ * @brief      Set the chunk size in bytes. The size is rounded down to whole
+ *             units of the instance's workload and kept within the instance's
+ *             chunk size bounds.
+ *
+ * @param      ctx        The fixture instance
+ * @param[in]  chunkSize  The chunk size in bytes
+ */
+void Checkpointing_SetChunkSize(checkpointingObj_t *ctx, uint32_t chunkSize)
+{
+    chunkSize -= chunkSize % workloadTable[(unsigned int)ctx->workload].unitSize;
+    if (chunkSize < ctx->minChunkSize)
+    {
+        chunkSize = ctx->minChunkSize;
+    }
+    else if (chunkSize > ctx->maxChunkSize)
+    {
+        chunkSize = ctx->maxChunkSize;
+    }
+    ctx->currentChunkSize = chunkSize;
+}
+
+/**
+ * @brief      Get the chunk stats a chunk size counts towards, the power of two
+ *             multiple of the unit at or below it
+ *
+ * @param[in]  chunkSize  The chunk size in bytes
+ * @param[in]  unitSize   The workload's unit size in bytes
+ *
+ * @return     Index into the chunk stats
+ */
+unsigned int Checkpointing_GetChunkBucket(uint32_t chunkSize, uint16_t unitSize)
+{
+    unsigned int bucket = 0;
+
+    while (((chunkSize / unitSize) >> (bucket + 1)) != 0)
+    {
+        bucket++;
+    }
+
+    return (bucket < CHUNK_STATS_BUCKETS) ? bucket : (CHUNK_STATS_BUCKETS - 1);
 }
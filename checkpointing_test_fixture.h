@@ -27,6 +27,8 @@
 
 #include <stdbool.h>
 #include "console.h"
+#include "cipher.h"
+#include "workload.h"
 
 typedef enum
 {
@@ -35,31 +37,139 @@ typedef enum
     WORKLOAD_SCALING_RANDOM = 2,
     WORKLOAD_SCALING_RANDOM_ADAPTIVE = 3,
     WORKLOAD_SCALING_LINEAR_ADAPTIVE = 4,
-    WORKLOAD_SCALING_NUM = 5,
+    // Additive increase, multiplicative decrease of a byte-granular size
+    WORKLOAD_SCALING_AIMD = 5,
+    // Fit each chunk in the on-window predicted from power-loss arrivals
+    WORKLOAD_SCALING_PREDICTIVE = 6,
+    // Treat each power-of-two size as a bandit arm and settle on the one with
+    // the best goodput (UCB1)
+    WORKLOAD_SCALING_BANDIT = 7,
+    WORKLOAD_SCALING_NUM = 8,
 } workloadScalingPolicy_e;
 
 typedef enum
 {
-    CHUNK_SCALE_1024 = 0,
-    CHUNK_SCALE_512 = 1,
-    CHUNK_SCALE_256 = 2,
-    CHUNK_SCALE_128 = 3,
-    CHUNK_SCALE_64 = 4,
-    CHUNK_SCALE_32 = 5,
-    CHUNK_SCALE_16 = 6,
-    CHUNK_SCALE_MAX = 7,
-} chunkScale_e;
+    // A power loss throws away the whole chunk
+    COMMIT_MODE_CHUNK_ABORT = 0,
+    // The power-loss interrupt checkpoints the blocks the chunk finished
+    COMMIT_MODE_JIT = 1,
+    COMMIT_MODE_NUM = 2,
+} commitMode_e;
+
+#define AES_MINIMUM_CHUNK_SIZE (CIPHER_BLOCK_SIZE) // Size of data to be encrypted/decrypted (must be multiple of 16)
+
+// Chunk sizes are multiples of the workload's unit up to this. A chunk's
+// workload units still fit the 16-bit unit counts.
+#define CHUNK_SIZE_LIMIT (64UL * 1024UL)
+
+// Chunk stats are kept for each power of two multiple of the workload's unit,
+// up to CHUNK_SIZE_LIMIT for the smallest unit; a size counts towards the one
+// at or below it. Each keeps
+// the exact sizes and bytes of its chunks too.
+#define CHUNK_STATS_BUCKETS (13)
+
+typedef struct
+{
+    // Chunks of this size that committed
+    uint32_t commits;
+    // Chunks of this size that aborted
+    uint32_t aborts;
+    // Time spent in chunks of this size, aborted ones included
+    uint32_t totalMicroseconds;
+    // Bytes the chunks of this size set out to do
+    uint64_t attemptedBytes;
+    // Bytes they committed, what aborted ones salvaged included
+    uint64_t committedBytes;
+    // Smallest and largest of those chunks, in bytes
+    uint32_t smallestChunkSize;
+    uint32_t largestChunkSize;
+} checkpointingChunkStats_t;
+
+typedef struct
+{
+    // Power losses observed, saturating. The first has no interval before it.
+    uint16_t events;
+    // Bumped on every observation, so a reader can tell the ISR updated the
+    // estimate under it
+    uint16_t sequence;
+    // Uptime of the last power loss
+    uint32_t lastMicroseconds;
+    // EWMA of the time between power losses, in 1/16 us
+    uint32_t meanQ4;
+    // EWMA of the squared deviation of that time from its mean, in us^2
+    uint64_t variance;
+} checkpointingArrivals_t;
+
+typedef struct
+{
+    // Chunks run at this arm's size
+    uint32_t pulls;
+    // Mean reward of those chunks, bytes committed per microsecond of chunk
+    // and of the time to the next one (its commit and the dead-time, as
+    // waited out), in 1/4096
+    uint32_t meanQ12;
+    // Exploration bonus sqrt(2 ln n / pulls) in 1/4096, n being the chunks
+    // run by all arms when it was last worked out
+    uint32_t bonusQ12;
+} checkpointingBanditArm_t;
+
+typedef struct
+{
+    // Per chunk size outcomes, indexed by Checkpointing_GetChunkBucket().
+    // Unlike workloadFails and workloadSuccesses these are never reset during
+    // a run, so a policy can use them as the empirical success rate of each
+    // size.
+    checkpointingChunkStats_t chunks[CHUNK_STATS_BUCKETS];
+    // Bytes of work done by chunks that then aborted, less what was salvaged
+    uint64_t wastedBytes;
+    // Bytes aborted chunks finished before their power loss. Just-in-time
+    // commits keep them; in chunk-abort mode they are what it would have kept.
+    uint64_t salvageableBytes;
+    // Time in chunks that committed
+    uint32_t committedMicroseconds;
+    // Time in chunks that aborted
+    uint32_t abortedMicroseconds;
+    // Time in dead-time waits, restarts included
+    uint32_t deadTimeMicroseconds;
+    // Part of the dead-time thrown away when a power loss restarted it
+    uint32_t deadTimeRestartMicroseconds;
+    // Checkpoint commits, and the time they took
+    uint32_t checkpointCommits;
+    uint32_t checkpointMicroseconds;
+} checkpointingStats_t;
+
+// FRAM checkpoint store, see checkpoint.h
+struct checkpointStore;
+
+// What an instance runs its chunks and dead-times on, see
+// checkpointingPlatform_t
+struct checkpointingPlatform;
 
 typedef struct
 {
+    // Fields shared with the power-loss ISR, which is
+    // Checkpointing_SignalPowerLoss() by way of the PORT8 or Timer_B0 one.
+    // It writes powerLoss, powerLossCount, arrivals, chunkUnitsDone and
+    // salvageUnits, and reads currentlyWorking, all of them volatile. It also
+    // reads workload, commitMode, checkpoints and currentChunkSize, which
+    // the main loop only changes between chunks.
     // Power loss flag (raised by the GPIO interrupt)
-    bool powerLoss;
+    volatile bool powerLoss;
+    // Power losses signalled so far (counted by the GPIO interrupt, read it
+    // with Checkpointing_GetPowerLossCount())
+    volatile uint32_t powerLossCount;
+    // Power-loss inter-arrival estimate, updated as power losses are
+    // signalled. It outlives runs, it describes the supply.
+    volatile checkpointingArrivals_t arrivals;
     // Active work flag (raised while workload is busy doing work)
-    bool currentlyWorking;
-    // Starting chunk scale
-    chunkScale_e startingChunkScale;
-    // Current chunk scale
-    chunkScale_e currentChunkScale;
+    volatile bool currentlyWorking;
+    // Starting chunk size in bytes
+    uint32_t startingChunkSize;
+    // Size of the next chunk in bytes
+    uint32_t currentChunkSize;
+    // Bounds the policies keep the chunk size within, in bytes
+    uint32_t minChunkSize;
+    uint32_t maxChunkSize;
     // Total bytes processed by the workload
     uint64_t bytesProcessed;
     // Deadtime between workloads (simulates data transfer or other work)
@@ -72,22 +182,118 @@ typedef struct
     uint16_t failThresh;
     // Workload scaling policy
     workloadScalingPolicy_e policy;
+    // AIMD policy: workload units a success adds to the chunk size, and the
+    // share of it a failure keeps (percent)
+    uint16_t aimdIncreaseUnits;
+    uint8_t aimdDecreasePercent;
+    // Predictive policy: confidence margin on the predicted on-window, in
+    // percent of the standard deviation of the time between power losses
+    uint16_t predictiveMarginPercent;
+    // Predictive policy: EWMA of the measured cost of a workload unit, in
+    // 1/256 us, and the standard deviation last worked out from arrivals
+    uint32_t unitCostQ8;
+    uint32_t arrivalDeviationMicroseconds;
+    uint16_t arrivalDeviationSequence;
+    // Bandit policy: arm k runs chunks of maxChunkSize >> k. The arm the last
+    // chunk ran, the chunks run by all arms, and the log2 of that the bonuses
+    // were last worked out for.
+    checkpointingBanditArm_t banditArms[CHUNK_STATS_BUCKETS];
+    uint8_t banditArm;
+    uint8_t banditEpoch;
+    uint32_t banditPulls;
+    // Bandit policy: a chunk is rewarded once the dead-time after it is over,
+    // as timed. Its arm, the bytes it committed, its time and when it ended.
+    uint8_t banditPendingArm;
+    uint32_t banditPendingBytes;
+    uint32_t banditPendingMicroseconds;
+    uint32_t banditPendingEndMicroseconds;
+    // What a power loss does to the chunk it interrupts
+    commitMode_e commitMode;
+    // Interval between goodput samples, 0 to take none
+    uint32_t sampleIntervalMicroseconds;
     // Workload fail count
     uint16_t workloadFails;
     // Workload pass count
     uint16_t workloadSuccesses;
-    // Workload passes
+    // Random number generator state for the random policies
+    uint32_t randomState;
+    // Time the last chunk ran for, up to its end or abort
+    uint32_t chunkMicroseconds;
+    // Uptime when the last chunk ended
+    uint32_t chunkEndMicroseconds;
+    // Bytes of work the last chunk ran before it ended or aborted
+    uint32_t chunkBytesRun;
+    // Workload units the current chunk has finished
+    volatile uint16_t chunkUnitsDone;
+    // chunkUnitsDone as the power-loss interrupt found it, the units an
+    // interrupted chunk can salvage
+    volatile uint16_t salvageUnits;
+    // Accounting of the current run
+    checkpointingStats_t stats;
+    // Where committed chunks are checkpointed, or NULL for nowhere
+    struct checkpointStore *checkpoints;
+    // Set if the next run carries on from a restored checkpoint
+    bool resumeRun;
+    // The workload run in chunks, see workloadTable
+    workloadType_e workload;
+    // Its state, up to the last committed chunk
+    workloadState_t workloadState;
+    // The clock and the work behind Checkpointing_DoChunk() and
+    // Checkpointing_WaitDeadTime()
+    const struct checkpointingPlatform *platform;
 } checkpointingObj_t;
 
-extern volatile checkpointingObj_t checkpointingObj;
+// The clock and the work a fixture instance's chunks and dead-times run on:
+// the board's (Checkpointing_Init()), or a simulation's in virtual time
+// (host/host_sim.c). The chunk and dead-time steps themselves are the same
+// on both.
+typedef struct checkpointingPlatform
+{
+    // Uptime in microseconds
+    uint32_t (*getMicroseconds)(const checkpointingObj_t *ctx);
+    // Show whether a chunk is in flight, or NULL for nothing to show
+    void (*markWork)(bool working);
+    // Run a chunk's units on a copy of the workload state, up to the end of
+    // the chunk or of the unit a power loss lands in. Leaves the units it
+    // finished in chunkUnitsDone, and returns the bytes it ran, the unit cut
+    // short included.
+    uint32_t (*runChunk)(checkpointingObj_t *ctx, workloadState_t *state, uint32_t chunkSize);
+    // Wait until an uptime or a power loss, whichever comes first, or NULL
+    // to poll the clock
+    void (*waitUntil)(checkpointingObj_t *ctx, uint32_t microseconds);
+    // Checkpoint the committed progress, false if there is nowhere to
+    bool (*commit)(checkpointingObj_t *ctx);
+    // The simulation, for a simulated platform
+    void *context;
+} checkpointingPlatform_t;
+
+// The fixture instance driven by the console menus and the PORT8 ISR
+extern checkpointingObj_t checkpointingObj;
 
-void Checkpointing_Init(void);
+void Checkpointing_Init(checkpointingObj_t *ctx);
+void Checkpointing_AttachStore(checkpointingObj_t *ctx, struct checkpointStore *store);
+void Checkpointing_Seed(checkpointingObj_t *ctx, uint32_t seed);
+uint16_t Checkpointing_Random(checkpointingObj_t *ctx);
 functionResult_e PowerLossEmu_Setup(unsigned int numArgs, int args[]);
 functionResult_e Checkpointing_CurrentSettings(unsigned int numArgs, int args[]);
+void Checkpointing_PrintSettings(const checkpointingObj_t *ctx);
+void Checkpointing_ResetStats(checkpointingObj_t *ctx);
+void Checkpointing_ResetBandit(checkpointingObj_t *ctx);
+void Checkpointing_RestoreBandit(checkpointingObj_t *ctx);
+void Checkpointing_PrintStats(const checkpointingObj_t *ctx, uint32_t runMicroseconds);
+void Checkpointing_PrintChunkStats(const checkpointingObj_t *ctx);
 functionResult_e Checkpointing_WorkloadLoop(unsigned int numArgs, int args[]);
-void Checkpointing_MarkWorkEnd(void);
-void Checkpointing_MarkWorkStart(void);
-void Checkpointing_DoAes(void);
-void Checkpointing_ExecutePolicy(void);
+void Checkpointing_MarkWorkEnd(checkpointingObj_t *ctx);
+void Checkpointing_MarkWorkStart(checkpointingObj_t *ctx);
+void Checkpointing_SignalPowerLoss(checkpointingObj_t *ctx);
+void Checkpointing_ObservePowerLoss(checkpointingObj_t *ctx, uint32_t timestampMicroseconds);
+uint32_t Checkpointing_GetPowerLossCount(const checkpointingObj_t *ctx);
+void Checkpointing_DoChunk(checkpointingObj_t *ctx);
+void Checkpointing_WaitDeadTime(checkpointingObj_t *ctx);
+void Checkpointing_ExecutePolicy(checkpointingObj_t *ctx);
+void Checkpointing_SetChunkBounds(checkpointingObj_t *ctx, uint32_t startingChunkSize, uint32_t minChunkSize,
+                                  uint32_t maxChunkSize);
+void Checkpointing_SetChunkSize(checkpointingObj_t *ctx, uint32_t chunkSize);
+unsigned int Checkpointing_GetChunkBucket(uint32_t chunkSize, uint16_t unitSize);
 
 #endif // CHECKPOINTING_TEST_FIXTURE_H
@@ -0,0 +1,836 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Streaming AES engine for the workload. Blocks are encrypted in order from a
+ * plaintext stream to a ciphertext region in FRAM, in ECB, CBC or CTR mode
+ * with the key Cipher_SetKey() loaded. The plaintext is either generated from the
+ * stream position or read from a region in FRAM, so a block costs real
+ * memory traffic on top of the AES engine.
+ *
+ * A stream's state is its position and its chaining block. A chunk works on
+ * a copy and the committed stream is moved past the chunk's blocks with
+ * Cipher_Advance() once they are committed, so an aborted chunk leaves it
+ * where it was.
+ *
+ * The blocking engine runs each block through AES256_encryptBlocks() and
+ * waits for it. In ECB, where no block depends on the last, it runs the
+ * chunk's blocks in runs instead, one AES256_encryptBlocks() call each, so
+ * the key is set up and the call paid for once per run (Cipher_WaitChunk()).
+ * A run stops at the end of the FRAM regions and at CIPHER_RUN_MAX_BLOCKS,
+ * and a power loss is noticed between runs (Cipher_AbortChunk()).
+ *
+ * The pipelined engine keeps the AES module busy with the next block while
+ * the CPU stores the last one and fetches the plaintext of the one after it;
+ * the module's ready interrupt tells it when a block is out. A chunk is
+ * bracketed by Cipher_BeginChunk() and Cipher_EndChunk() so the pipeline can
+ * be filled and drained.
+ *
+ * The DMA engine hands a whole chunk to two DMA channels triggered by the AES
+ * module's cipher mode support, one feeding it plaintext from the FRAM source
+ * region and one taking the ciphertext out to the destination region, while
+ * the CPU sleeps in LPM0 (Cipher_WaitChunk()). A power loss stops both
+ * channels (Cipher_AbortChunk()). ECB and CBC run this way; CTR has no cipher
+ * mode on the module and runs on the pipelined engine.
+ */
+
+#include <string.h>
+#include "driverlib.h"
+#include "cipher.h"
+
+// Words per block
+#define CIPHER_BLOCK_WORDS          (CIPHER_BLOCK_SIZE / sizeof(uint32_t))
+// DMA transfers (16-bit) per block, and the most blocks AESBLKCNT takes
+#define CIPHER_DMA_BLOCK_TRANSFERS  (CIPHER_BLOCK_SIZE / sizeof(uint16_t))
+#define CIPHER_DMA_MAX_BLOCKS       (255)
+// DMA channels of the DMA engine and the AES triggers they answer to (see the
+// MSP430FR5994 datasheet's DMA trigger assignments). The output channel has
+// the higher priority.
+#define CIPHER_DMA_OUTPUT_CHANNEL   (DMA_CHANNEL_0)
+#define CIPHER_DMA_OUTPUT_TRIGGER   (DMA_TRIGGERSOURCE_11)
+#define CIPHER_DMA_INPUT_CHANNEL    (DMA_CHANNEL_1)
+#define CIPHER_DMA_INPUT_TRIGGER    (DMA_TRIGGERSOURCE_12)
+
+// Most blocks in one blocking engine run, how late a power loss can be
+// noticed
+#define CIPHER_RUN_MAX_BLOCKS       (16)
+
+// CBC IV. In CTR the first half is the nonce and the second half the block
+// counter, big-endian.
+static const uint8_t cipherIv[CIPHER_BLOCK_SIZE] =
+{
+    0x0F, 0x1E, 0x2D, 0x3C,
+    0x4B, 0x5A, 0x69, 0x78,
+    0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00,
+};
+
+// Both regions are word aligned so blocks move to and from the AES module as
+// 16-bit words
+#pragma PERSISTENT(cipherSourceRegion)
+#pragma DATA_ALIGN(cipherSourceRegion, 2)
+static uint8_t cipherSourceRegion[CIPHER_REGION_SIZE] = {0};
+
+#pragma PERSISTENT(cipherDestination)
+#pragma DATA_ALIGN(cipherDestination, 2)
+uint8_t cipherDestination[CIPHER_REGION_SIZE] = {0};
+
+// Pipelined engine state: the input of the next block to start, where the
+// block after it comes from, and the blocks of the chunk left to start
+static uint8_t cipherNextInput[CIPHER_BLOCK_SIZE];
+static uint64_t cipherNextOffset;
+static uint8_t cipherNextCounter[CIPHER_BLOCK_SIZE];
+static uint16_t cipherBlocksToStart;
+static bool cipherInFlight;
+// Set by the AES ready interrupt
+static volatile bool cipherReady;
+
+// DMA engine state: where the running segment starts, blocks left to hand to
+// the DMA after it, blocks in it and blocks finished before it, and the AES
+// register the input channel writes
+static uint64_t cipherDmaOffset;
+static uint16_t cipherDmaBlocksLeft;
+static uint16_t cipherDmaSegmentBlocks;
+static uint16_t cipherDmaBlocksDone;
+static uint16_t cipherDmaInputRegister;
+// Between Cipher_BeginChunk() and Cipher_EndChunk(), while the DMA runs,
+// and once a power loss stopped it
+static bool cipherDmaActive;
+static volatile bool cipherDmaRunning;
+static volatile bool cipherDmaAborted;
+
+// Blocking engine runs: blocks of the chunk left to run and blocks finished,
+// between Cipher_BeginChunk() and Cipher_EndChunk(), and once a power loss
+// stopped them. Pattern plaintext is generated a run at a time.
+static uint16_t cipherRunBlocksLeft;
+static volatile uint16_t cipherRunBlocksDone;
+static bool cipherRunActive;
+static volatile bool cipherRunStopped;
+static uint16_t cipherRunInput[CIPHER_RUN_MAX_BLOCKS * CIPHER_BLOCK_SIZE / sizeof(uint16_t)];
+
+// The key loaded into the AES module, reloaded after a reset
+static const uint8_t *cipherKey;
+
+/**
+ * @brief      Generate the pattern plaintext of the block at a stream position
+ */
+static void Cipher_GeneratePlaintext(uint64_t offset, uint8_t *block)
+{
+    uint32_t word = (uint32_t)(offset / sizeof(uint32_t));
+    uint32_t value;
+    unsigned int i;
+
+    for (i = 0; i < CIPHER_BLOCK_WORDS; i++)
+    {
+        // Knuth's multiplicative hash of the word index
+        value = (word + i) * 2654435761UL;
+        memcpy(&block[i * sizeof(uint32_t)], &value, sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief      Add to the counter half of a CTR counter block
+ */
+static void Cipher_AddCounter(uint8_t *counter, uint32_t blocks)
+{
+    uint32_t carry = blocks;
+    int i;
+
+    for (i = CIPHER_BLOCK_SIZE - 1; (i >= (CIPHER_BLOCK_SIZE / 2)) && (carry != 0); i--)
+    {
+        carry += counter[i];
+        counter[i] = (uint8_t)carry;
+        carry >>= 8;
+    }
+}
+
+/**
+ * @brief      Get the plaintext of the block at a stream position
+ *
+ * @param[in]  source  Where the plaintext comes from
+ * @param[in]  offset  The stream position
+ * @param      block   Scratch block the pattern is generated into
+ *
+ * @return     The plaintext, in FRAM or in the scratch block
+ */
+static const uint8_t *Cipher_FetchPlaintext(cipherSource_e source, uint64_t offset, uint8_t *block)
+{
+    if (source == CIPHER_SOURCE_FRAM)
+    {
+        return &cipherSourceRegion[(uint16_t)(offset % CIPHER_REGION_SIZE)];
+    }
+
+    Cipher_GeneratePlaintext(offset, block);
+
+    return block;
+}
+
+/**
+ * @brief      Prepare the input of the next block to start: its plaintext, or
+ *             its counter block in CTR. CBC chains it in when it starts.
+ */
+static void Cipher_StageBlock(const cipherStream_t *stream)
+{
+    if (stream->mode == CIPHER_MODE_CTR)
+    {
+        memcpy(cipherNextInput, cipherNextCounter, CIPHER_BLOCK_SIZE);
+        Cipher_AddCounter(cipherNextCounter, 1);
+    }
+    else if (stream->source == CIPHER_SOURCE_FRAM)
+    {
+        memcpy(cipherNextInput, &cipherSourceRegion[(uint16_t)(cipherNextOffset % CIPHER_REGION_SIZE)],
+               CIPHER_BLOCK_SIZE);
+    }
+    else
+    {
+        Cipher_GeneratePlaintext(cipherNextOffset, cipherNextInput);
+    }
+    cipherNextOffset += CIPHER_BLOCK_SIZE;
+}
+
+/**
+ * @brief      Start the staged block on the AES module
+ */
+static void Cipher_StartBlock(const cipherStream_t *stream)
+{
+    unsigned int i;
+
+    if (stream->mode == CIPHER_MODE_CBC)
+    {
+        // Chain the plaintext with the block that just came out
+        for (i = 0; i < CIPHER_BLOCK_SIZE; i++)
+        {
+            cipherNextInput[i] ^= stream->chain[i];
+        }
+    }
+    cipherReady = false;
+    AES256_startEncryptData(AES256_BASE, cipherNextInput);
+    cipherInFlight = true;
+    cipherBlocksToStart--;
+}
+
+/**
+ * @brief      Wait for the block on the AES module to come out
+ */
+static void Cipher_WaitReady(void)
+{
+    while (!cipherReady)
+    {
+        __no_operation();
+    }
+    cipherInFlight = false;
+}
+
+/**
+ * @brief      Load the 256-bit key every stream encrypts with into the AES
+ *             module
+ *
+ * @param[in]  key   The 32 byte key, kept for reloading
+ */
+void Cipher_SetKey(const uint8_t *key)
+{
+    cipherKey = key;
+    AES256_setCipherKey(AES256_BASE, key, AES256_KEYLENGTH_256BIT);
+}
+
+/**
+ * @brief      Set up a stream at its start
+ *
+ * @param      stream  The stream
+ * @param[in]  mode    Block chaining mode
+ * @param[in]  source  Where the plaintext comes from
+ * @param[in]  engine  How blocks are driven through the AES module. The DMA
+ *                     engine reads the FRAM source region whatever the source.
+ */
+void Cipher_Init(cipherStream_t *stream, cipherMode_e mode, cipherSource_e source, cipherEngine_e engine)
+{
+    stream->mode = mode;
+    stream->source = (engine == CIPHER_ENGINE_DMA) ? CIPHER_SOURCE_FRAM : source;
+    stream->engine = engine;
+    Cipher_Rewind(stream);
+}
+
+/**
+ * @brief      Move a stream back to its start. Refills the FRAM source region
+ *             when the stream reads from it.
+ *
+ * @param      stream  The stream
+ */
+void Cipher_Rewind(cipherStream_t *stream)
+{
+    uint16_t i;
+
+    stream->offset = 0;
+    memcpy(stream->chain, cipherIv, sizeof(stream->chain));
+
+    if (stream->source == CIPHER_SOURCE_FRAM)
+    {
+        for (i = 0; i < CIPHER_REGION_SIZE; i += CIPHER_BLOCK_SIZE)
+        {
+            Cipher_GeneratePlaintext(i, &cipherSourceRegion[i]);
+        }
+    }
+}
+
+/**
+ * @brief      Check whether a stream's chunks are run by the DMA. CTR has no
+ *             cipher mode on the AES module, so it stays pipelined.
+ *
+ * @param[in]  stream  The stream
+ */
+bool Cipher_UsesDma(const cipherStream_t *stream)
+{
+    return (stream->engine == CIPHER_ENGINE_DMA) && (stream->mode != CIPHER_MODE_CTR);
+}
+
+/**
+ * @brief      Check whether a stream's chunks are run by the blocking engine
+ *             in runs of blocks, which ECB allows
+ */
+static bool Cipher_UsesRuns(const cipherStream_t *stream)
+{
+    return (stream->engine == CIPHER_ENGINE_BLOCKING) && (stream->mode == CIPHER_MODE_ECB);
+}
+
+/**
+ * @brief      Check whether a stream's chunks are run as a whole by
+ *             Cipher_WaitChunk(), on the DMA or in runs of blocks, rather
+ *             than a block at a time by Cipher_EncryptBlock()
+ *
+ * @param[in]  stream  The stream
+ */
+bool Cipher_RunsWholeChunks(const cipherStream_t *stream)
+{
+    return Cipher_UsesDma(stream) || Cipher_UsesRuns(stream);
+}
+
+static bool Cipher_UsesPipeline(const cipherStream_t *stream)
+{
+    return (stream->engine == CIPHER_ENGINE_PIPELINED) ||
+           ((stream->engine == CIPHER_ENGINE_DMA) && (stream->mode == CIPHER_MODE_CTR));
+}
+
+/**
+ * @brief      Encrypt the next block of a stream with AES256_encryptBlocks()
+ */
+static void Cipher_EncryptBlockBlocking(cipherStream_t *stream)
+{
+    uint16_t *out = (uint16_t *)&cipherDestination[(uint16_t)(stream->offset % CIPHER_REGION_SIZE)];
+    // Word aligned for the AES module's 16-bit data registers
+    uint16_t block[CIPHER_BLOCK_SIZE / sizeof(uint16_t)];
+    const uint8_t *plaintext;
+    unsigned int i;
+
+    plaintext = Cipher_FetchPlaintext(stream->source, stream->offset, (uint8_t *)block);
+
+    switch (stream->mode)
+    {
+        case CIPHER_MODE_CBC:
+        {
+            // Chain the plaintext with the last ciphertext block
+            for (i = 0; i < CIPHER_BLOCK_SIZE; i++)
+            {
+                ((uint8_t *)block)[i] = plaintext[i] ^ stream->chain[i];
+            }
+            AES256_encryptBlocks(AES256_BASE, block, out, 1);
+            memcpy(stream->chain, out, CIPHER_BLOCK_SIZE);
+            break;
+        }
+        case CIPHER_MODE_CTR:
+        {
+            // Key stream from the counter block, XORed into the plaintext
+            uint16_t counter[CIPHER_BLOCK_SIZE / sizeof(uint16_t)];
+
+            memcpy(counter, stream->chain, CIPHER_BLOCK_SIZE);
+            AES256_encryptBlocks(AES256_BASE, counter, out, 1);
+            for (i = 0; i < CIPHER_BLOCK_SIZE; i++)
+            {
+                ((uint8_t *)out)[i] ^= plaintext[i];
+            }
+            Cipher_AddCounter(stream->chain, 1);
+            break;
+        }
+        case CIPHER_MODE_ECB:
+        default:
+        {
+            // Straight from the FRAM source, or from the generated block
+            AES256_encryptBlocks(AES256_BASE, (const uint16_t *)plaintext, out, 1);
+            break;
+        }
+    }
+
+    stream->offset += CIPHER_BLOCK_SIZE;
+}
+
+/**
+ * @brief      Hand the DMA the next run of blocks that doesn't wrap around
+ *             the FRAM regions
+ */
+static void Cipher_StartDmaSegment(void)
+{
+    uint16_t position = (uint16_t)(cipherDmaOffset % CIPHER_REGION_SIZE);
+    uint16_t blocks = (CIPHER_REGION_SIZE - position) / CIPHER_BLOCK_SIZE;
+
+    if (blocks > cipherDmaBlocksLeft)
+    {
+        blocks = cipherDmaBlocksLeft;
+    }
+    if (blocks > CIPHER_DMA_MAX_BLOCKS)
+    {
+        blocks = CIPHER_DMA_MAX_BLOCKS;
+    }
+    cipherDmaSegmentBlocks = blocks;
+    cipherDmaBlocksLeft -= blocks;
+
+    // Ciphertext out of AESADOUT into the destination region
+    DMA_setTransferSize(CIPHER_DMA_OUTPUT_CHANNEL, blocks * CIPHER_DMA_BLOCK_TRANSFERS);
+    DMA_setSrcAddress(CIPHER_DMA_OUTPUT_CHANNEL, AES256_BASE + OFS_AESADOUT, DMA_DIRECTION_UNCHANGED);
+    DMA_setDstAddress(CIPHER_DMA_OUTPUT_CHANNEL, (uint32_t)(uintptr_t)&cipherDestination[position],
+                      DMA_DIRECTION_INCREMENT);
+    // Plaintext from the source region into the module
+    DMA_setTransferSize(CIPHER_DMA_INPUT_CHANNEL, blocks * CIPHER_DMA_BLOCK_TRANSFERS);
+    DMA_setSrcAddress(CIPHER_DMA_INPUT_CHANNEL, (uint32_t)(uintptr_t)&cipherSourceRegion[position],
+                      DMA_DIRECTION_INCREMENT);
+    DMA_setDstAddress(CIPHER_DMA_INPUT_CHANNEL, AES256_BASE + cipherDmaInputRegister, DMA_DIRECTION_UNCHANGED);
+    DMA_enableTransfers(CIPHER_DMA_OUTPUT_CHANNEL);
+    DMA_enableTransfers(CIPHER_DMA_INPUT_CHANNEL);
+
+    // The block count starts the module's DMA triggers. driverlib has no call
+    // for the cipher mode registers.
+    HWREG16(AES256_BASE + OFS_AESACTL1) = blocks;
+}
+
+/**
+ * @brief      Fold the running DMA segment into the finished blocks, counting
+ *             only blocks whose ciphertext is all out
+ */
+static void Cipher_CountDmaSegment(void)
+{
+    uint16_t transfers = cipherDmaSegmentBlocks * CIPHER_DMA_BLOCK_TRANSFERS;
+
+    if (DMA_getInterruptStatus(CIPHER_DMA_OUTPUT_CHANNEL) != 0)
+    {
+        DMA_clearInterrupt(CIPHER_DMA_OUTPUT_CHANNEL);
+    }
+    else
+    {
+        transfers -= DMA_getTransferSize(CIPHER_DMA_OUTPUT_CHANNEL);
+    }
+    cipherDmaBlocksDone += transfers / CIPHER_DMA_BLOCK_TRANSFERS;
+    cipherDmaOffset += (uint64_t)cipherDmaSegmentBlocks * CIPHER_BLOCK_SIZE;
+    cipherDmaSegmentBlocks = 0;
+}
+
+/**
+ * @brief      Start a chunk of blocks on a stream. With the pipelined engine,
+ *             the first block goes to the AES module; with the DMA engine,
+ *             the whole chunk is handed to the DMA.
+ *
+ * @param      stream  The stream
+ * @param[in]  blocks  Blocks the chunk encrypts, at most
+ */
+void Cipher_BeginChunk(cipherStream_t *stream, uint16_t blocks)
+{
+    DMA_initParam dmaParam = {0};
+    cipherStream_t first;
+
+    if (blocks == 0)
+    {
+        return;
+    }
+
+    if (Cipher_UsesPipeline(stream))
+    {
+        cipherNextOffset = stream->offset;
+        memcpy(cipherNextCounter, stream->chain, CIPHER_BLOCK_SIZE);
+        cipherBlocksToStart = blocks;
+        AES256_clearInterrupt(AES256_BASE);
+        AES256_enableInterrupt(AES256_BASE);
+        Cipher_StageBlock(stream);
+        Cipher_StartBlock(stream);
+        if (cipherBlocksToStart != 0)
+        {
+            Cipher_StageBlock(stream);
+        }
+        return;
+    }
+
+    if (Cipher_UsesRuns(stream))
+    {
+        cipherRunBlocksLeft = blocks;
+        cipherRunBlocksDone = 0;
+        cipherRunStopped = false;
+        cipherRunActive = true;
+        return;
+    }
+
+    if (!Cipher_UsesDma(stream))
+    {
+        return;
+    }
+
+    cipherDmaActive = true;
+    cipherDmaAborted = false;
+    cipherDmaOffset = stream->offset;
+    cipherDmaBlocksLeft = blocks;
+    cipherDmaBlocksDone = 0;
+    cipherDmaInputRegister = OFS_AESADIN;
+    if (stream->mode == CIPHER_MODE_CBC)
+    {
+        // In CBC the module chains each block onto its last output. The
+        // first block goes through the CPU with the stream's chaining block,
+        // which leaves the module holding it for the DMA's blocks.
+        first = *stream;
+        Cipher_EncryptBlockBlocking(&first);
+        cipherDmaOffset += CIPHER_BLOCK_SIZE;
+        cipherDmaBlocksLeft--;
+        cipherDmaBlocksDone++;
+        cipherDmaInputRegister = OFS_AESAXDIN;
+    }
+    if (cipherDmaBlocksLeft == 0)
+    {
+        return;
+    }
+
+    dmaParam.transferModeSelect = DMA_TRANSFER_SINGLE;
+    dmaParam.transferUnitSelect = DMA_SIZE_SRCWORD_DSTWORD;
+    dmaParam.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+    dmaParam.channelSelect = CIPHER_DMA_OUTPUT_CHANNEL;
+    dmaParam.triggerSourceSelect = CIPHER_DMA_OUTPUT_TRIGGER;
+    DMA_init(&dmaParam);
+    dmaParam.channelSelect = CIPHER_DMA_INPUT_CHANNEL;
+    dmaParam.triggerSourceSelect = CIPHER_DMA_INPUT_TRIGGER;
+    DMA_init(&dmaParam);
+    DMA_clearInterrupt(CIPHER_DMA_OUTPUT_CHANNEL);
+    DMA_enableInterrupt(CIPHER_DMA_OUTPUT_CHANNEL);
+
+    // Encryption, with the module's cipher mode support for the DMA
+    HWREG16(AES256_BASE + OFS_AESACTL0) =
+        (HWREG16(AES256_BASE + OFS_AESACTL0) & ~(AESOP_3 | AESCM0 | AESCM1)) |
+        AESCMEN | ((stream->mode == CIPHER_MODE_CBC) ? AESCM0 : 0);
+    cipherDmaRunning = true;
+    Cipher_StartDmaSegment();
+}
+
+/**
+ * @brief      Run a blocking engine chunk in runs of blocks, until it is done
+ *             or a power loss stops it. The stream is moved past the blocks
+ *             run.
+ *
+ * @param      stream  The stream
+ *
+ * @return     Blocks finished
+ */
+static uint16_t Cipher_RunChunk(cipherStream_t *stream)
+{
+    uint16_t position;
+    uint16_t blocks;
+    const uint16_t *in;
+    uint16_t i;
+
+    while ((cipherRunBlocksLeft != 0) && !cipherRunStopped)
+    {
+        position = (uint16_t)(stream->offset % CIPHER_REGION_SIZE);
+        blocks = (CIPHER_REGION_SIZE - position) / CIPHER_BLOCK_SIZE;
+        if (blocks > cipherRunBlocksLeft)
+        {
+            blocks = cipherRunBlocksLeft;
+        }
+        if (blocks > CIPHER_RUN_MAX_BLOCKS)
+        {
+            blocks = CIPHER_RUN_MAX_BLOCKS;
+        }
+
+        if (stream->source == CIPHER_SOURCE_FRAM)
+        {
+            in = (const uint16_t *)&cipherSourceRegion[position];
+        }
+        else
+        {
+            for (i = 0; i < blocks; i++)
+            {
+                Cipher_GeneratePlaintext(stream->offset + ((uint64_t)i * CIPHER_BLOCK_SIZE),
+                                         (uint8_t *)&cipherRunInput[i * CIPHER_DMA_BLOCK_TRANSFERS]);
+            }
+            in = cipherRunInput;
+        }
+        AES256_encryptBlocks(AES256_BASE, in, (uint16_t *)&cipherDestination[position], blocks);
+
+        stream->offset += (uint64_t)blocks * CIPHER_BLOCK_SIZE;
+        cipherRunBlocksLeft -= blocks;
+        cipherRunBlocksDone += blocks;
+    }
+
+    return cipherRunBlocksDone;
+}
+
+/**
+ * @brief      Run a chunk as a whole: sleep in LPM0 while the DMA runs it, or
+ *             run it on the CPU in runs of blocks, until it is done or a
+ *             power loss stops it. The stream is moved past the blocks
+ *             finished.
+ *
+ * @param      stream  The stream
+ *
+ * @return     Blocks finished
+ */
+uint16_t Cipher_WaitChunk(cipherStream_t *stream)
+{
+    uint16_t blocks;
+
+    if (Cipher_UsesRuns(stream))
+    {
+        return Cipher_RunChunk(stream);
+    }
+
+    __disable_interrupt();
+    while (cipherDmaRunning)
+    {
+        // Interrupts come back on with the sleep, so a wake-up can't slip in
+        // between the check and the sleep
+        __bis_SR_register(LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    blocks = cipherDmaBlocksDone;
+    __enable_interrupt();
+
+    Cipher_Advance(stream, blocks);
+
+    return blocks;
+}
+
+/**
+ * @brief      Stop a chunk run as a whole, from the power-loss interrupt. A
+ *             blocking engine run under way is left to finish.
+ *
+ * @param[out] blocksDone  Blocks of the chunk finished
+ *
+ * @return     Whether a chunk run as a whole was under way
+ */
+bool Cipher_AbortChunk(uint16_t *blocksDone)
+{
+    if (cipherRunActive)
+    {
+        cipherRunStopped = true;
+        *blocksDone = cipherRunBlocksDone;
+        return true;
+    }
+
+    if (!cipherDmaActive)
+    {
+        return false;
+    }
+
+    if (cipherDmaRunning)
+    {
+        DMA_disableTransfers(CIPHER_DMA_INPUT_CHANNEL);
+        DMA_disableTransfers(CIPHER_DMA_OUTPUT_CHANNEL);
+        Cipher_CountDmaSegment();
+        cipherDmaBlocksLeft = 0;
+        cipherDmaRunning = false;
+        cipherDmaAborted = true;
+    }
+    *blocksDone = cipherDmaBlocksDone;
+
+    return true;
+}
+
+/**
+ * @brief      End a chunk, whether it ran all of its blocks or not. A block the
+ *             pipelined engine started for nothing is left to finish. An
+ *             aborted DMA chunk leaves the AES module midway through its block
+ *             count, maybe with part of a block written in, so the module is
+ *             reset and the key loaded again.
+ *
+ * @param      stream  The stream
+ */
+void Cipher_EndChunk(cipherStream_t *stream)
+{
+    if (Cipher_UsesPipeline(stream))
+    {
+        if (cipherInFlight)
+        {
+            Cipher_WaitReady();
+        }
+        AES256_disableInterrupt(AES256_BASE);
+        cipherBlocksToStart = 0;
+        return;
+    }
+
+    if (cipherRunActive)
+    {
+        cipherRunActive = false;
+        return;
+    }
+
+    if (!cipherDmaActive)
+    {
+        return;
+    }
+
+    DMA_disableInterrupt(CIPHER_DMA_OUTPUT_CHANNEL);
+    if (cipherDmaAborted)
+    {
+        // Keeps the key length and the direction, clears the rest
+        AES256_reset(AES256_BASE);
+        if (cipherKey != NULL)
+        {
+            AES256_setCipherKey(AES256_BASE, cipherKey, AES256_KEYLENGTH_256BIT);
+        }
+        cipherDmaAborted = false;
+    }
+    else
+    {
+        while (AES256_isBusy(AES256_BASE) != 0);
+    }
+    HWREG16(AES256_BASE + OFS_AESACTL0) &= ~(AESCMEN | AESCM0 | AESCM1);
+    cipherDmaActive = false;
+}
+
+/**
+ * @brief      Handle the AES module's ready interrupt
+ */
+void Cipher_ServiceReady(void)
+{
+    AES256_clearInterrupt(AES256_BASE);
+    cipherReady = true;
+}
+
+/**
+ * @brief      Handle the DMA interrupt: the output channel finished a segment
+ */
+void Cipher_ServiceDma(void)
+{
+    if (!cipherDmaRunning || (DMA_getInterruptStatus(CIPHER_DMA_OUTPUT_CHANNEL) == 0))
+    {
+        return;
+    }
+
+    Cipher_CountDmaSegment();
+    if (cipherDmaBlocksLeft != 0)
+    {
+        Cipher_StartDmaSegment();
+    }
+    else
+    {
+        cipherDmaRunning = false;
+    }
+}
+
+/**
+ * @brief      Finish the next block of a pipelined chunk: take it off the AES
+ *             module, start the one after it, then store it and stage the
+ *             next input while the module works
+ */
+static void Cipher_EncryptBlockPipelined(cipherStream_t *stream)
+{
+    uint8_t *out = &cipherDestination[(uint16_t)(stream->offset % CIPHER_REGION_SIZE)];
+    uint8_t block[CIPHER_BLOCK_SIZE];
+    const uint8_t *plaintext;
+    unsigned int i;
+
+    Cipher_WaitReady();
+    AES256_getDataOut(AES256_BASE, out);
+    if (stream->mode == CIPHER_MODE_CBC)
+    {
+        memcpy(stream->chain, out, CIPHER_BLOCK_SIZE);
+    }
+    if (cipherBlocksToStart != 0)
+    {
+        Cipher_StartBlock(stream);
+    }
+
+    // Overlapped with the block on the module
+    if (stream->mode == CIPHER_MODE_CTR)
+    {
+        plaintext = Cipher_FetchPlaintext(stream->source, stream->offset, block);
+        for (i = 0; i < CIPHER_BLOCK_SIZE; i++)
+        {
+            out[i] ^= plaintext[i];
+        }
+        Cipher_AddCounter(stream->chain, 1);
+    }
+    stream->offset += CIPHER_BLOCK_SIZE;
+    if (cipherBlocksToStart != 0)
+    {
+        Cipher_StageBlock(stream);
+    }
+}
+
+/**
+ * @brief      Encrypt the next block of a stream into the destination region.
+ *             Call between Cipher_BeginChunk() and Cipher_EndChunk(), for
+ *             streams whose chunks don't run on the DMA.
+ *
+ * @param      stream  The stream
+ */
+void Cipher_EncryptBlock(cipherStream_t *stream)
+{
+    if (Cipher_UsesPipeline(stream))
+    {
+        Cipher_EncryptBlockPipelined(stream);
+    }
+    else
+    {
+        Cipher_EncryptBlockBlocking(stream);
+    }
+}
+
+/**
+ * @brief      Move a stream past blocks a chunk encrypted from its position.
+ *             The blocks must still be in the destination region.
+ *
+ * @param      stream  The stream
+ * @param[in]  blocks  Number of blocks
+ */
+void Cipher_Advance(cipherStream_t *stream, uint32_t blocks)
+{
+    if (blocks == 0)
+    {
+        return;
+    }
+
+    stream->offset += (uint64_t)blocks * CIPHER_BLOCK_SIZE;
+    switch (stream->mode)
+    {
+        case CIPHER_MODE_CBC:
+        {
+            // The last of the blocks chains on
+            memcpy(stream->chain,
+                   &cipherDestination[(uint16_t)((stream->offset - CIPHER_BLOCK_SIZE) % CIPHER_REGION_SIZE)],
+                   CIPHER_BLOCK_SIZE);
+            break;
+        }
+        case CIPHER_MODE_CTR:
+        {
+            Cipher_AddCounter(stream->chain, blocks);
+            break;
+        }
+        case CIPHER_MODE_ECB:
+        default:
+        {
+            break;
+        }
+    }
+}
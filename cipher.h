@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef CIPHER_H
+#define CIPHER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CIPHER_BLOCK_SIZE           (16)
+// Size of the FRAM source and destination regions, the stream wraps around
+// them (multiple of CIPHER_BLOCK_SIZE)
+#define CIPHER_REGION_SIZE          (4096)
+
+typedef enum
+{
+    CIPHER_MODE_ECB = 0,
+    CIPHER_MODE_CBC = 1,
+    CIPHER_MODE_CTR = 2,
+    CIPHER_MODE_NUM = 3,
+} cipherMode_e;
+
+typedef enum
+{
+    // Plaintext generated from the stream position
+    CIPHER_SOURCE_PATTERN = 0,
+    // Plaintext read from a region in FRAM
+    CIPHER_SOURCE_FRAM = 1,
+    CIPHER_SOURCE_NUM = 2,
+} cipherSource_e;
+
+typedef enum
+{
+    // One block at a time, waiting on the AES module
+    CIPHER_ENGINE_BLOCKING = 0,
+    // Next block on the AES module while the CPU handles the last one
+    CIPHER_ENGINE_PIPELINED = 1,
+    // Whole chunks moved through the AES module by DMA, CPU in LPM0
+    CIPHER_ENGINE_DMA = 2,
+    CIPHER_ENGINE_NUM = 3,
+} cipherEngine_e;
+
+typedef struct
+{
+    // Block chaining mode
+    cipherMode_e mode;
+    // Where the plaintext comes from
+    cipherSource_e source;
+    // How blocks are driven through the AES module
+    cipherEngine_e engine;
+    // Stream position of the next block
+    uint64_t offset;
+    // State carried from block to block: the last ciphertext block (CBC,
+    // the IV at the start) or the next counter block (CTR)
+    uint8_t chain[CIPHER_BLOCK_SIZE];
+} cipherStream_t;
+
+// Where the ciphertext goes, at the stream position modulo its size
+extern uint8_t cipherDestination[CIPHER_REGION_SIZE];
+
+void Cipher_SetKey(const uint8_t *key);
+void Cipher_Init(cipherStream_t *stream, cipherMode_e mode, cipherSource_e source, cipherEngine_e engine);
+void Cipher_Rewind(cipherStream_t *stream);
+bool Cipher_UsesDma(const cipherStream_t *stream);
+bool Cipher_RunsWholeChunks(const cipherStream_t *stream);
+void Cipher_BeginChunk(cipherStream_t *stream, uint16_t blocks);
+void Cipher_EncryptBlock(cipherStream_t *stream);
+uint16_t Cipher_WaitChunk(cipherStream_t *stream);
+bool Cipher_AbortChunk(uint16_t *blocksDone);
+void Cipher_EndChunk(cipherStream_t *stream);
+void Cipher_ServiceReady(void);
+void Cipher_ServiceDma(void);
+void Cipher_Advance(cipherStream_t *stream, uint32_t blocks);
+
+#endif // CIPHER_H
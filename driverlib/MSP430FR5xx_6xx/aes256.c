@@ -128,6 +128,38 @@ void AES256_encryptData (uint16_t baseAddress,
 	}
 }
 
+void AES256_encryptBlocks (uint16_t baseAddress,
+	const uint16_t * data,
+	uint16_t * encryptedData,
+	uint16_t numberOfBlocks)
+{
+	uint8_t i;
+
+	// Set module to encrypt mode
+	HWREG16(baseAddress + OFS_AESACTL0) &= ~AESOP_3;
+
+	// Key that is already written shall be used for every block
+	HWREG16(baseAddress + OFS_AESASTAT) |= AESKEYWR;
+
+	while (numberOfBlocks-- > 0)
+	{
+		// Write data to encrypt to module, the last word starts encryption
+		for (i = 0; i < 8; i++)
+		{
+			HWREG16(baseAddress + OFS_AESADIN) = *data++;
+		}
+
+		// Wait unit finished ~167 MCLK
+		while(AESBUSY == (HWREG16(baseAddress + OFS_AESASTAT) & AESBUSY) );
+
+		// Write encrypted data back to variable
+		for (i = 0; i < 8; i++)
+		{
+			*encryptedData++ = HWREG16(baseAddress + OFS_AESADOUT);
+		}
+	}
+}
+
 void AES256_decryptData (uint16_t baseAddress,
 	const uint8_t * data,
 	uint8_t * decryptedData)
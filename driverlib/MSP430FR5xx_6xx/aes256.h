@@ -142,6 +142,30 @@ extern void AES256_encryptData(uint16_t baseAddress,
                                const uint8_t *data,
                                uint8_t *encryptedData);
 
+//*****************************************************************************
+//
+//! \brief Encrypts consecutive blocks of data using the AES256 module.
+//!
+//! The cipher key that is used for encryption should be loaded in advance by
+//! using function AES256_setCipherKey(); it stays loaded across the blocks.
+//! The data is moved to and from the module one 16-bit word at a time, so
+//! both buffers must be word aligned. Each block takes 167 MCLK.
+//!
+//! \param baseAddress is the base address of the AES256 module.
+//! \param data is a pointer to an uint16_t array with a length of 8 words per
+//!        block that contains data to be encrypted.
+//! \param encryptedData is a pointer to an uint16_t array with a length of 8
+//!        words per block in that the encrypted data will be written.
+//! \param numberOfBlocks is the number of 16 byte blocks to encrypt.
+//!
+//! \return None
+//
+//*****************************************************************************
+extern void AES256_encryptBlocks(uint16_t baseAddress,
+                                 const uint16_t *data,
+                                 uint16_t *encryptedData,
+                                 uint16_t numberOfBlocks);
+
 //*****************************************************************************
 //
 //! \brief Decrypts a block of data using the AES256 module.
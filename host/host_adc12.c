@@ -0,0 +1,210 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * ADC12_B model with a synthetic sensor on every input. Single-channel
+ * conversions only (CONSEQ 0 and 2) into the memory register CSTARTADD
+ * points at: setting ADC12SC with the module on and enabled starts one, and
+ * the repeat mode runs the next as each one finishes until ADC12ENC is
+ * cleared. Each conversion takes HOST_ADC12_CONVERSION_CYCLES of MCLK,
+ * whatever the clock and sample-and-hold settings. The result sets its
+ * ADC12IFGx, and ADC12OVIFG if the last one hadn't been read yet; reading
+ * ADC12MEMx clears the flag again, from the CPU or the DMA, which takes a set
+ * flag as its trigger. The module's interrupts are not modelled.
+ *
+ * The sensor is a slow triangle wave across most of the 12-bit range, with a
+ * little noise on top.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+#include "host_cpu.h"
+
+#define HOST_ADC12_SIZE                 (0xA0)
+#define HOST_ADC12_NUM_MEMORIES         (32)
+// 16 + 14 ADC12CLK cycles of a ~5 MHz MODOSC, ~160 ksps
+#define HOST_ADC12_CONVERSION_CYCLES    (100)
+// Synthetic sensor: triangle wave period (conversions), its swing about
+// mid-scale, and the noise amplitude (counts)
+#define HOST_ADC12_WAVE_PERIOD          (4096)
+#define HOST_ADC12_WAVE_SWING           (1536)
+#define HOST_ADC12_NOISE                (32)
+#define HOST_ADC12_MID_SCALE            (2048)
+
+static bool hostAdc12Converting;
+static uint64_t hostAdc12DoneCycles;
+static uint32_t hostAdc12Conversions;
+static uint32_t hostAdc12Noise = 1;
+
+static uint16_t HostAdc12_Reg(uint16_t offset)
+{
+    return HostRegs_Read16(ADC12_B_BASE + offset);
+}
+
+static uint8_t HostAdc12_Memory(void)
+{
+    return (uint8_t)(HostAdc12_Reg(OFS_ADC12CTL3) & ADC12CSTARTADD_31);
+}
+
+/**
+ * @brief      Get a reading of the synthetic sensor
+ *
+ * @param[in]  conversion  Conversions the sensor has been through
+ * @param      noise       The noise generator, moved on
+ */
+uint16_t HostAdc12_SensorReading(uint32_t conversion, uint32_t *noise)
+{
+    uint32_t phase = conversion % HOST_ADC12_WAVE_PERIOD;
+    int32_t wave;
+
+    // Triangle from -swing to +swing and back
+    wave = (phase < (HOST_ADC12_WAVE_PERIOD / 2)) ? (int32_t)phase : (int32_t)(HOST_ADC12_WAVE_PERIOD - phase);
+    wave = ((wave * 4 * HOST_ADC12_WAVE_SWING) / HOST_ADC12_WAVE_PERIOD) - HOST_ADC12_WAVE_SWING;
+
+    // Numerical Recipes LCG, its high bits as noise
+    *noise = (*noise * 1664525UL) + 1013904223UL;
+    wave += (int32_t)((*noise >> 16) % (2 * HOST_ADC12_NOISE + 1)) - HOST_ADC12_NOISE;
+
+    return (uint16_t)(HOST_ADC12_MID_SCALE + wave);
+}
+
+/**
+ * @brief      Get the next reading of the synthetic sensor
+ */
+static uint16_t HostAdc12_Sample(void)
+{
+    return HostAdc12_SensorReading(hostAdc12Conversions++, &hostAdc12Noise);
+}
+
+static void HostAdc12_SetBusy(bool busy)
+{
+    uint16_t ctl1 = HostAdc12_Reg(OFS_ADC12CTL1) & ~ADC12BUSY;
+
+    hostAdc12Converting = busy;
+    HostRegs_Write16(ADC12_B_BASE + OFS_ADC12CTL1, ctl1 | (busy ? ADC12BUSY : 0));
+    if (busy)
+    {
+        hostAdc12DoneCycles = HostCpu_GetCycles() + HOST_ADC12_CONVERSION_CYCLES;
+    }
+}
+
+static void HostAdc12_Service(void)
+{
+    uint8_t memory;
+    uint16_t flag;
+    uint16_t ifg;
+
+    if (!hostAdc12Converting || (HostCpu_GetCycles() < hostAdc12DoneCycles))
+    {
+        return;
+    }
+
+    memory = HostAdc12_Memory();
+    flag = (uint16_t)(1U << (memory % 16));
+    ifg = HostAdc12_Reg(OFS_ADC12IFGR0 + (memory / 16) * 2);
+    if ((ifg & flag) != 0)
+    {
+        HostRegs_Write16(ADC12_B_BASE + OFS_ADC12IFGR2, HostAdc12_Reg(OFS_ADC12IFGR2) | ADC12OVIFG);
+    }
+    HostRegs_Write16(ADC12_B_BASE + OFS_ADC12MEM0 + memory * 2, HostAdc12_Sample());
+    HostRegs_Write16(ADC12_B_BASE + OFS_ADC12IFGR0 + (memory / 16) * 2, ifg | flag);
+
+    // The repeat mode carries on for as long as the module is enabled
+    HostAdc12_SetBusy(((HostAdc12_Reg(OFS_ADC12CTL1) & ADC12CONSEQ_3) == ADC12CONSEQ_2) &&
+                      ((HostAdc12_Reg(OFS_ADC12CTL0) & (ADC12ON | ADC12ENC)) == (ADC12ON | ADC12ENC)));
+}
+
+static void HostAdc12_Read(uint16_t offset)
+{
+    uint8_t memory;
+
+    if ((offset < OFS_ADC12MEM0) || (offset >= (OFS_ADC12MEM0 + HOST_ADC12_NUM_MEMORIES * 2)))
+    {
+        return;
+    }
+
+    // Reading a result clears its flag
+    memory = (uint8_t)((offset - OFS_ADC12MEM0) / 2);
+    HostRegs_Write16(ADC12_B_BASE + OFS_ADC12IFGR0 + (memory / 16) * 2,
+                     HostAdc12_Reg(OFS_ADC12IFGR0 + (memory / 16) * 2) & ~(1U << (memory % 16)));
+}
+
+static void HostAdc12_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    if (offset != OFS_ADC12CTL0)
+    {
+        return;
+    }
+
+    if ((newValue & (ADC12ON | ADC12ENC)) != (ADC12ON | ADC12ENC))
+    {
+        // Disabling stops a repeated conversion, and the one under way
+        HostAdc12_SetBusy(false);
+    }
+    else if (((newValue & ADC12SC) != 0) && ((oldValue & ADC12SC) == 0))
+    {
+        // ADC12SC clears itself once the conversion starts
+        HostRegs_Write16(ADC12_B_BASE + OFS_ADC12CTL0, newValue & ~ADC12SC);
+        if (!hostAdc12Converting)
+        {
+            HostAdc12_SetBusy(true);
+        }
+    }
+}
+
+/**
+ * @brief      Check whether the ADC12 DMA trigger is raised: the result of
+ *             the conversion memory in use is waiting to be read
+ */
+bool HostAdc12_DmaTrigger(void)
+{
+    uint8_t memory = HostAdc12_Memory();
+    uint16_t offset = OFS_ADC12IFGR0 + (memory / 16) * 2;
+    uint16_t flag = (uint16_t)(1U << (memory % 16));
+
+    // A result already waiting is served first. Catching up on the
+    // conversions before would let a late service (the host, not the
+    // board, falling behind) run the next one over it.
+    if ((HostAdc12_Reg(offset) & flag) == 0)
+    {
+        HostAdc12_Service();
+    }
+
+    return (HostAdc12_Reg(offset) & flag) != 0;
+}
+
+const hostPeripheral_t hostAdc12 =
+{
+    "ADC12_B",
+    ADC12_B_BASE,
+    HOST_ADC12_SIZE,
+    NULL,
+    HostAdc12_Read,
+    HostAdc12_Write,
+    HostAdc12_Service,
+    NULL,
+};
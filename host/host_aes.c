@@ -0,0 +1,526 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * AES256 accelerator model backed by a byte-oriented software AES (FIPS-197).
+ *
+ * A block operation starts once all 8 words of AESADIN (or AESAXDIN) have been
+ * written and a key is loaded. The result is computed immediately but the
+ * module reads back AESBUSY until the modelled latency has elapsed, then sets
+ * AESRDYIFG and raises AES256_VECTOR if AESRDYIE is set. Writing data while the
+ * module is busy sets AESERRFG, as on the device.
+ *
+ * With AESCMEN set, writing a block count to AESACTL1 hands the data registers
+ * to the DMA: AES trigger 1 asks for the 8 input words of the next block and
+ * AES trigger 0 for the 8 output words of the last one, one block at a time.
+ * The chaining itself is left to the register the DMA writes (AESAXDIN for
+ * CBC).
+ */
+
+#include <string.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+#include "host_cpu.h"
+
+#define HOST_AES_SIZE           (0x10)
+#define HOST_AES_BLOCK_SIZE     (16)
+#define HOST_AES_MAX_ROUNDS     (14)
+// ~167 MCLK per block, as quoted for AES256_encryptData()
+#define HOST_AES_BLOCK_CYCLES   (167)
+#define HOST_AES_BLOCK_WORDS    (HOST_AES_BLOCK_SIZE / 2)
+#define HOST_AES_BLKCNT_MASK    (0x00FF)
+
+static const uint8_t hostAesSbox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+static uint8_t hostAesInvSbox[256];
+static uint8_t hostAesRoundKeys[(HOST_AES_MAX_ROUNDS + 1) * HOST_AES_BLOCK_SIZE];
+static uint8_t hostAesRounds;
+
+// Peripheral state
+static uint8_t hostAesKey[32];
+static uint8_t hostAesKeyCount;
+static uint8_t hostAesDataIn[HOST_AES_BLOCK_SIZE];
+static uint8_t hostAesDataInCount;
+static uint8_t hostAesDataOut[HOST_AES_BLOCK_SIZE];
+static uint8_t hostAesDataOutCount;
+static bool hostAesBusy;
+static uint64_t hostAesDoneCycles;
+// Cipher mode (DMA) state: blocks left to start, output words left to read
+static uint8_t hostAesBlocksLeft;
+static uint8_t hostAesOutputWords;
+
+static uint8_t HostAes_Xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ (((x >> 7) & 1) * 0x1b));
+}
+
+static uint8_t HostAes_Multiply(uint8_t x, uint8_t y)
+{
+    uint8_t result = 0;
+
+    while (y != 0)
+    {
+        if ((y & 1) != 0)
+        {
+            result ^= x;
+        }
+        x = HostAes_Xtime(x);
+        y >>= 1;
+    }
+
+    return result;
+}
+
+/**
+ * @brief      Expand a 128, 192 or 256-bit key into the round key schedule
+ */
+void HostAes_ExpandKey(const uint8_t *key, uint8_t keyLengthBytes)
+{
+    uint8_t words = keyLengthBytes / 4;
+    uint8_t totalWords;
+    uint8_t rcon = 0x01;
+    uint8_t temp[4];
+    uint8_t t;
+    unsigned int i;
+
+    if (hostAesInvSbox[hostAesSbox[1]] != 1)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            hostAesInvSbox[hostAesSbox[i]] = (uint8_t)i;
+        }
+    }
+
+    hostAesRounds = words + 6;
+    totalWords = 4 * (hostAesRounds + 1);
+    memcpy(hostAesRoundKeys, key, keyLengthBytes);
+
+    for (i = words; i < totalWords; i++)
+    {
+        memcpy(temp, &hostAesRoundKeys[(i - 1) * 4], 4);
+        if ((i % words) == 0)
+        {
+            // RotWord, SubWord, Rcon
+            t = temp[0];
+            temp[0] = hostAesSbox[temp[1]] ^ rcon;
+            temp[1] = hostAesSbox[temp[2]];
+            temp[2] = hostAesSbox[temp[3]];
+            temp[3] = hostAesSbox[t];
+            rcon = HostAes_Xtime(rcon);
+        }
+        else if ((words > 6) && ((i % words) == 4))
+        {
+            temp[0] = hostAesSbox[temp[0]];
+            temp[1] = hostAesSbox[temp[1]];
+            temp[2] = hostAesSbox[temp[2]];
+            temp[3] = hostAesSbox[temp[3]];
+        }
+        hostAesRoundKeys[(i * 4) + 0] = hostAesRoundKeys[((i - words) * 4) + 0] ^ temp[0];
+        hostAesRoundKeys[(i * 4) + 1] = hostAesRoundKeys[((i - words) * 4) + 1] ^ temp[1];
+        hostAesRoundKeys[(i * 4) + 2] = hostAesRoundKeys[((i - words) * 4) + 2] ^ temp[2];
+        hostAesRoundKeys[(i * 4) + 3] = hostAesRoundKeys[((i - words) * 4) + 3] ^ temp[3];
+    }
+}
+
+static void HostAes_AddRoundKey(uint8_t state[16], uint8_t round)
+{
+    unsigned int i;
+
+    for (i = 0; i < HOST_AES_BLOCK_SIZE; i++)
+    {
+        state[i] ^= hostAesRoundKeys[(round * HOST_AES_BLOCK_SIZE) + i];
+    }
+}
+
+static void HostAes_MixColumn(uint8_t *column, const uint8_t coefficients[4])
+{
+    uint8_t a[4];
+    unsigned int i;
+
+    memcpy(a, column, 4);
+    for (i = 0; i < 4; i++)
+    {
+        column[i] = HostAes_Multiply(a[0], coefficients[(4 - i) % 4]) ^
+                    HostAes_Multiply(a[1], coefficients[(5 - i) % 4]) ^
+                    HostAes_Multiply(a[2], coefficients[(6 - i) % 4]) ^
+                    HostAes_Multiply(a[3], coefficients[(7 - i) % 4]);
+    }
+}
+
+void HostAes_EncryptBlock(const uint8_t in[16], uint8_t out[16])
+{
+    static const uint8_t mix[4] = {0x02, 0x03, 0x01, 0x01};
+    uint8_t state[HOST_AES_BLOCK_SIZE];
+    uint8_t shifted[HOST_AES_BLOCK_SIZE];
+    unsigned int round;
+    unsigned int i;
+
+    memcpy(state, in, HOST_AES_BLOCK_SIZE);
+    HostAes_AddRoundKey(state, 0);
+
+    for (round = 1; round <= hostAesRounds; round++)
+    {
+        // SubBytes and ShiftRows (state is column-major)
+        for (i = 0; i < HOST_AES_BLOCK_SIZE; i++)
+        {
+            shifted[i] = hostAesSbox[state[(i + (4 * (i % 4))) % HOST_AES_BLOCK_SIZE]];
+        }
+        memcpy(state, shifted, HOST_AES_BLOCK_SIZE);
+
+        if (round != hostAesRounds)
+        {
+            for (i = 0; i < 4; i++)
+            {
+                HostAes_MixColumn(&state[4 * i], mix);
+            }
+        }
+        HostAes_AddRoundKey(state, round);
+    }
+
+    memcpy(out, state, HOST_AES_BLOCK_SIZE);
+}
+
+void HostAes_DecryptBlock(const uint8_t in[16], uint8_t out[16])
+{
+    static const uint8_t invMix[4] = {0x0e, 0x0b, 0x0d, 0x09};
+    uint8_t state[HOST_AES_BLOCK_SIZE];
+    uint8_t shifted[HOST_AES_BLOCK_SIZE];
+    int round;
+    unsigned int i;
+
+    memcpy(state, in, HOST_AES_BLOCK_SIZE);
+    HostAes_AddRoundKey(state, hostAesRounds);
+
+    for (round = hostAesRounds - 1; round >= 0; round--)
+    {
+        // InvShiftRows and InvSubBytes
+        for (i = 0; i < HOST_AES_BLOCK_SIZE; i++)
+        {
+            shifted[(i + (4 * (i % 4))) % HOST_AES_BLOCK_SIZE] = hostAesInvSbox[state[i]];
+        }
+        memcpy(state, shifted, HOST_AES_BLOCK_SIZE);
+
+        HostAes_AddRoundKey(state, (uint8_t)round);
+        if (round != 0)
+        {
+            for (i = 0; i < 4; i++)
+            {
+                HostAes_MixColumn(&state[4 * i], invMix);
+            }
+        }
+    }
+
+    memcpy(out, state, HOST_AES_BLOCK_SIZE);
+}
+
+/*
+ * Peripheral model
+ */
+static uint16_t HostAes_Reg(uint16_t offset)
+{
+    return HostRegs_Read16(AES256_BASE + offset);
+}
+
+static uint8_t HostAes_KeyLengthBytes(void)
+{
+    switch (HostAes_Reg(OFS_AESACTL0) & (AESKL0 | AESKL1))
+    {
+        case AESKL__128:
+            return 16;
+        case AESKL__192:
+            return 24;
+        default:
+            return 32;
+    }
+}
+
+static void HostAes_UpdateStatus(void)
+{
+    uint16_t stat = HostAes_Reg(OFS_AESASTAT) & AESKEYWR;
+
+    if (hostAesBusy && (HostCpu_GetCycles() >= hostAesDoneCycles))
+    {
+        hostAesBusy = false;
+        HostRegs_Write16(AES256_BASE + OFS_AESACTL0, HostAes_Reg(OFS_AESACTL0) | AESRDYIFG);
+        if ((HostAes_Reg(OFS_AESACTL0) & AESCMEN) != 0)
+        {
+            hostAesOutputWords = HOST_AES_BLOCK_WORDS;
+        }
+    }
+
+    if (hostAesBusy)
+    {
+        stat |= AESBUSY;
+    }
+    stat |= (uint16_t)(hostAesKeyCount / 2) << 4;
+    stat |= (uint16_t)(hostAesDataInCount / 2) << 8;
+    stat |= (uint16_t)(hostAesDataOutCount / 2) << 12;
+    HostRegs_Write16(AES256_BASE + OFS_AESASTAT, stat);
+}
+
+/**
+ * @brief      AESSWRST: reset everything but AESRDYIE, AESKLx and AESOPx, the
+ *             loaded key and the state memory included
+ */
+static void HostAes_Reset(uint16_t ctl)
+{
+    hostAesKeyCount = 0;
+    hostAesDataInCount = 0;
+    hostAesDataOutCount = 0;
+    hostAesBusy = false;
+    hostAesBlocksLeft = 0;
+    hostAesOutputWords = 0;
+    memset(hostAesDataOut, 0, sizeof(hostAesDataOut));
+    HostRegs_Write16(AES256_BASE + OFS_AESACTL0, ctl & (AESRDYIE | AESKL0 | AESKL1 | AESOP_3));
+    HostRegs_Write16(AES256_BASE + OFS_AESASTAT, 0);
+}
+
+static void HostAes_Start(void)
+{
+    uint16_t ctl = HostAes_Reg(OFS_AESACTL0);
+
+    switch (ctl & AESOP_3)
+    {
+        case 0:
+            HostAes_EncryptBlock(hostAesDataIn, hostAesDataOut);
+            break;
+        case AESOP0:
+        case AESOP_3:
+            HostAes_DecryptBlock(hostAesDataIn, hostAesDataOut);
+            break;
+        default:
+            // Decipher key generation, the key schedule serves both directions
+            break;
+    }
+
+    hostAesDataInCount = 0;
+    hostAesDataOutCount = 0;
+    hostAesBusy = true;
+    if (((ctl & AESCMEN) != 0) && (hostAesBlocksLeft != 0))
+    {
+        hostAesBlocksLeft--;
+    }
+    hostAesDoneCycles = HostCpu_GetCycles() + HOST_AES_BLOCK_CYCLES;
+    HostRegs_Write16(AES256_BASE + OFS_AESACTL0, ctl & ~AESRDYIFG);
+}
+
+static uint8_t HostAes_RegFlags(uint16_t offset)
+{
+    switch (offset)
+    {
+        case OFS_AESACTL1:
+            // Rewriting the same block count starts another run
+        case OFS_AESAKEY:
+        case OFS_AESADIN:
+        case OFS_AESAXDIN:
+        case OFS_AESAXIN:
+            return HOST_REG_WRITE_FIFO;
+        case OFS_AESADOUT:
+            return HOST_REG_READ_FIFO;
+        default:
+            return HOST_REG_PLAIN;
+    }
+}
+
+static void HostAes_Read(uint16_t offset)
+{
+    switch (offset)
+    {
+        case OFS_AESASTAT:
+        {
+            HostAes_UpdateStatus();
+            break;
+        }
+        case OFS_AESADOUT:
+        {
+            HostAes_UpdateStatus();
+            if (hostAesBusy)
+            {
+                HostRegs_Write16(AES256_BASE + OFS_AESACTL0, HostAes_Reg(OFS_AESACTL0) | AESERRFG);
+            }
+            HostRegs_Write16(AES256_BASE + OFS_AESADOUT,
+                             (uint16_t)hostAesDataOut[hostAesDataOutCount] |
+                             ((uint16_t)hostAesDataOut[hostAesDataOutCount + 1] << 8));
+            hostAesDataOutCount = (hostAesDataOutCount + 2) % HOST_AES_BLOCK_SIZE;
+            if (hostAesOutputWords != 0)
+            {
+                hostAesOutputWords--;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void HostAes_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    uint8_t lo = (uint8_t)newValue;
+    uint8_t hi = (uint8_t)(newValue >> 8);
+
+    switch (offset)
+    {
+        case OFS_AESACTL0:
+        {
+            if ((newValue & AESSWRST) != 0)
+            {
+                HostAes_Reset(newValue);
+                break;
+            }
+            else if ((newValue ^ oldValue) & (AESKL0 | AESKL1))
+            {
+                // Changing the key length invalidates the loaded key
+                hostAesKeyCount = 0;
+            }
+            if ((newValue & AESCMEN) == 0)
+            {
+                hostAesBlocksLeft = 0;
+                hostAesOutputWords = 0;
+            }
+            break;
+        }
+        case OFS_AESACTL1:
+        {
+            hostAesBlocksLeft = (uint8_t)(newValue & HOST_AES_BLKCNT_MASK);
+            break;
+        }
+        case OFS_AESAKEY:
+        {
+            hostAesKey[hostAesKeyCount++] = lo;
+            hostAesKey[hostAesKeyCount++] = hi;
+            if (hostAesKeyCount >= HostAes_KeyLengthBytes())
+            {
+                HostAes_ExpandKey(hostAesKey, hostAesKeyCount);
+                hostAesKeyCount = 0;
+                HostRegs_Write16(AES256_BASE + OFS_AESASTAT, HostAes_Reg(OFS_AESASTAT) | AESKEYWR);
+            }
+            break;
+        }
+        case OFS_AESADIN:
+        case OFS_AESAXDIN:
+        case OFS_AESAXIN:
+        {
+            HostAes_UpdateStatus();
+            if (hostAesBusy)
+            {
+                HostRegs_Write16(AES256_BASE + OFS_AESACTL0, HostAes_Reg(OFS_AESACTL0) | AESERRFG);
+            }
+            // The XOR variants combine the new data with the last result (CBC)
+            if (offset != OFS_AESADIN)
+            {
+                lo ^= hostAesDataOut[hostAesDataInCount];
+                hi ^= hostAesDataOut[hostAesDataInCount + 1];
+            }
+            hostAesDataIn[hostAesDataInCount++] = lo;
+            hostAesDataIn[hostAesDataInCount++] = hi;
+            if (hostAesDataInCount >= HOST_AES_BLOCK_SIZE)
+            {
+                if ((offset != OFS_AESAXIN) && ((HostAes_Reg(OFS_AESASTAT) & AESKEYWR) != 0))
+                {
+                    HostAes_Start();
+                }
+                hostAesDataInCount = 0;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void HostAes_Service(void)
+{
+    if (hostAesBusy)
+    {
+        HostAes_UpdateStatus();
+    }
+}
+
+/**
+ * @brief      Check whether one of the AES DMA triggers is raised
+ *
+ * @param[in]  trigger  0 for the output, 1 for the input
+ */
+bool HostAes_DmaTrigger(uint8_t trigger)
+{
+    if ((HostAes_Reg(OFS_AESACTL0) & AESCMEN) == 0)
+    {
+        return false;
+    }
+
+    HostAes_UpdateStatus();
+    if (hostAesBusy)
+    {
+        return false;
+    }
+    if (trigger == 0)
+    {
+        return (hostAesOutputWords != 0);
+    }
+
+    return (hostAesOutputWords == 0) && (hostAesBlocksLeft != 0);
+}
+
+static int HostAes_PendingVector(void)
+{
+    uint16_t ctl = HostAes_Reg(OFS_AESACTL0);
+
+    if (((ctl & AESRDYIFG) != 0) && ((ctl & AESRDYIE) != 0))
+    {
+        return AES256_VECTOR;
+    }
+
+    return -1;
+}
+
+const hostPeripheral_t hostAes =
+{
+    "AES256",
+    AES256_BASE,
+    HOST_AES_SIZE,
+    HostAes_RegFlags,
+    HostAes_Read,
+    HostAes_Write,
+    HostAes_Service,
+    HostAes_PendingVector,
+};
@@ -0,0 +1,432 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Policy benchmark over a fixed library of power-loss traces.
+ *
+ *   fixture_bench [options] <trace> [<trace> ...]
+ *
+ * Runs every workload scaling policy against every trace in the
+ * discrete-event simulator (host_sim.c) and reports goodput, wasted bytes,
+ * aborted chunks and time to completion. Given a baseline, each result is
+ * compared against the row for the same trace and policy, and the run fails
+ * if any metric got worse by more than the tolerance.
+ *
+ *   -b <file>   Baseline CSV to compare against
+ *   -t <pct>    Tolerance in percent (default 2)
+ *   -w <file>   Also write the results as a baseline CSV
+ *   -m <MB>     Total workload size in MB (default 5)
+ *   -c <B>      Starting chunk size in bytes (default 1024)
+ *   -d <us>     Dead-time between chunks (default 1000)
+ *   -r <seed>   Seed for the random policies (default 1)
+ *   -P <file>   Cost profile from the fixture's Calibrate menu
+ *   -a <cycles> AES block cost
+ *   -o <cycles> Per-chunk overhead
+ *   -l <s>      Virtual time limit per run (default 3600)
+ *   -j <n>      Worker threads (default one per core)
+ *
+ * The results only depend on these options and the traces, so a baseline is
+ * only meaningful for the options it was written with; see "make bench".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "host_pool.h"
+#include "host_sim.h"
+#include "checkpointing_test_fixture.h"
+
+#define HOST_BENCH_MAX_TRACES   (64)
+#define HOST_BENCH_MAX_NAME     (64)
+
+typedef struct
+{
+    char trace[HOST_BENCH_MAX_NAME];
+    unsigned int policy;
+    int completed;
+    double goodputBytesPerSecond;
+    unsigned long long wastedBytes;
+    unsigned long aborts;
+    double completionSeconds;
+} hostBenchRow_t;
+
+typedef struct
+{
+    const char *tracePaths[HOST_BENCH_MAX_TRACES];
+    hostSimGenerator_t generators[HOST_BENCH_MAX_TRACES];
+    unsigned int numTraces;
+    uint64_t totalWorkloadSizeBytes;
+    uint32_t startingChunkSize;
+    uint32_t deadTimeMicroseconds;
+    unsigned long seed;
+    hostSimTiming_t timing;
+    uint64_t timeLimitCycles;
+    // One per job, traces vary slowest
+    hostBenchRow_t *rows;
+} hostBench_t;
+
+/**
+ * @brief      The file name of a trace, which identifies it in the baseline
+ */
+static const char *HostBench_TraceName(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+
+    return (slash != NULL) ? (slash + 1) : path;
+}
+
+/**
+ * @brief      Simulate one policy against one trace, run in a pool worker
+ */
+static void HostBench_RunJob(unsigned int job, void *arg)
+{
+    hostBench_t *bench = arg;
+    unsigned int trace = job / WORKLOAD_SCALING_NUM;
+    hostBenchRow_t *row = &bench->rows[job];
+    hostSimResult_t result;
+    checkpointingObj_t ctx;
+    hostSim_t sim;
+
+    Checkpointing_Init(&ctx);
+    ctx.totalWorkloadSizeBytes = bench->totalWorkloadSizeBytes;
+    Checkpointing_SetChunkBounds(&ctx, bench->startingChunkSize, ctx.minChunkSize, ctx.maxChunkSize);
+    ctx.deadTimeMicroseconds = bench->deadTimeMicroseconds;
+    ctx.policy = (workloadScalingPolicy_e)(job % WORKLOAD_SCALING_NUM);
+
+    HostSim_Init(&sim, bench->seed);
+    HostSim_AddGenerator(&sim, &bench->generators[trace]);
+    Checkpointing_Seed(&ctx, (uint32_t)bench->seed);
+
+    HostSim_RunWorkload(&sim, &ctx, &bench->timing, bench->timeLimitCycles, &result);
+
+    snprintf(row->trace, sizeof(row->trace), "%s", HostBench_TraceName(bench->tracePaths[trace]));
+    row->policy = (unsigned int)ctx.policy;
+    row->completed = result.completed ? 1 : 0;
+    row->completionSeconds = (double)result.elapsedCycles / (double)HOST_MCLK_HZ;
+    row->goodputBytesPerSecond = (row->completionSeconds > 0.0) ?
+                                 ((double)result.bytesProcessed / row->completionSeconds) : 0.0;
+    row->wastedBytes = (unsigned long long)result.wastedBytes;
+    row->aborts = (unsigned long)result.chunksFailed;
+}
+
+static void HostBench_WriteCsv(const hostBenchRow_t *rows, unsigned int numRows, FILE *out)
+{
+    unsigned int i;
+
+    fprintf(out, "trace,policy,completed,goodput_Bps,wasted_bytes,aborts,completion_s\n");
+    for (i = 0; i < numRows; i++)
+    {
+        fprintf(out, "%s,%u,%d,%.1f,%llu,%lu,%.6f\n",
+                rows[i].trace, rows[i].policy, rows[i].completed, rows[i].goodputBytesPerSecond,
+                rows[i].wastedBytes, rows[i].aborts, rows[i].completionSeconds);
+    }
+}
+
+/**
+ * @brief      Read a baseline written by HostBench_WriteCsv()
+ *
+ * @return     Number of rows read into rows, or -1 if the file can't be read
+ */
+static int HostBench_ReadCsv(const char *path, hostBenchRow_t *rows, unsigned int maxRows)
+{
+    FILE *file = fopen(path, "r");
+    char line[256];
+    unsigned int numRows = 0;
+    hostBenchRow_t *row;
+
+    if (file == NULL)
+    {
+        return -1;
+    }
+    while ((numRows < maxRows) && (fgets(line, sizeof(line), file) != NULL))
+    {
+        row = &rows[numRows];
+        if (sscanf(line, "%63[^,],%u,%d,%lf,%llu,%lu,%lf",
+                   row->trace, &row->policy, &row->completed, &row->goodputBytesPerSecond,
+                   &row->wastedBytes, &row->aborts, &row->completionSeconds) == 7)
+        {
+            numRows++;
+        }
+    }
+    fclose(file);
+
+    return (int)numRows;
+}
+
+/**
+ * @brief      Check one metric against its baseline
+ *
+ * @param[in]  higherIsBetter  Direction of improvement for this metric
+ *
+ * @return     true if the metric regressed beyond the tolerance
+ */
+static bool HostBench_Regressed(double value, double baseline, double tolerance, bool higherIsBetter)
+{
+    if (higherIsBetter)
+    {
+        return value < (baseline * (1.0 - tolerance));
+    }
+    return value > (baseline * (1.0 + tolerance));
+}
+
+/**
+ * @brief      Compare every result with its baseline row and print a report
+ *
+ * @return     Number of results that regressed or have no baseline
+ */
+static unsigned int HostBench_Compare(const hostBenchRow_t *rows, unsigned int numRows,
+                                      const hostBenchRow_t *baseline, unsigned int numBaseline,
+                                      double tolerance)
+{
+    const hostBenchRow_t *base;
+    unsigned int failures = 0;
+    bool regressed;
+    unsigned int i;
+    unsigned int j;
+
+    printf("%-24s %6s %12s %12s %12s %8s %8s %12s  %s\n", "trace", "policy", "goodput B/s", "vs base",
+           "wasted B", "vs base", "aborts", "time s", "status");
+    for (i = 0; i < numRows; i++)
+    {
+        base = NULL;
+        for (j = 0; j < numBaseline; j++)
+        {
+            if ((baseline[j].policy == rows[i].policy) && (strcmp(baseline[j].trace, rows[i].trace) == 0))
+            {
+                base = &baseline[j];
+                break;
+            }
+        }
+
+        if (base == NULL)
+        {
+            printf("%-24s %6u %12.1f %12s %12llu %8s %8lu %12.6f  NO BASELINE\n",
+                   rows[i].trace, rows[i].policy, rows[i].goodputBytesPerSecond, "",
+                   rows[i].wastedBytes, "", rows[i].aborts, rows[i].completionSeconds);
+            failures++;
+            continue;
+        }
+
+        regressed = (rows[i].completed < base->completed) ||
+                    HostBench_Regressed(rows[i].goodputBytesPerSecond, base->goodputBytesPerSecond, tolerance, true) ||
+                    HostBench_Regressed((double)rows[i].wastedBytes, (double)base->wastedBytes, tolerance, false) ||
+                    HostBench_Regressed((double)rows[i].aborts, (double)base->aborts, tolerance, false) ||
+                    HostBench_Regressed(rows[i].completionSeconds, base->completionSeconds, tolerance, false);
+        printf("%-24s %6u %12.1f %+11.2f%% %12llu %+7.1f%% %8lu %12.6f  %s\n",
+               rows[i].trace, rows[i].policy, rows[i].goodputBytesPerSecond,
+               (base->goodputBytesPerSecond > 0.0) ?
+               (100.0 * (rows[i].goodputBytesPerSecond / base->goodputBytesPerSecond - 1.0)) : 0.0,
+               rows[i].wastedBytes,
+               (base->wastedBytes > 0) ?
+               (100.0 * ((double)rows[i].wastedBytes / (double)base->wastedBytes - 1.0)) : 0.0,
+               rows[i].aborts, rows[i].completionSeconds,
+               regressed ? "REGRESSED" : (rows[i].completed ? "ok" : "ok (timed out)"));
+        if (regressed)
+        {
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+static void HostBench_Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-b baseline] [-t pct] [-w file] [-m MB] [-c bytes] [-d us] [-r seed]\n"
+            "       [-P profile] [-a cycles] [-o cycles] [-l s] [-j workers] trace [trace ...]\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    static hostBench_t bench;
+    static hostBenchRow_t baseline[HOST_BENCH_MAX_TRACES * WORKLOAD_SCALING_NUM];
+    const char *baselinePath = NULL;
+    const char *outPath = NULL;
+    char spec[256];
+    double tolerance = 0.02;
+    unsigned long timeLimitSeconds = 3600;
+    unsigned int numWorkers = 0;
+    unsigned int numJobs;
+    unsigned int failures = 0;
+    int numBaseline;
+    FILE *out;
+    unsigned int i;
+    int opt;
+
+    bench.totalWorkloadSizeBytes = 5 * 1024ULL * 1024ULL;
+    bench.startingChunkSize = 1024;
+    bench.deadTimeMicroseconds = 1000;
+    bench.seed = 1;
+    HostSim_DefaultTiming(&bench.timing);
+
+    while ((opt = getopt(argc, argv, "b:t:w:m:c:d:r:P:a:o:l:j:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'b':
+            {
+                baselinePath = optarg;
+                break;
+            }
+            case 't':
+            {
+                tolerance = strtod(optarg, NULL) / 100.0;
+                break;
+            }
+            case 'w':
+            {
+                outPath = optarg;
+                break;
+            }
+            case 'm':
+            {
+                bench.totalWorkloadSizeBytes = 1024ULL * 1024ULL * strtoull(optarg, NULL, 0);
+                break;
+            }
+            case 'c':
+            {
+                bench.startingChunkSize = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'd':
+            {
+                bench.deadTimeMicroseconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'r':
+            {
+                bench.seed = strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'P':
+            {
+                if (!HostSim_LoadProfile(optarg, &bench.timing))
+                {
+                    fprintf(stderr, "bad cost profile: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'a':
+            {
+                bench.timing.aesBlockCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'o':
+            {
+                bench.timing.chunkOverheadCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'l':
+            {
+                timeLimitSeconds = strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'j':
+            {
+                numWorkers = (unsigned int)strtoul(optarg, NULL, 0);
+                break;
+            }
+            default:
+            {
+                HostBench_Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+            }
+        }
+    }
+    if ((optind >= argc) || ((argc - optind) > HOST_BENCH_MAX_TRACES))
+    {
+        HostBench_Usage(argv[0]);
+        return 1;
+    }
+    for (; optind < argc; optind++)
+    {
+        snprintf(spec, sizeof(spec), "trace:%s", argv[optind]);
+        if (!HostSim_ParseGenerator(spec, &bench.generators[bench.numTraces]))
+        {
+            fprintf(stderr, "can't load trace: %s\n", argv[optind]);
+            return 1;
+        }
+        bench.tracePaths[bench.numTraces++] = argv[optind];
+    }
+    bench.timeLimitCycles = timeLimitSeconds * HOST_MCLK_HZ;
+
+    numJobs = bench.numTraces * WORKLOAD_SCALING_NUM;
+    bench.rows = calloc(numJobs, sizeof(*bench.rows));
+    if (bench.rows == NULL)
+    {
+        fprintf(stderr, "out of memory for %u results\n", numJobs);
+        return 1;
+    }
+    if (numWorkers == 0)
+    {
+        numWorkers = HostPool_DefaultWorkers();
+    }
+    if (!HostPool_Run(numJobs, numWorkers, HostBench_RunJob, &bench))
+    {
+        fprintf(stderr, "benchmark failed\n");
+        return 1;
+    }
+
+    if (outPath != NULL)
+    {
+        out = fopen(outPath, "w");
+        if (out == NULL)
+        {
+            perror(outPath);
+            return 1;
+        }
+        HostBench_WriteCsv(bench.rows, numJobs, out);
+        fclose(out);
+    }
+
+    if (baselinePath != NULL)
+    {
+        numBaseline = HostBench_ReadCsv(baselinePath, baseline, sizeof(baseline) / sizeof(baseline[0]));
+        if (numBaseline < 0)
+        {
+            perror(baselinePath);
+            return 1;
+        }
+        failures = HostBench_Compare(bench.rows, numJobs, baseline, (unsigned int)numBaseline, tolerance);
+        printf("%u of %u results regressed beyond %.1f%% or have no baseline\n",
+               failures, numJobs, tolerance * 100.0);
+    }
+    else
+    {
+        HostBench_WriteCsv(bench.rows, numJobs, stdout);
+    }
+
+    free(bench.rows);
+    for (i = 0; i < bench.numTraces; i++)
+    {
+        HostSim_FreeGenerator(&bench.generators[i]);
+    }
+
+    return (failures == 0) ? 0 : 2;
+}
@@ -0,0 +1,194 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Board bring-up for the host build. Runs before main(), as the MSP430 reset
+ * and C start-up would, and connects the board model to the host according to
+ * the environment:
+ *
+ *   FIXTURE_UART=stdio|pty             eUSCI_A0 on this terminal (default) or
+ *                                      on a new pseudo-terminal
+ *   FIXTURE_TIME_SCALE=<n>             Board microseconds per host microsecond
+ *                                      (default 1)
+ *   FIXTURE_POWER_LOSS_PERIOD_US=<n>   Pulse P8.1 every n board microseconds,
+ *                                      like the power-loss emulator (default off)
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+#include "host_cpu.h"
+
+static struct termios hostBoardSavedTermios;
+static bool hostBoardTermiosSaved;
+
+static unsigned long HostBoard_GetEnv(const char *name, unsigned long defaultValue)
+{
+    const char *value = getenv(name);
+    return (value != NULL) ? strtoul(value, NULL, 0) : defaultValue;
+}
+
+static void HostBoard_RestoreTerminal(void)
+{
+    if (hostBoardTermiosSaved)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &hostBoardSavedTermios);
+    }
+}
+
+static void HostBoard_Interrupted(int signal)
+{
+    HostBoard_RestoreTerminal();
+    _exit(128 + signal);
+}
+
+/**
+ * @brief      Put the terminal in the mode a serial terminal program would use:
+ *             no line editing, no local echo (the fixture echoes), CR on enter
+ */
+static void HostBoard_RawTerminal(int fd)
+{
+    struct termios raw;
+
+    if (!isatty(fd) || (tcgetattr(fd, &hostBoardSavedTermios) != 0))
+    {
+        return;
+    }
+    hostBoardTermiosSaved = true;
+    atexit(HostBoard_RestoreTerminal);
+    signal(SIGINT, HostBoard_Interrupted);
+    signal(SIGTERM, HostBoard_Interrupted);
+
+    raw = hostBoardSavedTermios;
+    raw.c_iflag &= ~(ICRNL | INLCR | IXON);
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(fd, TCSANOW, &raw);
+}
+
+/**
+ * @brief      Create a pseudo-terminal for the UART
+ *
+ * @return     The master side descriptor, or -1 on failure
+ */
+static int HostBoard_OpenPty(void)
+{
+    struct termios raw;
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    int slave;
+
+    if ((master < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0))
+    {
+        return -1;
+    }
+
+    // Hold the slave open so the master does not hang up between sessions
+    slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    if ((slave >= 0) && (tcgetattr(slave, &raw) == 0))
+    {
+        cfmakeraw(&raw);
+        tcsetattr(slave, TCSANOW, &raw);
+    }
+
+    fprintf(stderr, "host: eUSCI_A0 on %s\n", ptsname(master));
+    return master;
+}
+
+static void HostBoard_PowerLossTick(int signal)
+{
+    HostGpio_PulsePowerLoss();
+    HostCpu_ServiceFromSignal();
+}
+
+/**
+ * @brief      Emulate the external power-loss emulator with an interval timer
+ *
+ * @param[in]  periodMicroseconds  Pulse period in board time
+ * @param[in]  timeScale           Board microseconds per host microsecond
+ */
+static void HostBoard_StartPowerLossEmulator(unsigned long periodMicroseconds, unsigned long timeScale)
+{
+    struct sigaction action;
+    struct itimerval timer;
+    unsigned long hostPeriod = periodMicroseconds / timeScale;
+
+    if (hostPeriod == 0)
+    {
+        hostPeriod = 1;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = HostBoard_PowerLossTick;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGALRM, &action, NULL);
+
+    timer.it_interval.tv_sec = hostPeriod / 1000000UL;
+    timer.it_interval.tv_usec = hostPeriod % 1000000UL;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_REAL, &timer, NULL);
+}
+
+__attribute__((constructor))
+static void HostBoard_PowerOn(void)
+{
+    const char *uart = getenv("FIXTURE_UART");
+    unsigned long timeScale = HostBoard_GetEnv("FIXTURE_TIME_SCALE", 1);
+    unsigned long powerLossPeriod = HostBoard_GetEnv("FIXTURE_POWER_LOSS_PERIOD_US", 0);
+    int fd;
+
+    if (timeScale == 0)
+    {
+        timeScale = 1;
+    }
+    HostCpu_Init((uint32_t)timeScale);
+
+    if ((uart != NULL) && (strcmp(uart, "pty") == 0))
+    {
+        fd = HostBoard_OpenPty();
+        HostUart_Init(fd, fd);
+    }
+    else
+    {
+        HostBoard_RawTerminal(STDIN_FILENO);
+        HostUart_Init(STDIN_FILENO, STDOUT_FILENO);
+    }
+
+    // The power-loss line idles high, pulses low on each event
+    HostGpio_SetInput(8, 1, true);
+
+    if (powerLossPeriod != 0)
+    {
+        HostBoard_StartPowerLossEmulator(powerLossPeriod, timeScale);
+    }
+}
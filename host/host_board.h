@@ -0,0 +1,64 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef HOST_BOARD_H
+#define HOST_BOARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_regs.h"
+
+// Peripheral models making up the simulated board
+extern const hostPeripheral_t hostGpio;
+extern const hostPeripheral_t hostTimerA0;
+extern const hostPeripheral_t hostTimerA1;
+extern const hostPeripheral_t hostTimerB0;
+extern const hostPeripheral_t hostUartA0;
+extern const hostPeripheral_t hostAes;
+extern const hostPeripheral_t hostDma;
+extern const hostPeripheral_t hostCrc32;
+extern const hostPeripheral_t hostMpy32;
+extern const hostPeripheral_t hostAdc12;
+
+// GPIO model
+void HostGpio_SetInput(uint8_t port, uint8_t pin, bool level);
+void HostGpio_PulsePowerLoss(void);
+
+// eUSCI_A0 model
+void HostUart_Init(int inFd, int outFd);
+
+// Software AES-256 used by the AES256 model
+void HostAes_ExpandKey(const uint8_t *key, uint8_t keyLengthBytes);
+void HostAes_EncryptBlock(const uint8_t in[16], uint8_t out[16]);
+void HostAes_DecryptBlock(const uint8_t in[16], uint8_t out[16]);
+// AES DMA triggers (cipher mode enabled): 0 output ready, 1 input wanted
+bool HostAes_DmaTrigger(uint8_t trigger);
+
+// ADC12 DMA trigger (a conversion result waiting)
+bool HostAdc12_DmaTrigger(void);
+// The ADC12 model's synthetic sensor: its reading at a conversion, and the
+// noise generator it carries from one to the next (seeded with 1)
+uint16_t HostAdc12_SensorReading(uint32_t conversion, uint32_t *noise);
+
+#endif // HOST_BOARD_H
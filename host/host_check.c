@@ -0,0 +1,856 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Checks of the fixture's peripheral-driven code against the register models.
+ *
+ *   fixture_check
+ *
+ * Runs the fixture's own cipher code on the AES and DMA models, its ADC
+ * workload on the ADC12 and DMA models, its checkpoints on the CRC32 model
+ * and its trace replay on the Timer_B0 model, the way fixture_host does, and
+ * checks what they produce against a reference. CRC32 and FIR runs resumed
+ * from checkpoints are checked against ones run straight through,
+ * and the chunk-size policies' estimators against values worked out by hand.
+ * Prints one line per check and exits non-zero if any failed; see
+ * "make check".
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+#include "host_cpu.h"
+#include "cipher.h"
+#include "workload.h"
+#include "checkpoint.h"
+#include "trace.h"
+#include "replay.h"
+#include "checkpointing_test_fixture.h"
+
+// Blocks per chunk checked, one DMA segment
+#define HOST_CHECK_BLOCKS       (64)
+#define HOST_CHECK_BYTES        (HOST_CHECK_BLOCKS * CIPHER_BLOCK_SIZE)
+// Cycles to let an aborted chunk run for, per attempt
+#define HOST_CHECK_ABORT_CYCLES (2000)
+#define HOST_CHECK_ABORT_TRIES  (64)
+// ADC batch checked: the rising half of the model's triangle wave, the whole
+// sample log in one DMA segment. Its extremes are the wave's, give or take
+// the noise.
+#define HOST_CHECK_ADC_SAMPLES  (2048)
+#define HOST_CHECK_ADC_MINIMUM  (512)
+#define HOST_CHECK_ADC_MAXIMUM  (3584)
+#define HOST_CHECK_ADC_NOISE    (32)
+// Replayed power losses: offsets from the sync pulse, one of them longer
+// than a Timer_B0 compare step, and the cycles in one of its 1 us ticks
+#define HOST_CHECK_REPLAY_LOSSES        (4)
+#define HOST_CHECK_REPLAY_TICK_CYCLES   (HOST_MCLK_HZ / 1000000)
+// Power losses fed to the predictive policy's estimator
+#define HOST_CHECK_PREDICTIVE_LOSSES    (5)
+// FIR run: its units, a window and a half, and the units committed before
+// the interrupted chunk, partway into the first window. The interrupted chunk
+// finishes that window and starts the next.
+#define HOST_CHECK_FIR_UNITS            (6)
+#define HOST_CHECK_FIR_COMMITTED        (3)
+// Chunks the CRC32 scan is split into, one pass of the scan region and a
+// unit into the next
+#define HOST_CHECK_CRC32_CHUNKS         (6)
+// Bandit policy run: chunks, the log2 of the pulls rewarded by the end,
+// each chunk's overhead and the time between chunks in us, and the share of
+// the chunks the best arm must have run, in percent
+#define HOST_CHECK_BANDIT_CHUNKS        (2048)
+#define HOST_CHECK_BANDIT_EPOCH         (10)
+#define HOST_CHECK_BANDIT_OVERHEAD      (2000)
+#define HOST_CHECK_BANDIT_GAP           (100)
+#define HOST_CHECK_BANDIT_SHARE         (80)
+
+static const uint8_t hostCheckKey[32] =
+{
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17,
+    0x18, 0x19, 0x1A, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F,
+};
+
+static const char *hostCheckModeNames[CIPHER_MODE_NUM] = {"ECB", "CBC", "CTR"};
+
+static const uint32_t hostCheckReplayOffsets[HOST_CHECK_REPLAY_LOSSES] = {20000, 45000, 115000, 130000};
+
+static unsigned int hostCheckFailures;
+
+/**
+ * @brief      Report a check
+ */
+static void HostCheck_Report(bool ok, const char *name, const char *mode)
+{
+    printf("%-4s %s (%s)\n", ok ? "ok" : "FAIL", name, mode);
+    if (!ok)
+    {
+        hostCheckFailures++;
+    }
+}
+
+/**
+ * @brief      Encrypt a chunk from the start of a stream with the blocking
+ *             engine, the reference the other engines are checked against
+ */
+static void HostCheck_Reference(cipherMode_e mode, uint8_t *reference)
+{
+    cipherStream_t stream;
+    unsigned int i;
+
+    Cipher_Init(&stream, mode, CIPHER_SOURCE_FRAM, CIPHER_ENGINE_BLOCKING);
+    Cipher_BeginChunk(&stream, HOST_CHECK_BLOCKS);
+    for (i = 0; i < HOST_CHECK_BLOCKS; i++)
+    {
+        Cipher_EncryptBlock(&stream);
+    }
+    Cipher_EndChunk(&stream);
+    memcpy(reference, cipherDestination, HOST_CHECK_BYTES);
+}
+
+/**
+ * @brief      Run a chunk as a whole, on the DMA or in runs of blocks
+ *
+ * @return     Blocks the chunk reported finished
+ */
+static uint16_t HostCheck_WholeChunk(cipherStream_t *stream, uint16_t blocks)
+{
+    uint16_t done;
+
+    Cipher_BeginChunk(stream, blocks);
+    done = Cipher_WaitChunk(stream);
+    Cipher_EndChunk(stream);
+
+    return done;
+}
+
+/**
+ * @brief      Start a chunk on the DMA engine and stop it as the power-loss
+ *             interrupt would, after a while
+ *
+ * @return     Blocks the aborted chunk reported finished
+ */
+static uint16_t HostCheck_AbortedDmaChunk(cipherStream_t *stream, uint32_t runCycles)
+{
+    uint16_t done = 0;
+
+    Cipher_BeginChunk(stream, HOST_CHECK_BLOCKS);
+    __delay_cycles(runCycles);
+    __disable_interrupt();
+    Cipher_AbortChunk(&done);
+    __enable_interrupt();
+    Cipher_EndChunk(stream);
+
+    return done;
+}
+
+/**
+ * @brief      The DMA engine against the blocking engine: a whole chunk, an
+ *             aborted one and the chunk that carries on after it
+ */
+static void HostCheck_DmaEngine(cipherMode_e mode)
+{
+    static uint8_t reference[HOST_CHECK_BYTES];
+    cipherStream_t stream;
+    uint16_t done = HOST_CHECK_BLOCKS;
+    unsigned int attempt;
+    bool ok;
+
+    HostCheck_Reference(mode, reference);
+
+    memset(cipherDestination, 0, sizeof(cipherDestination));
+    Cipher_Init(&stream, mode, CIPHER_SOURCE_FRAM, CIPHER_ENGINE_DMA);
+    ok = (HostCheck_WholeChunk(&stream, HOST_CHECK_BLOCKS) == HOST_CHECK_BLOCKS) &&
+         (memcmp(cipherDestination, reference, HOST_CHECK_BYTES) == 0);
+    HostCheck_Report(ok, "DMA chunk matches the blocking engine", hostCheckModeNames[mode]);
+
+    // Aborted part way, however long that takes the model on this host
+    for (attempt = 1; (attempt <= HOST_CHECK_ABORT_TRIES) && (done == HOST_CHECK_BLOCKS); attempt++)
+    {
+        memset(cipherDestination, 0, sizeof(cipherDestination));
+        Cipher_Init(&stream, mode, CIPHER_SOURCE_FRAM, CIPHER_ENGINE_DMA);
+        done = HostCheck_AbortedDmaChunk(&stream, HOST_CHECK_ABORT_CYCLES * attempt);
+    }
+    // The blocks counted are all out, the one after them isn't
+    ok = (done < HOST_CHECK_BLOCKS) &&
+         (memcmp(cipherDestination, reference, (size_t)done * CIPHER_BLOCK_SIZE) == 0) &&
+         (memcmp(&cipherDestination[done * CIPHER_BLOCK_SIZE], &reference[done * CIPHER_BLOCK_SIZE],
+                 CIPHER_BLOCK_SIZE) != 0);
+    HostCheck_Report(ok, "aborted DMA chunk counts the blocks it finished", hostCheckModeNames[mode]);
+
+    // Carrying on from the committed blocks, on a module that was mid-chunk
+    Cipher_Advance(&stream, done);
+    ok = (HostCheck_WholeChunk(&stream, HOST_CHECK_BLOCKS - done) == (HOST_CHECK_BLOCKS - done)) &&
+         (memcmp(cipherDestination, reference, HOST_CHECK_BYTES) == 0);
+    HostCheck_Report(ok, "DMA chunk after an abort carries on the stream", hostCheckModeNames[mode]);
+}
+
+/**
+ * @brief      The blocking engine's ECB runs against its block at a time
+ *             chunk, which the runs stand in for
+ */
+static void HostCheck_BlockingRuns(void)
+{
+    static uint8_t reference[HOST_CHECK_BYTES];
+    cipherStream_t stream;
+    bool ok;
+
+    HostCheck_Reference(CIPHER_MODE_ECB, reference);
+
+    memset(cipherDestination, 0, sizeof(cipherDestination));
+    Cipher_Init(&stream, CIPHER_MODE_ECB, CIPHER_SOURCE_FRAM, CIPHER_ENGINE_BLOCKING);
+    ok = Cipher_RunsWholeChunks(&stream) &&
+         (HostCheck_WholeChunk(&stream, HOST_CHECK_BLOCKS) == HOST_CHECK_BLOCKS) &&
+         (memcmp(cipherDestination, reference, HOST_CHECK_BYTES) == 0);
+    HostCheck_Report(ok, "blocking chunk run in runs matches it a block at a time", "ECB");
+}
+
+/**
+ * @brief      Set the ADC12 up the way Adc_Init() does
+ */
+static void HostCheck_AdcInit(void)
+{
+    ADC12_B_initParam initParam = {0};
+    ADC12_B_configureMemoryParam memoryParam = {0};
+
+    initParam.sampleHoldSignalSourceSelect = ADC12_B_SAMPLEHOLDSOURCE_SC;
+    initParam.clockSourceSelect = ADC12_B_CLOCKSOURCE_ADC12OSC;
+    initParam.clockSourceDivider = ADC12_B_CLOCKDIVIDER_1;
+    initParam.clockSourcePredivider = ADC12_B_CLOCKPREDIVIDER__1;
+    initParam.internalChannelMap = ADC12_B_NOINTCH;
+    ADC12_B_init(ADC12_B_BASE, &initParam);
+    ADC12_B_enable(ADC12_B_BASE);
+    ADC12_B_setupSamplingTimer(ADC12_B_BASE, ADC12_B_CYCLEHOLD_16_CYCLES, ADC12_B_CYCLEHOLD_16_CYCLES,
+                               ADC12_B_MULTIPLESAMPLESENABLE);
+
+    memoryParam.memoryBufferControlIndex = ADC12_B_MEMORY_0;
+    memoryParam.inputSourceSelect = ADC12_B_INPUT_A2;
+    memoryParam.refVoltageSourceSelect = ADC12_B_VREFPOS_AVCC_VREFNEG_VSS;
+    memoryParam.endOfSequence = ADC12_B_ENDOFSEQUENCE;
+    memoryParam.windowComparatorSelect = ADC12_B_WINDOW_COMPARATOR_DISABLE;
+    memoryParam.differentialModeSelect = ADC12_B_DIFFERENTIAL_MODE_DISABLE;
+    ADC12_B_configureMemory(ADC12_B_BASE, &memoryParam);
+}
+
+/**
+ * @brief      The ADC workload's reduction of a batch against the sensor's
+ *             readings, replayed from the model's first conversion
+ */
+static void HostCheck_AdcBatch(void)
+{
+    const workload_t *workload = &workloadTable[WORKLOAD_ADC];
+    uint16_t units = HOST_CHECK_ADC_SAMPLES / (workload->unitSize / sizeof(uint16_t));
+    workloadState_t state;
+    workloadAdcState_t reference = {0, 0, UINT16_MAX, 0};
+    uint32_t noise = 1;
+    uint16_t sample;
+    uint16_t done = 0;
+    uint32_t i;
+    bool ok;
+
+    for (i = 0; i < HOST_CHECK_ADC_SAMPLES; i++)
+    {
+        sample = HostAdc12_SensorReading(i, &noise);
+        reference.sum += sample;
+        if (sample < reference.minimum)
+        {
+            reference.minimum = sample;
+        }
+        if (sample > reference.maximum)
+        {
+            reference.maximum = sample;
+        }
+    }
+    ok = (reference.minimum >= (HOST_CHECK_ADC_MINIMUM - HOST_CHECK_ADC_NOISE)) &&
+         (reference.minimum <= (HOST_CHECK_ADC_MINIMUM + HOST_CHECK_ADC_NOISE)) &&
+         (reference.maximum >= (HOST_CHECK_ADC_MAXIMUM - HOST_CHECK_ADC_NOISE)) &&
+         (reference.maximum <= (HOST_CHECK_ADC_MAXIMUM + HOST_CHECK_ADC_NOISE));
+    HostCheck_Report(ok, "sensor swings between the wave's extremes", "ADC12");
+
+    HostCheck_AdcInit();
+    workload->init(&state);
+    workload->beginChunk(&state, units);
+    ok = workload->waitChunk(&state, &done);
+    workload->endChunk(&state);
+    ok = ok && (done == units) && (state.adc.offset == ((uint64_t)units * workload->unitSize)) &&
+         (state.adc.sum == reference.sum) && (state.adc.minimum == reference.minimum) &&
+         (state.adc.maximum == reference.maximum);
+    HostCheck_Report(ok, "batch reduces to the sensor's minimum, maximum and sum", "ADC12");
+}
+
+/**
+ * @brief      A commit restored into a fresh instance carries the policy state
+ *             a resumed run needs
+ */
+static void HostCheck_CheckpointRoundTrip(void)
+{
+    static checkpointStore_t store;
+    checkpointingObj_t committed;
+    checkpointingObj_t restored;
+    unsigned int i;
+    bool ok;
+
+    Checkpointing_Init(&committed);
+    committed.policy = WORKLOAD_SCALING_PREDICTIVE;
+    committed.predictiveMarginPercent = 75;
+    committed.unitCostQ8 = 0x1234;
+    committed.bytesProcessed = 4096;
+    Checkpointing_SetChunkSize(&committed, 2048);
+    committed.workloadState.stream.offset = committed.bytesProcessed;
+    // Two arms tried, five pulls, bonuses worked out for them
+    committed.banditArms[0].pulls = 3;
+    committed.banditArms[0].meanQ12 = 1000;
+    committed.banditArms[2].pulls = 2;
+    committed.banditArms[2].meanQ12 = 2000;
+    committed.banditPulls = 5;
+    committed.banditEpoch = 2;
+    committed.banditArm = 2;
+    Checkpointing_RestoreBandit(&committed);
+
+    memset(&store, 0, sizeof(store));
+    Checkpoint_Restore(&store, &committed);
+    Checkpoint_Commit(&store, &committed);
+    Checkpointing_Init(&restored);
+    ok = Checkpoint_Restore(&store, &restored) &&
+         (restored.policy == committed.policy) &&
+         (restored.predictiveMarginPercent == committed.predictiveMarginPercent) &&
+         (restored.unitCostQ8 == committed.unitCostQ8) &&
+         (restored.bytesProcessed == committed.bytesProcessed) &&
+         (restored.currentChunkSize == committed.currentChunkSize);
+    HostCheck_Report(ok, "commit restores the predictive policy's state", "checkpoint");
+    ok = (restored.banditPulls == committed.banditPulls) && (restored.banditEpoch == committed.banditEpoch) &&
+         (restored.banditArm == committed.banditArm);
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        ok = ok && (restored.banditArms[i].pulls == committed.banditArms[i].pulls) &&
+             (restored.banditArms[i].meanQ12 == committed.banditArms[i].meanQ12) &&
+             (restored.banditArms[i].bonusQ12 == committed.banditArms[i].bonusQ12);
+    }
+    HostCheck_Report(ok, "commit restores the bandit policy's arms", "checkpoint");
+
+    // Another firmware's layout is left alone
+    store.slots[1].layout = CHECKPOINT_LAYOUT + 1;
+    Checkpointing_Init(&restored);
+    ok = !Checkpoint_Restore(&store, &restored);
+    HostCheck_Report(ok, "slot of another layout isn't restored", "checkpoint");
+}
+
+/**
+ * @brief      The predictive policy's estimates and the chunk it sizes from
+ *             them, worked out by hand for a known run of power losses
+ */
+static void HostCheck_Predictive(void)
+{
+    // Power losses 1000 us apart, then one after 2000 us
+    static const uint32_t intervals[HOST_CHECK_PREDICTIVE_LOSSES] = {0, 1000, 1000, 1000, 2000};
+    checkpointingObj_t ctx;
+    uint32_t timestamp = 5000;
+    unsigned int i;
+    bool ok;
+
+    Checkpointing_Init(&ctx);
+    ctx.policy = WORKLOAD_SCALING_PREDICTIVE;
+    ctx.deadTimeMicroseconds = 500;
+    for (i = 0; i < HOST_CHECK_PREDICTIVE_LOSSES; i++)
+    {
+        timestamp += intervals[i];
+        Checkpointing_ObservePowerLoss(&ctx, timestamp);
+    }
+    // The fifth loss is weighed 1/4: the mean moves 1000 us / 4 and the
+    // variance gets (1000 us)^2 / 4
+    ok = (ctx.arrivals.events == HOST_CHECK_PREDICTIVE_LOSSES) && (ctx.arrivals.meanQ4 == (1250 << 4)) &&
+         (ctx.arrivals.variance == 250000) && (ctx.arrivals.lastMicroseconds == timestamp);
+    HostCheck_Report(ok, "arrivals give the mean and variance of their intervals", "predictive");
+
+    // A 64-unit chunk in 640 us, ending 250 us after the last loss. The window
+    // is 1250 us, 750 us of it gone by the end of the dead-time; the 500 us
+    // left is cut by 1250 / (1250 + 50% of a 500 us deviation) to 416 us,
+    // which fits 41 units of 10 us.
+    ctx.chunkBytesRun = ctx.currentChunkSize;
+    ctx.chunkMicroseconds = 640;
+    ctx.chunkEndMicroseconds = timestamp + 250;
+    Checkpointing_ExecutePolicy(&ctx);
+    ok = (ctx.unitCostQ8 == (10 << 8)) && (ctx.arrivalDeviationMicroseconds == 500) &&
+         (ctx.currentChunkSize == (41 * workloadTable[WORKLOAD_AES].unitSize));
+    HostCheck_Report(ok, "chunk fits the predicted rest of the window", "predictive");
+
+    // A 41-unit chunk at 20 us a unit pulls the cost 1/8 of the way up, to
+    // 11.25 us, and the same 416 us then fits 36 units
+    ctx.chunkBytesRun = ctx.currentChunkSize;
+    ctx.chunkMicroseconds = 41 * 20;
+    Checkpointing_ExecutePolicy(&ctx);
+    ok = (ctx.unitCostQ8 == ((10 << 8) + (10 << 5))) &&
+         (ctx.currentChunkSize == (36 * workloadTable[WORKLOAD_AES].unitSize));
+    HostCheck_Report(ok, "unit cost is a moving average of the chunks run", "predictive");
+}
+
+/**
+ * @brief      A FIR run interrupted mid-window and resumed from its checkpoint
+ *             filters the same as one that ran straight through
+ */
+static void HostCheck_FirResume(void)
+{
+    static checkpointStore_t store;
+    const workload_t *workload = &workloadTable[WORKLOAD_FIR];
+    checkpointingObj_t committed;
+    checkpointingObj_t restored;
+    workloadState_t reference;
+    workloadState_t chunkState;
+    unsigned int i;
+    bool ok;
+
+    workload->init(&reference);
+    for (i = 0; i < HOST_CHECK_FIR_UNITS; i++)
+    {
+        workload->doUnit(&reference);
+    }
+
+    // A first chunk commits partway through a window, with the window's sum
+    // in the multiplier's result
+    Checkpointing_Init(&committed);
+    committed.workload = WORKLOAD_FIR;
+    committed.commitMode = COMMIT_MODE_JIT;
+    memset(&store, 0, sizeof(store));
+    Checkpoint_Restore(&store, &committed);
+    workload->init(&committed.workloadState);
+    for (i = 0; i < HOST_CHECK_FIR_COMMITTED; i++)
+    {
+        workload->doUnit(&committed.workloadState);
+    }
+    committed.bytesProcessed = HOST_CHECK_FIR_COMMITTED * workload->unitSize;
+    Checkpoint_Commit(&store, &committed);
+
+    // The next chunk loses power after two units. The reset clears the
+    // multiplier; stand in for it, and for the compiled multiplies of the
+    // interrupt, by running it over.
+    chunkState = committed.workloadState;
+    workload->doUnit(&chunkState);
+    workload->doUnit(&chunkState);
+    Checkpoint_CommitJit(&store, 2);
+    MPY32_preloadResult(0x0123456789ABCDEFULL);
+    MPY32_setOperandOne16Bit(MPY32_MULTIPLY_UNSIGNED, 0xFFFF);
+    MPY32_setOperandTwo16Bit(0xFFFF);
+
+    Checkpointing_Init(&restored);
+    ok = (committed.workloadState.fir.accumulator != 0) && Checkpoint_Restore(&store, &restored) &&
+         (restored.workload == WORKLOAD_FIR) &&
+         (restored.bytesProcessed == ((HOST_CHECK_FIR_COMMITTED + 2) * workload->unitSize)) &&
+         (restored.workloadState.fir.offset == chunkState.fir.offset) &&
+         (restored.workloadState.fir.accumulator == chunkState.fir.accumulator) &&
+         (restored.workloadState.fir.sumExtension == chunkState.fir.sumExtension);
+    HostCheck_Report(ok, "restore brings back the accumulator and sum extension", "FIR");
+
+    for (i = HOST_CHECK_FIR_COMMITTED + 2; i < HOST_CHECK_FIR_UNITS; i++)
+    {
+        workload->doUnit(&restored.workloadState);
+    }
+    ok = (restored.workloadState.fir.offset == reference.fir.offset) &&
+         (restored.workloadState.fir.accumulator == reference.fir.accumulator) &&
+         (restored.workloadState.fir.sumExtension == reference.fir.sumExtension);
+    HostCheck_Report(ok, "resumed run matches an uninterrupted one", "FIR");
+}
+
+/**
+ * @brief      Scan CRC32 workload units as one chunk
+ */
+static void HostCheck_Crc32Chunk(workloadState_t *state, uint16_t units)
+{
+    const workload_t *workload = &workloadTable[WORKLOAD_CRC32];
+
+    workload->beginChunk(state, units);
+    while (units-- > 0)
+    {
+        workload->doUnit(state);
+    }
+    workload->endChunk(state);
+}
+
+/**
+ * @brief      A CRC32 scan split into chunks, each committed to a checkpoint
+ *             (which borrows the CRC32 module) and resumed from it, signs a
+ *             pass the same as a scan run in one go
+ */
+static void HostCheck_Crc32Resume(void)
+{
+    // Chunks of the split scan, one of them ending right at the end of the
+    // first pass
+    static const uint16_t chunks[HOST_CHECK_CRC32_CHUNKS] = {100, 100, 100, 100, 112, 1};
+    static checkpointStore_t store;
+    const workload_t *workload = &workloadTable[WORKLOAD_CRC32];
+    checkpointingObj_t ctx;
+    workloadState_t reference;
+    uint16_t units = 0;
+    unsigned int i;
+    bool ok = true;
+
+    for (i = 0; i < HOST_CHECK_CRC32_CHUNKS; i++)
+    {
+        units += chunks[i];
+    }
+    workload->init(&reference);
+    HostCheck_Crc32Chunk(&reference, units);
+
+    Checkpointing_Init(&ctx);
+    ctx.workload = WORKLOAD_CRC32;
+    memset(&store, 0, sizeof(store));
+    Checkpoint_Restore(&store, &ctx);
+    workload->init(&ctx.workloadState);
+    for (i = 0; i < HOST_CHECK_CRC32_CHUNKS; i++)
+    {
+        HostCheck_Crc32Chunk(&ctx.workloadState, chunks[i]);
+        ctx.bytesProcessed += (uint64_t)chunks[i] * workload->unitSize;
+        Checkpoint_Commit(&store, &ctx);
+        // Carry on from the checkpoint, as after a reset
+        Checkpointing_Init(&ctx);
+        ok = ok && Checkpoint_Restore(&store, &ctx);
+    }
+
+    ok = ok && (reference.crc32.offset == (WORKLOAD_SCAN_REGION_SIZE + workload->unitSize)) &&
+         (ctx.workloadState.crc32.offset == reference.crc32.offset) &&
+         (ctx.workloadState.crc32.passSignature == reference.crc32.passSignature) &&
+         (ctx.workloadState.crc32.signature == reference.crc32.signature);
+    HostCheck_Report(ok, "scan split across checkpoints signs a pass the same as in one go", "CRC32");
+}
+
+/**
+ * @brief      Work out an arm's UCB1 bonus, sqrt(2 ln n / pulls) in 1/4096
+ *             with ln n taken as (epoch + 1) ln 2, the way the policy does
+ */
+static uint32_t HostCheck_BanditBonus(uint8_t epoch, uint32_t pulls)
+{
+    uint64_t square = (((uint64_t)epoch + 1) * 177 << 17) / pulls;
+    uint32_t root = 0;
+
+    while (((uint64_t)(root + 1) * (root + 1)) <= square)
+    {
+        root++;
+    }
+
+    return root;
+}
+
+/**
+ * @brief      The bandit policy settles on the chunk size with the best
+ *             goodput, and works every bonus out again as its pulls double
+ */
+static void HostCheck_Bandit(void)
+{
+    checkpointingObj_t ctx;
+    checkpointingBanditArm_t arms[CHUNK_STATS_BUCKETS];
+    uint32_t picks[CHUNK_STATS_BUCKETS] = {0};
+    uint32_t now = 0;
+    uint8_t epoch;
+    bool rescaled = true;
+    bool kept = true;
+    unsigned int chunk;
+    unsigned int i;
+    bool ok;
+
+    Checkpointing_Init(&ctx);
+    ctx.policy = WORKLOAD_SCALING_BANDIT;
+    for (chunk = 0; chunk < HOST_CHECK_BANDIT_CHUNKS; chunk++)
+    {
+        // Each chunk costs a fixed overhead plus 1 us a byte. Chunks over
+        // 256 B always lose power, so arm 2 has the best goodput by far.
+        ctx.chunkBytesRun = ctx.currentChunkSize;
+        ctx.chunkMicroseconds = HOST_CHECK_BANDIT_OVERHEAD + ctx.currentChunkSize;
+        ctx.powerLoss = (ctx.currentChunkSize > 256);
+        now += ctx.chunkMicroseconds;
+        ctx.chunkEndMicroseconds = now;
+        now += HOST_CHECK_BANDIT_GAP;
+
+        memcpy(arms, ctx.banditArms, sizeof(arms));
+        epoch = ctx.banditEpoch;
+        Checkpointing_ExecutePolicy(&ctx);
+        picks[ctx.banditArm]++;
+
+        for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+        {
+            if (ctx.banditArms[i].pulls == 0)
+            {
+                continue;
+            }
+            if (ctx.banditEpoch != epoch)
+            {
+                // Pulls doubled: every arm's bonus is worked out for the new n
+                rescaled = rescaled &&
+                           (ctx.banditArms[i].bonusQ12 == HostCheck_BanditBonus(ctx.banditEpoch,
+                                                                                ctx.banditArms[i].pulls));
+            }
+            else if (ctx.banditArms[i].pulls == arms[i].pulls)
+            {
+                // In between, arms that weren't rewarded keep theirs
+                kept = kept && (ctx.banditArms[i].bonusQ12 == arms[i].bonusQ12);
+            }
+        }
+    }
+
+    // The first chunk ran before any arm was picked, and the last one's
+    // reward waits for the chunk after it
+    ok = (ctx.banditPulls == (HOST_CHECK_BANDIT_CHUNKS - 2)) &&
+         (ctx.banditEpoch == HOST_CHECK_BANDIT_EPOCH);
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        ok = ok && ((i == 2) || (picks[i] < picks[2]));
+    }
+    ok = ok && ((picks[2] * 100) >= (HOST_CHECK_BANDIT_CHUNKS * HOST_CHECK_BANDIT_SHARE));
+    HostCheck_Report(ok, "pulls concentrate on the arm with the best goodput", "bandit");
+    HostCheck_Report(rescaled && kept, "bonuses are worked out again when the pulls double", "bandit");
+}
+
+/**
+ * @brief      Commit a fixture instance's progress
+ */
+static void HostCheck_CommitBytes(checkpointStore_t *store, checkpointingObj_t *ctx, uint64_t bytes)
+{
+    ctx->bytesProcessed = bytes;
+    ctx->workloadState.stream.offset = bytes;
+    Checkpoint_Commit(store, ctx);
+}
+
+/**
+ * @brief      Restore a store into a fresh instance
+ *
+ * @return     Bytes the restored checkpoint had done, 0 if none was restored
+ */
+static uint64_t HostCheck_RestoredBytes(checkpointStore_t *store)
+{
+    checkpointingObj_t restored;
+
+    Checkpointing_Init(&restored);
+
+    return Checkpoint_Restore(store, &restored) ? restored.bytesProcessed : 0;
+}
+
+/**
+ * @brief      The double-buffered slots: the newer commit wins wherever it
+ *             was written and across the sequence's wrap, and a torn one
+ *             gives way to the other
+ */
+static void HostCheck_CheckpointSlots(void)
+{
+    static checkpointStore_t store;
+    checkpointingObj_t committed;
+    bool ok;
+
+    Checkpointing_Init(&committed);
+    memset(&store, 0, sizeof(store));
+    Checkpoint_Restore(&store, &committed);
+
+    // Sequence 1 in slot 1, then 2 in slot 0 and 3 in slot 1 again
+    HostCheck_CommitBytes(&store, &committed, 1024);
+    HostCheck_CommitBytes(&store, &committed, 2048);
+    ok = (HostCheck_RestoredBytes(&store) == 2048);
+    HostCheck_CommitBytes(&store, &committed, 3072);
+    ok = ok && (HostCheck_RestoredBytes(&store) == 3072);
+    HostCheck_Report(ok, "slot with the higher sequence is restored", "checkpoint");
+
+    // The newest slot cut short by a brown-out
+    store.slots[1].state.bytesProcessed ^= 0x100;
+    ok = (HostCheck_RestoredBytes(&store) == 2048) && (store.nextSequence == 3);
+    HostCheck_Report(ok, "slot failing its CRC gives way to the older one", "checkpoint");
+
+    // From 0xFFFFFFFF to 0
+    store.nextSequence = 0xFFFFFFFFUL;
+    HostCheck_CommitBytes(&store, &committed, 4096);
+    HostCheck_CommitBytes(&store, &committed, 5120);
+    ok = (store.slots[0].sequence == 0) && (HostCheck_RestoredBytes(&store) == 5120) && (store.nextSequence == 1);
+    HostCheck_Report(ok, "sequence wrapping to 0 is newer", "checkpoint");
+}
+
+/**
+ * @brief      Check two cipher streams are at the same place
+ */
+static bool HostCheck_SameStream(const cipherStream_t *stream, const cipherStream_t *reference)
+{
+    return (stream->mode == reference->mode) && (stream->offset == reference->offset) &&
+           (memcmp(stream->chain, reference->chain, sizeof(stream->chain)) == 0);
+}
+
+/**
+ * @brief      A just-in-time snapshot is applied on top of the commit its
+ *             chunk started from, and only that one
+ */
+static void HostCheck_CheckpointJit(void)
+{
+    static checkpointStore_t store;
+    const workload_t *workload = &workloadTable[WORKLOAD_AES];
+    checkpointingObj_t committed;
+    checkpointingObj_t restored;
+    workloadState_t reference;
+    bool ok;
+
+    // The end of a previous run, then the start of a fresh one
+    Checkpointing_Init(&committed);
+    committed.commitMode = COMMIT_MODE_JIT;
+    memset(&store, 0, sizeof(store));
+    Checkpoint_Restore(&store, &committed);
+    committed.bytesProcessed = 4096;
+    committed.workloadState.stream.offset = committed.bytesProcessed;
+    Checkpoint_Commit(&store, &committed);
+    committed.bytesProcessed = 0;
+    workload->init(&committed.workloadState);
+    Checkpoint_Commit(&store, &committed);
+
+    // A power loss in its first chunk, after three units
+    Checkpoint_CommitJit(&store, 3);
+    reference = committed.workloadState;
+    workload->advance(&reference, 3);
+    Checkpointing_Init(&restored);
+    ok = Checkpoint_Restore(&store, &restored) &&
+         (restored.bytesProcessed == (3 * workload->unitSize)) &&
+         HostCheck_SameStream(&restored.workloadState.stream, &reference.stream);
+    HostCheck_Report(ok, "snapshot of the newest commit is applied", "checkpoint");
+
+    // A snapshot taken on top of the previous commit
+    store.jit.sequence--;
+    Checkpointing_Init(&restored);
+    ok = Checkpoint_Restore(&store, &restored) && (restored.bytesProcessed == 0) &&
+         HostCheck_SameStream(&restored.workloadState.stream, &committed.workloadState.stream);
+    HostCheck_Report(ok, "snapshot of an older commit is ignored", "checkpoint");
+}
+
+/**
+ * @brief      Fill the trace with a previous run, then a run of the replay
+ *             offsets from a sync pulse at syncMicroseconds
+ */
+static void HostCheck_ReplayTrace(uint32_t syncMicroseconds)
+{
+    traceRecord_t *record;
+    uint16_t i;
+
+    memset(&traceRing, 0, sizeof(traceRing));
+    for (i = 0; i < (HOST_CHECK_REPLAY_LOSSES + 4); i++)
+    {
+        record = &traceRing.records[traceRing.count++];
+        if (i == 1)
+        {
+            record->flags = TRACE_FLAG_RUN_START;
+        }
+        record->timestampMicroseconds = 1000 + (i * 3000);
+    }
+    record = &traceRing.records[traceRing.count++];
+    record->timestampMicroseconds = syncMicroseconds;
+    record = &traceRing.records[traceRing.count++];
+    record->timestampMicroseconds = syncMicroseconds + 50;
+    record->flags = TRACE_FLAG_RUN_START;
+    for (i = 0; i < HOST_CHECK_REPLAY_LOSSES; i++)
+    {
+        record = &traceRing.records[traceRing.count++];
+        record->timestampMicroseconds = syncMicroseconds + hostCheckReplayOffsets[i];
+        record->flags = TRACE_FLAG_ABORTED_WORK;
+    }
+    traceRing.head = traceRing.count;
+    traceRing.totalRecords = traceRing.count;
+}
+
+/**
+ * @brief      A trace replayed on Timer_B0 signals its power losses at their
+ *             recorded offsets from the sync pulse, and a trace that lost its
+ *             run start isn't replayed
+ */
+static void HostCheck_Replay(void)
+{
+    uint32_t expected[HOST_CHECK_REPLAY_LOSSES + 1];
+    uint32_t fired[HOST_CHECK_REPLAY_LOSSES + 1] = {0};
+    uint64_t start;
+    uint64_t end;
+    uint32_t seen = 0;
+    uint16_t i;
+    bool ok;
+
+    // The sync pulse comes after the lead, the rest at their offsets from it
+    expected[0] = REPLAY_SYNC_LEAD_MICROSECONDS;
+    for (i = 0; i < HOST_CHECK_REPLAY_LOSSES; i++)
+    {
+        expected[i + 1] = REPLAY_SYNC_LEAD_MICROSECONDS + hostCheckReplayOffsets[i];
+    }
+
+    HostCheck_ReplayTrace(0xFFFF0000UL);
+    ok = (Replay_LoadFromTrace() == (HOST_CHECK_REPLAY_LOSSES + 1));
+    HostCheck_Report(ok, "last run in the trace loads", "replay");
+
+    // On a held clock, stepped a Timer_B0 tick at a time
+    Checkpointing_Init(&checkpointingObj);
+    HostCpu_HoldClock(true);
+    start = HostCpu_GetCycles();
+    end = start + ((expected[HOST_CHECK_REPLAY_LOSSES] + 1) * HOST_CHECK_REPLAY_TICK_CYCLES);
+    Replay_Start();
+    // Let the store that starts the counter land before the clock moves on
+    __no_operation();
+    while ((seen <= HOST_CHECK_REPLAY_LOSSES) && (HostCpu_GetCycles() < end))
+    {
+        HostCpu_StepClock(HOST_CHECK_REPLAY_TICK_CYCLES);
+        if (checkpointingObj.powerLossCount > seen)
+        {
+            fired[seen++] = (uint32_t)((HostCpu_GetCycles() - start) / HOST_CHECK_REPLAY_TICK_CYCLES);
+        }
+    }
+    Replay_Stop();
+    HostCpu_HoldClock(false);
+
+    ok = (seen == (HOST_CHECK_REPLAY_LOSSES + 1)) && (checkpointingObj.powerLossCount == seen);
+    for (i = 0; i <= HOST_CHECK_REPLAY_LOSSES; i++)
+    {
+        ok = ok && (fired[i] == expected[i]);
+    }
+    HostCheck_Report(ok, "power losses are signalled at their recorded offsets", "replay");
+
+    // The ring wrapped over the run start and only power losses are left
+    memset(&traceRing, 0, sizeof(traceRing));
+    for (i = 0; i < TRACE_RING_SIZE; i++)
+    {
+        traceRing.records[i].timestampMicroseconds = i * 1000;
+    }
+    traceRing.count = TRACE_RING_SIZE;
+    traceRing.totalRecords = TRACE_RING_SIZE + 2;
+    ok = (Replay_LoadFromTrace() == 0);
+    HostCheck_Report(ok, "trace that lost its run start isn't loaded", "replay");
+}
+
+int main(void)
+{
+    HostCpu_Init(1);
+    __enable_interrupt();
+    Cipher_SetKey(hostCheckKey);
+
+    HostCheck_DmaEngine(CIPHER_MODE_ECB);
+    HostCheck_DmaEngine(CIPHER_MODE_CBC);
+    HostCheck_BlockingRuns();
+    HostCheck_AdcBatch();
+    HostCheck_CheckpointRoundTrip();
+    HostCheck_CheckpointSlots();
+    HostCheck_CheckpointJit();
+    HostCheck_Replay();
+    HostCheck_FirResume();
+    HostCheck_Crc32Resume();
+    HostCheck_Predictive();
+    HostCheck_Bandit();
+
+    printf("%u check%s failed\n", hostCheckFailures, (hostCheckFailures == 1) ? "" : "s");
+
+    return (hostCheckFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Host CPU model: the MCLK cycle counter, the global interrupt enable and
+ * interrupt dispatch into the fixture's real service routines.
+ *
+ * Board time is derived from the host's monotonic clock, optionally sped up
+ * by a time scale factor so that dead-times and power-loss periods compress.
+ * A check can hold the clock instead and step it by hand, so peripherals
+ * raise their interrupts at exact cycle counts whatever the host is doing.
+ * The model is not thread safe; interrupts raised from signal handlers (see
+ * host_board.c) go through HostCpu_ServiceFromSignal().
+ *
+ * Low-power modes only stop the CPU: the model keeps servicing the
+ * peripherals until a service routine clears CPUOFF on its exit.
+ */
+
+#include <signal.h>
+#include <time.h>
+
+#include "host_cpu.h"
+#include "host_regs.h"
+
+static uint64_t hostCpuStartNs;
+static uint32_t hostCpuTimeScale = 1;
+static bool hostCpuGie;
+static bool hostCpuInIsr;
+static volatile sig_atomic_t hostCpuOff;
+static volatile sig_atomic_t hostCpuLockDepth;
+// Cycle count while the clock is held
+static bool hostCpuClockHeld;
+static uint64_t hostCpuHeldCycles;
+
+static uint64_t HostCpu_MonotonicNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief      Power on the CPU model
+ *
+ * @param[in]  timeScale  How many board microseconds pass per host microsecond
+ */
+void HostCpu_Init(uint32_t timeScale)
+{
+    hostCpuStartNs = HostCpu_MonotonicNs();
+    hostCpuTimeScale = (timeScale == 0) ? 1 : timeScale;
+    hostCpuGie = false;
+    hostCpuInIsr = false;
+    hostCpuOff = false;
+}
+
+/**
+ * @brief      Get the number of MCLK cycles since power on
+ */
+uint64_t HostCpu_GetCycles(void)
+{
+    uint64_t elapsedNs;
+
+    if (hostCpuClockHeld)
+    {
+        return hostCpuHeldCycles;
+    }
+    elapsedNs = HostCpu_MonotonicNs() - hostCpuStartNs;
+
+    return (elapsedNs * hostCpuTimeScale * (HOST_MCLK_HZ / 1000000ULL)) / 1000ULL;
+}
+
+/**
+ * @brief      Stop the cycle counter following the host's clock, or let it
+ *             follow it again from where it was held
+ *
+ * @param[in]  hold  Whether to hold the clock
+ */
+void HostCpu_HoldClock(bool hold)
+{
+    uint64_t cycles = HostCpu_GetCycles();
+
+    if (hold)
+    {
+        hostCpuHeldCycles = cycles;
+    }
+    else
+    {
+        hostCpuStartNs = HostCpu_MonotonicNs() -
+                         ((cycles * 1000ULL) / (hostCpuTimeScale * (HOST_MCLK_HZ / 1000000ULL)));
+    }
+    hostCpuClockHeld = hold;
+}
+
+/**
+ * @brief      Move a held clock on, letting the peripherals catch up and
+ *             their interrupts run
+ *
+ * @param[in]  cycles  MCLK cycles to move on by
+ */
+void HostCpu_StepClock(uint32_t cycles)
+{
+    hostCpuHeldCycles += cycles;
+    HostCpu_Nop();
+}
+
+void HostCpu_Lock(void)
+{
+    hostCpuLockDepth++;
+}
+
+void HostCpu_Unlock(void)
+{
+    hostCpuLockDepth--;
+}
+
+bool HostCpu_IsLocked(void)
+{
+    return (hostCpuLockDepth != 0);
+}
+
+/**
+ * @brief      Let the peripherals catch up and run any pending interrupt
+ *             service routines. Must be called with the model locked.
+ */
+void HostCpu_Service(void)
+{
+    int vector;
+
+    for (;;)
+    {
+        HostRegs_Service();
+
+        // Interrupts are disabled inside a service routine, as on the MSP430
+        if (!hostCpuGie || hostCpuInIsr)
+        {
+            return;
+        }
+        vector = HostRegs_PendingVector();
+        if ((vector < 0) || (hostVectorTable[vector] == 0))
+        {
+            return;
+        }
+
+        hostCpuInIsr = true;
+        hostVectorTable[vector]();
+        HostRegs_Flush();
+        hostCpuInIsr = false;
+    }
+}
+
+/**
+ * @brief      Service the model from a signal handler. If the interrupted code
+ *             is inside the model, the work is picked up on its next access.
+ */
+void HostCpu_ServiceFromSignal(void)
+{
+    hostRegsAccess_t interrupted;
+
+    if (hostCpuLockDepth != 0)
+    {
+        return;
+    }
+
+    HostCpu_Lock();
+    HostRegs_Suspend(&interrupted);
+    HostCpu_Service();
+    HostRegs_Resume(&interrupted);
+    HostCpu_Unlock();
+}
+
+/*
+ * Intrinsics
+ */
+void HostCpu_EnableInterrupts(void)
+{
+    HostCpu_Lock();
+    hostCpuGie = true;
+    HostRegs_Flush();
+    HostCpu_Service();
+    HostCpu_Unlock();
+}
+
+void HostCpu_DisableInterrupts(void)
+{
+    hostCpuGie = false;
+}
+
+unsigned short HostCpu_GetInterruptState(void)
+{
+    return hostCpuGie ? GIE : 0;
+}
+
+void HostCpu_SetInterruptState(unsigned short state)
+{
+    if ((state & GIE) != 0)
+    {
+        HostCpu_EnableInterrupts();
+    }
+    else
+    {
+        HostCpu_DisableInterrupts();
+    }
+}
+
+void HostCpu_Nop(void)
+{
+    HostCpu_Lock();
+    HostRegs_Flush();
+    HostCpu_Service();
+    HostCpu_Unlock();
+}
+
+void HostCpu_SetStatusBits(uint16_t bits)
+{
+    // Sleep first, so a service routine that runs as interrupts come on
+    // wakes the CPU up
+    if ((bits & CPUOFF) != 0)
+    {
+        hostCpuOff = true;
+    }
+    if ((bits & GIE) != 0)
+    {
+        HostCpu_EnableInterrupts();
+    }
+    while (hostCpuOff)
+    {
+        HostCpu_Nop();
+    }
+}
+
+void HostCpu_ClearStatusBitsOnExit(uint16_t bits)
+{
+    if ((bits & CPUOFF) != 0)
+    {
+        hostCpuOff = false;
+    }
+}
+
+void HostCpu_DelayCycles(uint32_t cycles)
+{
+    uint64_t end = HostCpu_GetCycles() + cycles;
+
+    // A held clock only moves on when told to, so move it on
+    if (hostCpuClockHeld)
+    {
+        HostCpu_StepClock(cycles);
+    }
+    while (HostCpu_GetCycles() < end)
+    {
+        HostCpu_Nop();
+    }
+}
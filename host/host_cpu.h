@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef HOST_CPU_H
+#define HOST_CPU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// MCLK = SMCLK = DCO, as configured by Clock_Init()
+#define HOST_MCLK_HZ            (16000000ULL)
+#define HOST_ACLK_HZ            (32768ULL)
+
+typedef void (*hostIsr_t)(void);
+
+// Provided by the build (host_vectors.c), indexed by the *_VECTOR numbers
+extern const hostIsr_t hostVectorTable[];
+
+void HostCpu_Init(uint32_t timeScale);
+uint64_t HostCpu_GetCycles(void);
+void HostCpu_HoldClock(bool hold);
+void HostCpu_StepClock(uint32_t cycles);
+void HostCpu_Lock(void);
+void HostCpu_Unlock(void);
+bool HostCpu_IsLocked(void);
+void HostCpu_Service(void);
+void HostCpu_ServiceFromSignal(void);
+
+#endif // HOST_CPU_H
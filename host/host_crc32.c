@@ -0,0 +1,166 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * CRC32 module model, CRC32 mode only. The signature lives in CRC32INIRESW0/1
+ * like on the device, so a seed written there is picked up by the next data
+ * write. Each 16-bit write to CRC32DIW0/1 feeds its low byte then its high
+ * byte into the CRC-32 (ISO 3309) polynomial, bits LSB first; CRC32DIRBW0/1
+ * take the bits in the reverse order. CRC32RESRW0/1 read back the signature
+ * bit-reversed. Byte writes to the data registers are not told apart from
+ * word writes, and the CRC16 registers are plain memory.
+ */
+
+#include <stddef.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+
+#define HOST_CRC32_SIZE         (0x20)
+#define HOST_CRC32_POLYNOMIAL   (0x04C11DB7UL)
+
+static uint8_t HostCrc32_Reverse8(uint8_t value)
+{
+    uint8_t result = 0;
+    unsigned int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        result = (uint8_t)((result << 1) | ((value >> i) & 1));
+    }
+
+    return result;
+}
+
+static uint32_t HostCrc32_Reverse32(uint32_t value)
+{
+    return ((uint32_t)HostCrc32_Reverse8((uint8_t)value) << 24) |
+           ((uint32_t)HostCrc32_Reverse8((uint8_t)(value >> 8)) << 16) |
+           ((uint32_t)HostCrc32_Reverse8((uint8_t)(value >> 16)) << 8) |
+           (uint32_t)HostCrc32_Reverse8((uint8_t)(value >> 24));
+}
+
+static uint32_t HostCrc32_GetSignature(void)
+{
+    return ((uint32_t)HostRegs_Read16(CRC32_BASE + OFS_CRC32INIRESW1) << 16) |
+           HostRegs_Read16(CRC32_BASE + OFS_CRC32INIRESW0);
+}
+
+static void HostCrc32_SetSignature(uint32_t signature)
+{
+    HostRegs_Write16(CRC32_BASE + OFS_CRC32INIRESW0, (uint16_t)signature);
+    HostRegs_Write16(CRC32_BASE + OFS_CRC32INIRESW1, (uint16_t)(signature >> 16));
+}
+
+/**
+ * @brief      Feed one byte into the signature, most significant bit first
+ */
+static void HostCrc32_Feed(uint8_t value)
+{
+    uint32_t signature = HostCrc32_GetSignature() ^ ((uint32_t)value << 24);
+    unsigned int i;
+
+    for (i = 0; i < 8; i++)
+    {
+        signature = ((signature & 0x80000000UL) != 0) ?
+                    ((signature << 1) ^ HOST_CRC32_POLYNOMIAL) : (signature << 1);
+    }
+    HostCrc32_SetSignature(signature);
+}
+
+static uint8_t HostCrc32_RegFlags(uint16_t offset)
+{
+    switch (offset)
+    {
+        case OFS_CRC32DIW0:
+        case OFS_CRC32DIW1:
+        case OFS_CRC32DIRBW0:
+        case OFS_CRC32DIRBW1:
+        {
+            return HOST_REG_WRITE_FIFO;
+        }
+        default:
+        {
+            return HOST_REG_PLAIN;
+        }
+    }
+}
+
+static void HostCrc32_Read(uint16_t offset)
+{
+    uint32_t reversed;
+
+    switch (offset)
+    {
+        case OFS_CRC32RESRW0:
+        case OFS_CRC32RESRW1:
+        {
+            reversed = HostCrc32_Reverse32(HostCrc32_GetSignature());
+            HostRegs_Write16(CRC32_BASE + OFS_CRC32RESRW0, (uint16_t)(reversed >> 16));
+            HostRegs_Write16(CRC32_BASE + OFS_CRC32RESRW1, (uint16_t)reversed);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+static void HostCrc32_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    switch (offset)
+    {
+        case OFS_CRC32DIW0:
+        case OFS_CRC32DIW1:
+        {
+            HostCrc32_Feed(HostCrc32_Reverse8((uint8_t)newValue));
+            HostCrc32_Feed(HostCrc32_Reverse8((uint8_t)(newValue >> 8)));
+            break;
+        }
+        case OFS_CRC32DIRBW0:
+        case OFS_CRC32DIRBW1:
+        {
+            HostCrc32_Feed((uint8_t)(newValue >> 8));
+            HostCrc32_Feed((uint8_t)newValue);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+const hostPeripheral_t hostCrc32 =
+{
+    "CRC32",
+    CRC32_BASE,
+    HOST_CRC32_SIZE,
+    HostCrc32_RegFlags,
+    HostCrc32_Read,
+    HostCrc32_Write,
+    NULL,
+    NULL,
+};
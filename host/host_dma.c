@@ -0,0 +1,314 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+/*
+ * DMA controller model, channels 0 to 5. A channel latches its source,
+ * destination and size when DMAEN is set and moves one unit per trigger
+ * (single transfer) or the whole block per trigger (block and burst-block
+ * transfer); the repeated modes start over once the block is done. Peripheral
+ * triggers are taken as level requests, one unit each time the peripheral
+ * still asks for data, one unit per service so an interrupt can land between
+ * the words of an AES block. Only DMAREQ, the AES triggers and the ADC12 trigger
+ * are wired up.
+ *
+ * Addresses below the register file go through the peripheral models. Any
+ * other address is taken as a host address, which is why the host build is
+ * linked without PIE: the fixture's buffers are static and their addresses
+ * fit the 32 bits the channel's address registers hold here (20 on the
+ * device).
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+
+#define HOST_DMA_SIZE           (0x70)
+#define HOST_DMA_NUM_CHANNELS   (6)
+#define HOST_DMA_CHANNEL_STRIDE (0x10)
+#define HOST_DMA_TSEL_MASK      (0x1F)
+// Trigger inputs of the MSP430FR5994
+#define HOST_DMA_TRIGGER_DMAREQ (0)
+#define HOST_DMA_TRIGGER_AES0   (11)
+#define HOST_DMA_TRIGGER_AES1   (12)
+#define HOST_DMA_TRIGGER_ADC12  (26)
+
+typedef struct
+{
+    // Latched when DMAEN is set
+    uint32_t sourceAddress;
+    uint32_t destinationAddress;
+    uint16_t size;
+    // Current transfer
+    uint32_t source;
+    uint32_t destination;
+    uint16_t remaining;
+} hostDmaChannel_t;
+
+static hostDmaChannel_t hostDmaChannels[HOST_DMA_NUM_CHANNELS];
+
+static uint16_t HostDma_ChannelReg(uint8_t channel, uint16_t offset)
+{
+    return DMA_BASE + (channel * HOST_DMA_CHANNEL_STRIDE) + offset;
+}
+
+static uint32_t HostDma_ReadAddress(uint16_t address)
+{
+    return ((uint32_t)HostRegs_Read16(address + 2) << 16) | HostRegs_Read16(address);
+}
+
+static uint8_t HostDma_TriggerSelect(uint8_t channel)
+{
+    uint16_t tsel = HostRegs_Read16(DMA_BASE + OFS_DMACTL0 + ((channel / 2) * 2));
+
+    return (uint8_t)((tsel >> ((channel & 1) * 8)) & HOST_DMA_TSEL_MASK);
+}
+
+/**
+ * @brief      Check whether a channel's trigger is asking for a transfer
+ */
+static bool HostDma_Triggered(uint8_t channel, uint16_t ctl)
+{
+    switch (HostDma_TriggerSelect(channel))
+    {
+        case HOST_DMA_TRIGGER_DMAREQ:
+        {
+            return ((ctl & DMAREQ) != 0);
+        }
+        case HOST_DMA_TRIGGER_AES0:
+        {
+            return HostAes_DmaTrigger(0);
+        }
+        case HOST_DMA_TRIGGER_AES1:
+        {
+            return HostAes_DmaTrigger(1);
+        }
+        case HOST_DMA_TRIGGER_ADC12:
+        {
+            return HostAdc12_DmaTrigger();
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+static uint16_t HostDma_Load(uint32_t address, bool byte)
+{
+    uint16_t value = 0;
+
+    if (address < HOST_REGS_SIZE)
+    {
+        value = HostRegs_BusRead16((uint16_t)address);
+        return byte ? (uint8_t)(value >> ((address & 1) * 8)) : value;
+    }
+
+    memcpy(&value, (const void *)(uintptr_t)address, byte ? 1 : 2);
+
+    return value;
+}
+
+static void HostDma_Store(uint32_t address, uint16_t value, bool byte)
+{
+    uint16_t word;
+
+    if (address < HOST_REGS_SIZE)
+    {
+        if (byte)
+        {
+            word = HostRegs_Read16((uint16_t)(address & ~1));
+            word &= (uint16_t)~(0xFF << ((address & 1) * 8));
+            word |= (uint16_t)((value & 0xFF) << ((address & 1) * 8));
+            HostRegs_BusWrite16((uint16_t)address, word);
+        }
+        else
+        {
+            HostRegs_BusWrite16((uint16_t)address, value);
+        }
+        return;
+    }
+
+    memcpy((void *)(uintptr_t)address, &value, byte ? 1 : 2);
+}
+
+static uint32_t HostDma_Step(uint32_t address, uint16_t increment, bool byte)
+{
+    switch (increment)
+    {
+        case 3:
+            return address + (byte ? 1 : 2);
+        case 2:
+            return address - (byte ? 1 : 2);
+        default:
+            return address;
+    }
+}
+
+/**
+ * @brief      Move one unit on a channel and finish the block if it was the
+ *             last one
+ */
+static void HostDma_Transfer(uint8_t channel)
+{
+    hostDmaChannel_t *dma = &hostDmaChannels[channel];
+    uint16_t ctlAddress = HostDma_ChannelReg(channel, OFS_DMA0CTL);
+    uint16_t ctl = HostRegs_Read16(ctlAddress);
+    bool sourceByte = ((ctl & DMASRCBYTE) != 0);
+    bool destinationByte = ((ctl & DMADSTBYTE) != 0);
+
+    HostDma_Store(dma->destination, HostDma_Load(dma->source, sourceByte), destinationByte);
+    dma->source = HostDma_Step(dma->source, (ctl >> 8) & 3, sourceByte);
+    dma->destination = HostDma_Step(dma->destination, (ctl >> 10) & 3, destinationByte);
+    dma->remaining--;
+    HostRegs_Write16(HostDma_ChannelReg(channel, OFS_DMA0SZ), dma->remaining);
+
+    if (dma->remaining != 0)
+    {
+        return;
+    }
+
+    // Block done: DMAxSZ reloads, and DMAEN clears unless the mode repeats
+    ctl = HostRegs_Read16(ctlAddress) | DMAIFG;
+    if ((ctl & DMADT_4) == 0)
+    {
+        ctl &= ~DMAEN;
+    }
+    HostRegs_Write16(ctlAddress, ctl);
+    dma->source = dma->sourceAddress;
+    dma->destination = dma->destinationAddress;
+    dma->remaining = dma->size;
+    HostRegs_Write16(HostDma_ChannelReg(channel, OFS_DMA0SZ), dma->size);
+}
+
+static void HostDma_Service(void)
+{
+    uint16_t ctl;
+    uint8_t channel;
+
+    // Channel 0 has the highest priority. One trigger is served at a time,
+    // the CPU (and its interrupts) get a look in between single transfers.
+    for (channel = 0; channel < HOST_DMA_NUM_CHANNELS; channel++)
+    {
+        ctl = HostRegs_Read16(HostDma_ChannelReg(channel, OFS_DMA0CTL));
+        if (((ctl & DMAEN) == 0) || (hostDmaChannels[channel].remaining == 0) ||
+            !HostDma_Triggered(channel, ctl))
+        {
+            continue;
+        }
+
+        HostRegs_Write16(HostDma_ChannelReg(channel, OFS_DMA0CTL), ctl & ~DMAREQ);
+        if ((ctl & (DMADT_1 | DMADT_2)) != 0)
+        {
+            do
+            {
+                HostDma_Transfer(channel);
+            } while (hostDmaChannels[channel].remaining != hostDmaChannels[channel].size);
+        }
+        else
+        {
+            HostDma_Transfer(channel);
+        }
+        break;
+    }
+}
+
+static void HostDma_Read(uint16_t offset)
+{
+    uint16_t ctlAddress;
+    uint16_t ctl;
+    uint8_t channel;
+
+    if (offset != OFS_DMAIV)
+    {
+        return;
+    }
+
+    // Reading DMAIV hands out and clears the highest priority flag
+    HostRegs_Write16(DMA_BASE + OFS_DMAIV, 0);
+    for (channel = 0; channel < HOST_DMA_NUM_CHANNELS; channel++)
+    {
+        ctlAddress = HostDma_ChannelReg(channel, OFS_DMA0CTL);
+        ctl = HostRegs_Read16(ctlAddress);
+        if (((ctl & DMAIFG) != 0) && ((ctl & DMAIE) != 0))
+        {
+            HostRegs_Write16(ctlAddress, ctl & ~DMAIFG);
+            HostRegs_Write16(DMA_BASE + OFS_DMAIV, (channel + 1) * 2);
+            break;
+        }
+    }
+}
+
+static void HostDma_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    hostDmaChannel_t *dma;
+    uint8_t channel;
+
+    if ((offset < OFS_DMA0CTL) || (((offset - OFS_DMA0CTL) % HOST_DMA_CHANNEL_STRIDE) != 0))
+    {
+        return;
+    }
+
+    // Setting DMAEN latches the channel's addresses and size
+    channel = (offset - OFS_DMA0CTL) / HOST_DMA_CHANNEL_STRIDE;
+    dma = &hostDmaChannels[channel];
+    if (((newValue & DMAEN) != 0) && ((oldValue & DMAEN) == 0))
+    {
+        dma->sourceAddress = HostDma_ReadAddress(HostDma_ChannelReg(channel, OFS_DMA0SA));
+        dma->destinationAddress = HostDma_ReadAddress(HostDma_ChannelReg(channel, OFS_DMA0DA));
+        dma->size = HostRegs_Read16(HostDma_ChannelReg(channel, OFS_DMA0SZ));
+        dma->source = dma->sourceAddress;
+        dma->destination = dma->destinationAddress;
+        dma->remaining = dma->size;
+    }
+}
+
+static int HostDma_PendingVector(void)
+{
+    uint16_t ctl;
+    uint8_t channel;
+
+    for (channel = 0; channel < HOST_DMA_NUM_CHANNELS; channel++)
+    {
+        ctl = HostRegs_Read16(HostDma_ChannelReg(channel, OFS_DMA0CTL));
+        if (((ctl & DMAIFG) != 0) && ((ctl & DMAIE) != 0))
+        {
+            return DMA_VECTOR;
+        }
+    }
+
+    return -1;
+}
+
+const hostPeripheral_t hostDma =
+{
+    "DMA",
+    DMA_BASE,
+    HOST_DMA_SIZE,
+    NULL,
+    HostDma_Read,
+    HostDma_Write,
+    HostDma_Service,
+    HostDma_PendingVector,
+};
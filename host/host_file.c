@@ -0,0 +1,140 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "file.h"
+
+#define HOST_FILE_MAX_DEVICES   (4)
+#define HOST_FILE_NAME_LENGTH   (8)
+
+typedef struct
+{
+    char name[HOST_FILE_NAME_LENGTH + 1];
+    int (*dopen)(const char *path, unsigned flags, int llv_fd);
+    int (*dclose)(int dev_fd);
+    int (*dread)(int dev_fd, char *buf, unsigned count);
+    int (*dwrite)(int dev_fd, const char *buf, unsigned count);
+} hostFileDevice_t;
+
+typedef struct
+{
+    const hostFileDevice_t *device;
+    int fd;
+} hostFileStream_t;
+
+static hostFileDevice_t hostFileDevices[HOST_FILE_MAX_DEVICES];
+static unsigned int hostFileNumDevices;
+static hostFileStream_t hostFileStreams[HOST_FILE_MAX_DEVICES * 2];
+static unsigned int hostFileNumStreams;
+
+int add_device(char *name,
+               unsigned flags,
+               int (*dopen)(const char *path, unsigned flags, int llv_fd),
+               int (*dclose)(int dev_fd),
+               int (*dread)(int dev_fd, char *buf, unsigned count),
+               int (*dwrite)(int dev_fd, const char *buf, unsigned count),
+               off_t (*dlseek)(int dev_fd, off_t offset, int origin),
+               int (*dunlink)(const char *path),
+               int (*drename)(const char *old_name, const char *new_name))
+{
+    hostFileDevice_t *device;
+
+    if ((hostFileNumDevices >= HOST_FILE_MAX_DEVICES) || (strlen(name) > HOST_FILE_NAME_LENGTH))
+    {
+        return -1;
+    }
+
+    device = &hostFileDevices[hostFileNumDevices++];
+    strcpy(device->name, name);
+    device->dopen = dopen;
+    device->dclose = dclose;
+    device->dread = dread;
+    device->dwrite = dwrite;
+
+    return 0;
+}
+
+static ssize_t HostFile_CookieRead(void *cookie, char *buf, size_t size)
+{
+    hostFileStream_t *stream = cookie;
+    return stream->device->dread(stream->fd, buf, (unsigned)size);
+}
+
+static ssize_t HostFile_CookieWrite(void *cookie, const char *buf, size_t size)
+{
+    hostFileStream_t *stream = cookie;
+    int written = stream->device->dwrite(stream->fd, buf, (unsigned)size);
+
+    // Text mode drivers count the characters they add (CR before LF), the TI
+    // library treats anything at least as long as the request as complete
+    if (written >= (int)size)
+    {
+        return (ssize_t)size;
+    }
+
+    return written;
+}
+
+static int HostFile_CookieClose(void *cookie)
+{
+    hostFileStream_t *stream = cookie;
+    return stream->device->dclose(stream->fd);
+}
+
+FILE *HostFile_Freopen(const char *path, const char *mode, FILE **stream)
+{
+    cookie_io_functions_t functions = {HostFile_CookieRead, HostFile_CookieWrite, NULL, HostFile_CookieClose};
+    const char *colon = strchr(path, ':');
+    hostFileStream_t *deviceStream;
+    FILE *file;
+    unsigned int i;
+
+    for (i = 0; (colon != NULL) && (i < hostFileNumDevices); i++)
+    {
+        if ((strlen(hostFileDevices[i].name) == (size_t)(colon - path)) &&
+            (strncmp(hostFileDevices[i].name, path, colon - path) == 0))
+        {
+            if (hostFileNumStreams >= (sizeof(hostFileStreams) / sizeof(hostFileStreams[0])))
+            {
+                return NULL;
+            }
+            deviceStream = &hostFileStreams[hostFileNumStreams++];
+            deviceStream->device = &hostFileDevices[i];
+            deviceStream->fd = hostFileDevices[i].dopen(colon + 1, 0, (int)hostFileNumStreams);
+            file = fopencookie(deviceStream, mode, functions);
+            if (file != NULL)
+            {
+                // The original stream stays open underneath, the board model
+                // still talks to the host terminal through its descriptor
+                *stream = file;
+            }
+            return file;
+        }
+    }
+
+    *stream = (freopen)(path, mode, *stream);
+    return *stream;
+}
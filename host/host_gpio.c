@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Digital I/O model for ports P1 to P8. Ports are grouped in pairs sharing a
+ * 16-bit register block, the odd port in the low byte and the even port in the
+ * high byte, exactly like the MSP430 PA to PD registers.
+ *
+ * P8.1 is the power-loss input. An edge on it is requested with
+ * HostGpio_PulsePowerLoss(), which is safe to call from a signal handler.
+ */
+
+#include <signal.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+
+#define HOST_GPIO_BASE          __MSP430_BASEADDRESS_PORT1_R__
+#define HOST_GPIO_NUM_PAIRS     (4)
+#define HOST_GPIO_PAIR_SIZE     (0x20)
+
+// Levels driven onto the pins from outside the chip
+static uint16_t hostGpioExternal[HOST_GPIO_NUM_PAIRS];
+static volatile sig_atomic_t hostGpioPendingPulses;
+
+static uint16_t HostGpio_PairBase(uint8_t pair)
+{
+    return HOST_GPIO_BASE + (pair * HOST_GPIO_PAIR_SIZE);
+}
+
+static void HostGpio_Read(uint16_t offset)
+{
+    uint8_t pair = offset / HOST_GPIO_PAIR_SIZE;
+    uint16_t base = HostGpio_PairBase(pair);
+    uint16_t dir;
+
+    if ((offset % HOST_GPIO_PAIR_SIZE) == OFS_PAIN)
+    {
+        // Outputs read back what is driven, inputs what the outside world drives
+        dir = HostRegs_Read16(base + OFS_PADIR);
+        HostRegs_Write16(base + OFS_PAIN, (HostRegs_Read16(base + OFS_PAOUT) & dir) | (hostGpioExternal[pair] & ~dir));
+    }
+}
+
+static void HostGpio_Service(void)
+{
+    while (hostGpioPendingPulses > 0)
+    {
+        hostGpioPendingPulses--;
+        HostGpio_SetInput(8, 1, false);
+        HostGpio_SetInput(8, 1, true);
+    }
+}
+
+static int HostGpio_PendingVector(void)
+{
+    uint16_t base = HostGpio_PairBase(3);
+
+    // Only port 8 has its vector wired up
+    if ((HostRegs_Read16(base + OFS_PAIFG) & HostRegs_Read16(base + OFS_PAIE) & 0xFF00) != 0)
+    {
+        return PORT8_VECTOR;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief      Drive an input pin from outside the chip
+ *
+ * @param[in]  port   The port number (1 to 8)
+ * @param[in]  pin    The pin number (0 to 7)
+ * @param[in]  level  The new pin level
+ */
+void HostGpio_SetInput(uint8_t port, uint8_t pin, bool level)
+{
+    uint8_t pair = (port - 1) / 2;
+    uint16_t base = HostGpio_PairBase(pair);
+    uint16_t bit = (uint16_t)(1 << pin) << (((port & 1) == 0) ? 8 : 0);
+    bool previous = ((hostGpioExternal[pair] & bit) != 0);
+    bool highToLow = ((HostRegs_Read16(base + OFS_PAIES) & bit) != 0);
+
+    if (previous == level)
+    {
+        return;
+    }
+
+    if (level)
+    {
+        hostGpioExternal[pair] |= bit;
+    }
+    else
+    {
+        hostGpioExternal[pair] &= ~bit;
+    }
+
+    // Latch the interrupt flag on the selected edge
+    if (highToLow != level)
+    {
+        HostRegs_Write16(base + OFS_PAIFG, HostRegs_Read16(base + OFS_PAIFG) | bit);
+    }
+}
+
+/**
+ * @brief      Request a power-loss pulse (high, low, high) on P8.1
+ */
+void HostGpio_PulsePowerLoss(void)
+{
+    hostGpioPendingPulses++;
+}
+
+const hostPeripheral_t hostGpio =
+{
+    "GPIO",
+    HOST_GPIO_BASE,
+    HOST_GPIO_NUM_PAIRS * HOST_GPIO_PAIR_SIZE,
+    NULL,
+    HostGpio_Read,
+    NULL,
+    HostGpio_Service,
+    HostGpio_PendingVector,
+};
@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * MPY32 hardware multiplier model. The operation and the first operand come
+ * from whichever operand one register is written, the 32-bit ones marking the
+ * operand 32 bits wide once their high word is written. Writing OP2, or OP2H
+ * for a 32-bit second operand, does the multiply at once, as if the result
+ * were always ready by the time it's read. Multiplies load RES0..RES3 with
+ * the product; multiply-accumulates add it to what's there, 32 bits wide when
+ * both operands are 16 bits and 64 bits wide otherwise. SUMEXT and MPYC
+ * follow the user's guide. RESLO/RESHI are kept the same as RES0/RES1.
+ * Fractional and saturation modes are not modelled.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+
+#define HOST_MPY32_SIZE         (0x30)
+
+// Operations, in the order of the operand one registers
+typedef enum
+{
+    HOST_MPY32_MPY = 0,
+    HOST_MPY32_MPYS = 1,
+    HOST_MPY32_MAC = 2,
+    HOST_MPY32_MACS = 3,
+} hostMpy32Op_e;
+
+static hostMpy32Op_e hostMpy32Op;
+static uint32_t hostMpy32Op1;
+static bool hostMpy32Op1Is32;
+
+static uint64_t HostMpy32_GetResult(void)
+{
+    return (uint64_t)HostRegs_Read16(MPY32_BASE + OFS_RES0) |
+           ((uint64_t)HostRegs_Read16(MPY32_BASE + OFS_RES1) << 16) |
+           ((uint64_t)HostRegs_Read16(MPY32_BASE + OFS_RES2) << 32) |
+           ((uint64_t)HostRegs_Read16(MPY32_BASE + OFS_RES3) << 48);
+}
+
+static void HostMpy32_SetResult(uint64_t result)
+{
+    HostRegs_Write16(MPY32_BASE + OFS_RES0, (uint16_t)result);
+    HostRegs_Write16(MPY32_BASE + OFS_RES1, (uint16_t)(result >> 16));
+    HostRegs_Write16(MPY32_BASE + OFS_RES2, (uint16_t)(result >> 32));
+    HostRegs_Write16(MPY32_BASE + OFS_RES3, (uint16_t)(result >> 48));
+    HostRegs_Write16(MPY32_BASE + OFS_RESLO, (uint16_t)result);
+    HostRegs_Write16(MPY32_BASE + OFS_RESHI, (uint16_t)(result >> 16));
+}
+
+/**
+ * @brief      Multiply the latched first operand by the second and update
+ *             the result, SUMEXT and MPYC
+ */
+static void HostMpy32_Multiply(uint32_t op2, bool op2Is32)
+{
+    bool isSigned = (hostMpy32Op == HOST_MPY32_MPYS) || (hostMpy32Op == HOST_MPY32_MACS);
+    bool isAccumulate = (hostMpy32Op == HOST_MPY32_MAC) || (hostMpy32Op == HOST_MPY32_MACS);
+    bool is64 = hostMpy32Op1Is32 || op2Is32;
+    uint64_t mask = is64 ? UINT64_MAX : UINT32_MAX;
+    uint64_t product;
+    uint64_t accumulator;
+    uint64_t result;
+    uint16_t sumExtension;
+    uint16_t control;
+    bool carry = false;
+
+    if (isSigned)
+    {
+        int64_t a = hostMpy32Op1Is32 ? (int32_t)hostMpy32Op1 : (int16_t)hostMpy32Op1;
+        int64_t b = op2Is32 ? (int32_t)op2 : (int16_t)op2;
+
+        product = (uint64_t)(a * b);
+    }
+    else
+    {
+        uint64_t a = hostMpy32Op1Is32 ? hostMpy32Op1 : (uint16_t)hostMpy32Op1;
+        uint64_t b = op2Is32 ? op2 : (uint16_t)op2;
+
+        product = a * b;
+    }
+    product &= mask;
+
+    if (isAccumulate)
+    {
+        accumulator = HostMpy32_GetResult() & mask;
+        result = (accumulator + product) & mask;
+        carry = result < accumulator;
+    }
+    else
+    {
+        result = product;
+    }
+
+    if (isSigned)
+    {
+        // The extended sign of the result
+        sumExtension = ((result >> (is64 ? 63 : 31)) != 0) ? 0xFFFF : 0x0000;
+    }
+    else
+    {
+        // The carry of the accumulate, none for a plain multiply
+        sumExtension = carry ? 0x0001 : 0x0000;
+    }
+
+    if (!is64)
+    {
+        // A 16 x 16 multiply leaves the upper half of a 64-bit result alone
+        result |= HostMpy32_GetResult() & ~mask;
+    }
+    HostMpy32_SetResult(result);
+    HostRegs_Write16(MPY32_BASE + OFS_SUMEXT, sumExtension);
+
+    control = HostRegs_Read16(MPY32_BASE + OFS_MPY32CTL0) & ~(MPYC | MPYOP1_32 | MPYOP2_32 | MPYM0 | MPYM1);
+    control |= carry ? MPYC : 0;
+    control |= hostMpy32Op1Is32 ? MPYOP1_32 : 0;
+    control |= op2Is32 ? MPYOP2_32 : 0;
+    control |= (uint16_t)hostMpy32Op << 4;
+    HostRegs_Write16(MPY32_BASE + OFS_MPY32CTL0, control);
+}
+
+static uint8_t HostMpy32_RegFlags(uint16_t offset)
+{
+    // Writing an operand again with the same value is another multiply
+    if ((offset <= OFS_OP2) || ((offset >= OFS_MPY32L) && (offset <= OFS_OP2H)))
+    {
+        return HOST_REG_WRITE_FIFO;
+    }
+
+    return HOST_REG_PLAIN;
+}
+
+static void HostMpy32_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    (void)oldValue;
+
+    switch (offset)
+    {
+        case OFS_MPY:
+        case OFS_MPYS:
+        case OFS_MAC:
+        case OFS_MACS:
+        {
+            hostMpy32Op = (hostMpy32Op_e)(offset / 2);
+            hostMpy32Op1 = newValue;
+            hostMpy32Op1Is32 = false;
+            break;
+        }
+        case OFS_MPY32L:
+        case OFS_MPYS32L:
+        case OFS_MAC32L:
+        case OFS_MACS32L:
+        {
+            hostMpy32Op = (hostMpy32Op_e)((offset - OFS_MPY32L) / 4);
+            hostMpy32Op1 = newValue;
+            hostMpy32Op1Is32 = false;
+            break;
+        }
+        case OFS_MPY32H:
+        case OFS_MPYS32H:
+        case OFS_MAC32H:
+        case OFS_MACS32H:
+        {
+            hostMpy32Op = (hostMpy32Op_e)((offset - OFS_MPY32H) / 4);
+            hostMpy32Op1 = (hostMpy32Op1 & 0xFFFF) | ((uint32_t)newValue << 16);
+            hostMpy32Op1Is32 = true;
+            break;
+        }
+        case OFS_OP2:
+        {
+            HostMpy32_Multiply(newValue, false);
+            break;
+        }
+        case OFS_OP2H:
+        {
+            HostMpy32_Multiply(HostRegs_Read16(MPY32_BASE + OFS_OP2L) | ((uint32_t)newValue << 16), true);
+            break;
+        }
+        case OFS_RESLO:
+        {
+            HostRegs_Write16(MPY32_BASE + OFS_RES0, newValue);
+            break;
+        }
+        case OFS_RESHI:
+        {
+            HostRegs_Write16(MPY32_BASE + OFS_RES1, newValue);
+            break;
+        }
+        case OFS_RES0:
+        {
+            HostRegs_Write16(MPY32_BASE + OFS_RESLO, newValue);
+            break;
+        }
+        case OFS_RES1:
+        {
+            HostRegs_Write16(MPY32_BASE + OFS_RESHI, newValue);
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+const hostPeripheral_t hostMpy32 =
+{
+    "MPY32",
+    MPY32_BASE,
+    HOST_MPY32_SIZE,
+    HostMpy32_RegFlags,
+    NULL,
+    HostMpy32_Write,
+    NULL,
+    NULL,
+};
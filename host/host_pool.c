@@ -0,0 +1,220 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Work-stealing thread pool for independent simulation jobs.
+ *
+ * Jobs are indices into a table the caller set up before HostPool_Run(); each
+ * job must only touch its own fixture instance and simulation.
+ *
+ * Every worker starts with an even slice of the job range in a queue word
+ * packing [top, bottom). The owner takes jobs from the top one at a time; a
+ * worker that runs dry steals the back half of another's range. Both sides
+ * update a queue with a single CAS, so no locks are needed.
+ */
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "host_pool.h"
+
+typedef struct
+{
+    // top in the low half, bottom in the high half
+    _Atomic uint64_t range;
+    // Keep each queue on its own cache line
+    uint8_t padding[64 - sizeof(uint64_t)];
+} hostPoolQueue_t;
+
+#define HOST_POOL_RANGE(top, bottom)    (((uint64_t)(bottom) << 32) | (uint32_t)(top))
+#define HOST_POOL_TOP(range)            ((uint32_t)(range))
+#define HOST_POOL_BOTTOM(range)         ((uint32_t)((range) >> 32))
+
+/**
+ * @brief      Get the number of workers to use by default, one per online core
+ */
+unsigned int HostPool_DefaultWorkers(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return (cores > 0) ? (unsigned int)cores : 1;
+}
+
+/**
+ * @brief      Take the next job from a worker's own queue
+ *
+ * @return     false if the queue is empty
+ */
+static bool HostPool_Take(hostPoolQueue_t *queue, unsigned int *job)
+{
+    uint64_t range = atomic_load(&queue->range);
+
+    while (HOST_POOL_TOP(range) < HOST_POOL_BOTTOM(range))
+    {
+        if (atomic_compare_exchange_weak(&queue->range, &range,
+                                         HOST_POOL_RANGE(HOST_POOL_TOP(range) + 1, HOST_POOL_BOTTOM(range))))
+        {
+            *job = HOST_POOL_TOP(range);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief      Move the back half of another worker's queue into our own
+ *
+ * @return     false if every queue is empty, i.e. there is no work left
+ */
+static bool HostPool_Steal(hostPoolQueue_t *queues, unsigned int numWorkers, unsigned int self)
+{
+    unsigned int i;
+    uint64_t range;
+    uint32_t top;
+    uint32_t bottom;
+    uint32_t split;
+
+    for (i = 1; i < numWorkers; i++)
+    {
+        hostPoolQueue_t *victim = &queues[(self + i) % numWorkers];
+
+        range = atomic_load(&victim->range);
+        for (;;)
+        {
+            top = HOST_POOL_TOP(range);
+            bottom = HOST_POOL_BOTTOM(range);
+            if (top >= bottom)
+            {
+                break;
+            }
+            split = bottom - ((bottom - top + 1) / 2);
+            if (atomic_compare_exchange_weak(&victim->range, &range, HOST_POOL_RANGE(top, split)))
+            {
+                // Our queue is empty, so nobody else touches it
+                atomic_store(&queues[self].range, HOST_POOL_RANGE(split, bottom));
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+typedef struct
+{
+    hostPoolQueue_t *queues;
+    unsigned int numWorkers;
+    unsigned int self;
+    hostPoolJob_t job;
+    void *arg;
+} hostPoolWorker_t;
+
+static void *HostPool_Worker(void *context)
+{
+    hostPoolWorker_t *worker = context;
+    unsigned int next;
+
+    do
+    {
+        while (HostPool_Take(&worker->queues[worker->self], &next))
+        {
+            worker->job(next, worker->arg);
+        }
+    }
+    while (HostPool_Steal(worker->queues, worker->numWorkers, worker->self));
+
+    return NULL;
+}
+
+/**
+ * @brief      Run jobs 0 to numJobs - 1 over a pool of worker threads
+ *
+ * @param[in]  numJobs     Number of jobs
+ * @param[in]  numWorkers  Number of worker threads, 0 for one per core
+ * @param[in]  job         Job function, run in a worker
+ * @param      arg         Passed to every job
+ *
+ * @return     false if no worker could be started
+ */
+bool HostPool_Run(unsigned int numJobs, unsigned int numWorkers, hostPoolJob_t job, void *arg)
+{
+    hostPoolQueue_t *queues;
+    hostPoolWorker_t *workers;
+    pthread_t *threads;
+    unsigned int i;
+    unsigned int started;
+
+    if (numWorkers == 0)
+    {
+        numWorkers = HostPool_DefaultWorkers();
+    }
+    if (numWorkers > numJobs)
+    {
+        numWorkers = (numJobs != 0) ? numJobs : 1;
+    }
+
+    queues = aligned_alloc(sizeof(*queues), numWorkers * sizeof(*queues));
+    workers = calloc(numWorkers, sizeof(*workers));
+    threads = calloc(numWorkers, sizeof(*threads));
+    if ((queues == NULL) || (workers == NULL) || (threads == NULL))
+    {
+        free(queues);
+        free(workers);
+        free(threads);
+        return false;
+    }
+    for (i = 0; i < numWorkers; i++)
+    {
+        atomic_init(&queues[i].range,
+                    HOST_POOL_RANGE(((uint64_t)numJobs * i) / numWorkers,
+                                    ((uint64_t)numJobs * (i + 1)) / numWorkers));
+        workers[i].queues = queues;
+        workers[i].numWorkers = numWorkers;
+        workers[i].self = i;
+        workers[i].job = job;
+        workers[i].arg = arg;
+    }
+
+    for (started = 0; started < numWorkers; started++)
+    {
+        // Whoever did start will steal the missing workers' jobs
+        if (pthread_create(&threads[started], NULL, HostPool_Worker, &workers[started]) != 0)
+        {
+            break;
+        }
+    }
+    for (i = 0; i < started; i++)
+    {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(queues);
+    free(workers);
+    free(threads);
+
+    return (started != 0);
+}
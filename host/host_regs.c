@@ -0,0 +1,292 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Simulated MSP430 peripheral register file.
+ *
+ * HWREGx() hands out a pointer into a plain byte array. Since C gives us no
+ * hook on the store itself, writes are detected lazily: every access first
+ * "commits" the previous one by comparing the register against its value at
+ * the time it was handed out, and then lets the owning peripheral model update
+ * the register the CPU is about to read. FIFO style registers (TXBUF, AESADIN,
+ * ...) report every access, since writing the same value twice matters there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_regs.h"
+#include "host_cpu.h"
+#include "host_board.h"
+
+static const hostPeripheral_t *const hostPeripherals[] =
+{
+    &hostGpio,
+    &hostTimerA0,
+    &hostTimerA1,
+    &hostTimerB0,
+    &hostUartA0,
+    &hostAes,
+    &hostDma,
+    &hostCrc32,
+    &hostMpy32,
+    &hostAdc12,
+};
+#define HOST_NUM_PERIPHERALS (sizeof(hostPeripherals)/sizeof(hostPeripherals[0]))
+
+static uint8_t hostRegs[HOST_REGS_SIZE];
+static hostRegsAccess_t hostRegsPending;
+static uint32_t hostRegsAccessCount;
+
+static const hostPeripheral_t *HostRegs_FindPeripheral(uint16_t address)
+{
+    unsigned int i;
+
+    for (i = 0; i < HOST_NUM_PERIPHERALS; i++)
+    {
+        if ((address >= hostPeripherals[i]->baseAddress) &&
+            (address < (hostPeripherals[i]->baseAddress + hostPeripherals[i]->size)))
+        {
+            return hostPeripherals[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief      Report the previous access to its peripheral if it was a write
+ */
+static void HostRegs_Commit(void)
+{
+    const hostPeripheral_t *peripheral;
+    uint16_t address;
+    uint16_t offset;
+    uint16_t value;
+    uint8_t flags;
+    uint8_t i;
+
+    if (!hostRegsPending.valid)
+    {
+        return;
+    }
+    hostRegsPending.valid = false;
+
+    for (i = 0; i < hostRegsPending.numWords; i++)
+    {
+        address = hostRegsPending.address + (2 * i);
+        peripheral = HostRegs_FindPeripheral(address);
+        if ((peripheral == NULL) || (peripheral->write == NULL))
+        {
+            continue;
+        }
+
+        offset = address - peripheral->baseAddress;
+        flags = (peripheral->regFlags != NULL) ? peripheral->regFlags(offset) : HOST_REG_PLAIN;
+        value = HostRegs_Read16(address);
+
+        if ((flags & HOST_REG_READ_FIFO) != 0)
+        {
+            continue;
+        }
+        if (((flags & HOST_REG_WRITE_FIFO) != 0) || (value != hostRegsPending.value[i]))
+        {
+            peripheral->write(offset, hostRegsPending.value[i], value);
+        }
+    }
+}
+
+volatile void *HostRegs_Access(uint16_t address, uint8_t width)
+{
+    const hostPeripheral_t *peripheral;
+    uint8_t i;
+
+    if ((address + width) > HOST_REGS_SIZE)
+    {
+        fprintf(stderr, "host: register access outside peripheral space (0x%04x)\n", address);
+        abort();
+    }
+
+    HostCpu_Lock();
+
+    // Finish off the previous access, then let time-based state and any
+    // interrupt service routines run before this one
+    HostRegs_Commit();
+    HostCpu_Service();
+    HostRegs_Commit();
+
+    hostRegsPending.address = address & ~1;
+    hostRegsPending.numWords = (width == 4) ? 2 : 1;
+    for (i = 0; i < hostRegsPending.numWords; i++)
+    {
+        peripheral = HostRegs_FindPeripheral(hostRegsPending.address + (2 * i));
+        if ((peripheral != NULL) && (peripheral->read != NULL))
+        {
+            peripheral->read(hostRegsPending.address + (2 * i) - peripheral->baseAddress);
+        }
+        hostRegsPending.value[i] = HostRegs_Read16(hostRegsPending.address + (2 * i));
+    }
+    hostRegsPending.valid = true;
+    hostRegsAccessCount++;
+
+    HostCpu_Unlock();
+
+    return &hostRegs[address];
+}
+
+/**
+ * @brief      Commit any outstanding access (used once the CPU is known to be
+ *             done with it, e.g. after an interrupt service routine)
+ */
+void HostRegs_Flush(void)
+{
+    HostRegs_Commit();
+}
+
+/**
+ * @brief      Set aside the outstanding access of interrupted code. Used when
+ *             an interrupt is delivered asynchronously and the interrupted
+ *             store may not have happened yet.
+ */
+void HostRegs_Suspend(hostRegsAccess_t *saved)
+{
+    *saved = hostRegsPending;
+    hostRegsPending.valid = false;
+}
+
+void HostRegs_Resume(const hostRegsAccess_t *saved)
+{
+    HostRegs_Commit();
+    hostRegsPending = *saved;
+}
+
+/**
+ * @brief      Give every peripheral model a chance to catch up with time
+ */
+void HostRegs_Service(void)
+{
+    unsigned int i;
+
+    for (i = 0; i < HOST_NUM_PERIPHERALS; i++)
+    {
+        if (hostPeripherals[i]->service != NULL)
+        {
+            hostPeripherals[i]->service();
+        }
+    }
+}
+
+/**
+ * @brief      Find the highest priority pending interrupt
+ *
+ * @return     The vector number, or -1 if nothing is pending
+ */
+int HostRegs_PendingVector(void)
+{
+    unsigned int i;
+    int vector;
+
+    for (i = 0; i < HOST_NUM_PERIPHERALS; i++)
+    {
+        if (hostPeripherals[i]->pendingVector != NULL)
+        {
+            vector = hostPeripherals[i]->pendingVector();
+            if (vector >= 0)
+            {
+                return vector;
+            }
+        }
+    }
+
+    return -1;
+}
+
+uint32_t HostRegs_GetAccessCount(void)
+{
+    return hostRegsAccessCount;
+}
+
+/*
+ * Register access by another bus master (the DMA model). Reported to the
+ * owning peripheral straight away, as a CPU access would be.
+ */
+uint16_t HostRegs_BusRead16(uint16_t address)
+{
+    const hostPeripheral_t *peripheral = HostRegs_FindPeripheral(address & ~1);
+
+    if ((peripheral != NULL) && (peripheral->read != NULL))
+    {
+        peripheral->read((address & ~1) - peripheral->baseAddress);
+    }
+
+    return HostRegs_Read16(address & ~1);
+}
+
+void HostRegs_BusWrite16(uint16_t address, uint16_t value)
+{
+    const hostPeripheral_t *peripheral = HostRegs_FindPeripheral(address & ~1);
+    uint16_t oldValue = HostRegs_Read16(address & ~1);
+    uint16_t offset;
+    uint8_t flags;
+
+    HostRegs_Write16(address & ~1, value);
+    if ((peripheral == NULL) || (peripheral->write == NULL))
+    {
+        return;
+    }
+
+    offset = (address & ~1) - peripheral->baseAddress;
+    flags = (peripheral->regFlags != NULL) ? peripheral->regFlags(offset) : HOST_REG_PLAIN;
+    if (((flags & HOST_REG_WRITE_FIFO) != 0) || (value != oldValue))
+    {
+        peripheral->write(offset, oldValue, value);
+    }
+}
+
+/*
+ * Direct register access for the peripheral models themselves. These bypass
+ * the access tracking above.
+ */
+uint16_t HostRegs_Read16(uint16_t address)
+{
+    uint16_t value;
+    memcpy(&value, &hostRegs[address], 2);
+    return value;
+}
+
+void HostRegs_Write16(uint16_t address, uint16_t value)
+{
+    memcpy(&hostRegs[address], &value, 2);
+}
+
+uint8_t HostRegs_Read8(uint16_t address)
+{
+    return hostRegs[address];
+}
+
+void HostRegs_Write8(uint16_t address, uint8_t value)
+{
+    hostRegs[address] = value;
+}
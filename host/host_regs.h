@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef HOST_REGS_H
+#define HOST_REGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Peripheral register space covered by the simulated register file
+#define HOST_REGS_SIZE          (0x1000)
+
+// Register flags used in a peripheral's register map
+#define HOST_REG_PLAIN          (0x00) // Behaves like RAM, writes reported on change
+#define HOST_REG_WRITE_FIFO     (0x01) // Every access is a write (e.g. TXBUF, AESADIN)
+#define HOST_REG_READ_FIFO      (0x02) // Every access is a read (e.g. RXBUF, AESADOUT)
+
+typedef struct hostPeripheral
+{
+    // Name used in diagnostics
+    const char *name;
+    // First register address and size of the register block in bytes
+    uint16_t baseAddress;
+    uint16_t size;
+    // Returns the HOST_REG_* flags of the register at the given offset
+    uint8_t (*regFlags)(uint16_t offset);
+    // Called right before the CPU accesses a register, so the model can update
+    // the value the CPU is about to read
+    void (*read)(uint16_t offset);
+    // Called once the CPU has written a register (detected on the next access)
+    void (*write)(uint16_t offset, uint16_t oldValue, uint16_t newValue);
+    // Called whenever time may have passed, to raise time-based flags
+    void (*service)(void);
+    // Returns the interrupt vector this peripheral is requesting, or -1
+    int (*pendingVector)(void);
+} hostPeripheral_t;
+
+// An access handed out by HostRegs_Access() that has not been committed yet
+typedef struct hostRegsAccess
+{
+    bool valid;
+    uint16_t address;   // Aligned to the 16-bit register
+    uint8_t numWords;   // 1 for 8/16-bit accesses, 2 for 32-bit accesses
+    uint16_t value[2];  // Register contents when the access was handed out
+} hostRegsAccess_t;
+
+volatile void *HostRegs_Access(uint16_t address, uint8_t width);
+void HostRegs_Flush(void);
+void HostRegs_Suspend(hostRegsAccess_t *saved);
+void HostRegs_Resume(const hostRegsAccess_t *saved);
+void HostRegs_Service(void);
+int HostRegs_PendingVector(void);
+uint32_t HostRegs_GetAccessCount(void);
+uint16_t HostRegs_BusRead16(uint16_t address);
+void HostRegs_BusWrite16(uint16_t address, uint16_t value);
+uint16_t HostRegs_Read16(uint16_t address);
+void HostRegs_Write16(uint16_t address, uint16_t value);
+uint8_t HostRegs_Read8(uint16_t address);
+void HostRegs_Write8(uint16_t address, uint8_t value);
+
+#endif // HOST_REGS_H
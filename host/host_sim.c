@@ -0,0 +1,868 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Discrete-event power-loss simulator.
+ *
+ * Runs the fixture's workload loop in virtual time instead of on the board
+ * model: a chunk costs its AES blocks, the dead-time costs itself, and
+ * power losses are events drawn from one or more inter-arrival generators.
+ * The costs come from a profile measured on the board (calibration.c), or
+ * from estimates when there is none. The profile times whole chunks, so the
+ * AESADIN/AESADOUT packing, the powerLoss poll and the work start/end GPIO
+ * marks are in its block and chunk costs rather than costs of their own.
+ * What it leaves out is the time the power-loss interrupt itself takes.
+ * Nothing busy-waits, so a full workload finishes in a few milliseconds of
+ * host time. The loop is the fixture's own Checkpointing_DoChunk() and
+ * Checkpointing_WaitDeadTime(), run against the simulator's
+ * checkpointingPlatform_t hooks in place of the board's clock, GPIO and
+ * checkpoint store, so the policy under test sees its counters updated by the
+ * same code as on target. Dead-time waits end on whole microseconds, as the
+ * board's uptime counter does. A simulation
+ * and its instance share no state with others, so any number of them can run
+ * on separate threads.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_sim.h"
+#include "trace.h"
+
+/**
+ * @brief      Draw a uniform number in (0, 1] from the generator RNG
+ */
+static double HostSim_Uniform(hostSim_t *sim)
+{
+    // xorshift64*
+    uint64_t x = sim->rngState;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    sim->rngState = x;
+    return ((double)((x * 0x2545F4914F6CDD1DULL) >> 11) + 1.0) / 9007199254740992.0;
+}
+
+static double HostSim_Exponential(hostSim_t *sim, double mean)
+{
+    return -mean * log(HostSim_Uniform(sim));
+}
+
+/**
+ * @brief      Draw the time until a generator's next power loss
+ *
+ * @return     Inter-arrival time in cycles, HOST_SIM_NEVER if exhausted
+ */
+static uint64_t HostSim_NextInterval(hostSim_t *sim, hostSimGenerator_t *generator)
+{
+    double intervalMicroseconds;
+    double p;
+
+    switch (generator->type)
+    {
+        case HOST_SIM_GEN_PERIODIC:
+        {
+            intervalMicroseconds = generator->intervalMicroseconds;
+            break;
+        }
+
+        case HOST_SIM_GEN_EXPONENTIAL:
+        {
+            intervalMicroseconds = HostSim_Exponential(sim, generator->intervalMicroseconds);
+            break;
+        }
+
+        case HOST_SIM_GEN_BURSTY:
+        {
+            if (generator->burstRemaining != 0)
+            {
+                // Still inside a burst
+                generator->burstRemaining--;
+                intervalMicroseconds = HostSim_Exponential(sim, generator->burstIntervalMicroseconds);
+            }
+            else
+            {
+                // Quiet gap, then a burst of geometrically distributed length
+                p = 1.0 / generator->burstLength;
+                if (p < 1.0)
+                {
+                    generator->burstRemaining = (uint32_t)floor(log(HostSim_Uniform(sim)) / log(1.0 - p));
+                }
+                intervalMicroseconds = HostSim_Exponential(sim, generator->intervalMicroseconds);
+            }
+            break;
+        }
+
+        case HOST_SIM_GEN_WEIBULL:
+        {
+            intervalMicroseconds = generator->intervalMicroseconds *
+                                   pow(-log(HostSim_Uniform(sim)), 1.0 / generator->shape);
+            break;
+        }
+
+        case HOST_SIM_GEN_TRACE:
+        {
+            if (generator->traceLength == 0)
+            {
+                return HOST_SIM_NEVER;
+            }
+            intervalMicroseconds = generator->traceMicroseconds[generator->traceIndex];
+            generator->traceIndex = (generator->traceIndex + 1) % generator->traceLength;
+            break;
+        }
+
+        default:
+        {
+            return HOST_SIM_NEVER;
+        }
+    }
+
+    // Two power losses can't land on the same cycle
+    if (intervalMicroseconds < (1.0 / HOST_SIM_CYCLES_PER_US))
+    {
+        return 1;
+    }
+    return (uint64_t)(intervalMicroseconds * HOST_SIM_CYCLES_PER_US);
+}
+
+static void HostSim_SiftUp(hostSim_t *sim, unsigned int i)
+{
+    hostSimEvent_t event = sim->events[i];
+
+    while (i > 0)
+    {
+        unsigned int parent = (i - 1) / 2;
+        if (sim->events[parent].timeCycles <= event.timeCycles)
+        {
+            break;
+        }
+        sim->events[i] = sim->events[parent];
+        i = parent;
+    }
+    sim->events[i] = event;
+}
+
+static void HostSim_SiftDown(hostSim_t *sim, unsigned int i)
+{
+    hostSimEvent_t event = sim->events[i];
+
+    for (;;)
+    {
+        unsigned int child = (2 * i) + 1;
+        if (child >= sim->numEvents)
+        {
+            break;
+        }
+        if (((child + 1) < sim->numEvents) &&
+            (sim->events[child + 1].timeCycles < sim->events[child].timeCycles))
+        {
+            child++;
+        }
+        if (event.timeCycles <= sim->events[child].timeCycles)
+        {
+            break;
+        }
+        sim->events[i] = sim->events[child];
+        i = child;
+    }
+    sim->events[i] = event;
+}
+
+/**
+ * @brief      Schedule a generator's next power loss after a given time
+ */
+static void HostSim_Schedule(hostSim_t *sim, uint8_t generator, uint64_t afterCycles)
+{
+    uint64_t interval = HostSim_NextInterval(sim, &sim->generators[generator]);
+
+    if (interval == HOST_SIM_NEVER)
+    {
+        return;
+    }
+    sim->events[sim->numEvents].timeCycles = afterCycles + interval;
+    sim->events[sim->numEvents].generator = generator;
+    sim->numEvents++;
+    HostSim_SiftUp(sim, sim->numEvents - 1);
+}
+
+/**
+ * @brief      Fill in the estimated cost model
+ */
+void HostSim_DefaultTiming(hostSimTiming_t *timing)
+{
+    timing->aesBlockCycles = HOST_SIM_DEFAULT_AES_BLOCK_CYCLES;
+    timing->blockPollCycles = HOST_SIM_DEFAULT_BLOCK_POLL_CYCLES;
+    timing->chunkOverheadCycles = HOST_SIM_DEFAULT_CHUNK_OVERHEAD_CYCLES;
+    timing->deadTimeOverheadCycles = HOST_SIM_DEFAULT_DEAD_TIME_OVERHEAD_CYCLES;
+    timing->checkpointCycles = HOST_SIM_DEFAULT_CHECKPOINT_CYCLES;
+}
+
+/**
+ * @brief      Load a cost profile printed by the fixture's Calibrate menu
+ *
+ * The file is key=value lines, as printed by Calibration_PrintProfile(). A
+ * whole console capture can be used as is: the carriage return the console
+ * starts its lines with is ignored, and lines without a known key are
+ * skipped. Costs missing from the profile keep their current value.
+ *
+ * @return     false if the file can't be read, is of another profile version
+ *             or has no costs in it
+ */
+bool HostSim_LoadProfile(const char *path, hostSimTiming_t *timing)
+{
+    static const struct
+    {
+        const char *key;
+        size_t offset;
+    } keys[] =
+    {
+        {"aes_block_cycles", offsetof(hostSimTiming_t, aesBlockCycles)},
+        {"block_poll_cycles", offsetof(hostSimTiming_t, blockPollCycles)},
+        {"chunk_overhead_cycles", offsetof(hostSimTiming_t, chunkOverheadCycles)},
+        {"dead_time_overhead_cycles", offsetof(hostSimTiming_t, deadTimeOverheadCycles)},
+        {"checkpoint_cycles", offsetof(hostSimTiming_t, checkpointCycles)},
+    };
+    FILE *file = fopen(path, "r");
+    char line[128];
+    char *key;
+    char *value;
+    char *end;
+    unsigned long number;
+    unsigned int found = 0;
+    bool ok = true;
+    unsigned int i;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+    while (ok && (fgets(line, sizeof(line), file) != NULL))
+    {
+        key = line + strspn(line, " \t\r");
+        value = strchr(key, '=');
+        if ((key[0] == '#') || (value == NULL))
+        {
+            continue;
+        }
+        *value++ = '\0';
+        number = strtoul(value, &end, 0);
+        if (end == value)
+        {
+            continue;
+        }
+        if (strcmp(key, "profile_version") == 0)
+        {
+            ok = (number == HOST_SIM_PROFILE_VERSION);
+            continue;
+        }
+        for (i = 0; i < (sizeof(keys) / sizeof(keys[0])); i++)
+        {
+            if (strcmp(key, keys[i].key) == 0)
+            {
+                *(uint32_t *)((uint8_t *)timing + keys[i].offset) = (uint32_t)number;
+                found++;
+            }
+        }
+    }
+    fclose(file);
+
+    return ok && (found != 0);
+}
+
+/**
+ * @brief      Reset a simulation to time zero with no generators
+ *
+ * @param      sim   The simulation
+ * @param[in]  seed  Seed for the generator RNG (zero is remapped)
+ */
+void HostSim_Init(hostSim_t *sim, uint64_t seed)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->rngState = (seed != 0) ? seed : 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * @brief      Add a power-loss generator, its first event timed from now
+ *
+ * @return     false if the simulation already has HOST_SIM_MAX_GENERATORS
+ */
+bool HostSim_AddGenerator(hostSim_t *sim, const hostSimGenerator_t *generator)
+{
+    if (sim->numGenerators >= HOST_SIM_MAX_GENERATORS)
+    {
+        return false;
+    }
+    sim->generators[sim->numGenerators] = *generator;
+    sim->generators[sim->numGenerators].traceIndex = 0;
+    sim->generators[sim->numGenerators].burstRemaining = 0;
+    HostSim_Schedule(sim, (uint8_t)sim->numGenerators, sim->nowCycles);
+    sim->numGenerators++;
+
+    return true;
+}
+
+/**
+ * @brief      Append an interval to a trace being loaded
+ */
+static bool HostSim_AppendInterval(hostSimGenerator_t *generator, uint32_t *capacity, uint32_t interval)
+{
+    uint32_t *grown;
+
+    if (generator->traceLength == *capacity)
+    {
+        *capacity = (*capacity == 0) ? 256 : (*capacity * 2);
+        grown = realloc((void *)generator->traceMicroseconds, *capacity * sizeof(*grown));
+        if (grown == NULL)
+        {
+            return false;
+        }
+        generator->traceMicroseconds = grown;
+    }
+    ((uint32_t *)generator->traceMicroseconds)[generator->traceLength++] = interval;
+
+    return true;
+}
+
+static uint32_t HostSim_ReadLe(const uint8_t *bytes, unsigned int size)
+{
+    uint32_t value = 0;
+
+    while (size-- != 0)
+    {
+        value = (value << 8) | bytes[size];
+    }
+
+    return value;
+}
+
+/**
+ * @brief      Load a binary trace dump sent by Trace_Dump()
+ *
+ * Each power-loss edge becomes the interval since the edge or run start
+ * marker before it.
+ */
+static bool HostSim_LoadDump(FILE *file, hostSimGenerator_t *generator)
+{
+    uint8_t header[12];
+    uint8_t record[sizeof(traceRecord_t)];
+    uint8_t checksum[2];
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    uint32_t capacity = 0;
+    uint32_t previous = 0;
+    bool havePrevious = false;
+    uint32_t timestamp;
+    uint16_t count;
+    uint16_t i;
+    uint8_t j;
+
+    if ((fread(header, sizeof(header), 1, file) != 1) ||
+        (header[4] != TRACE_DUMP_VERSION) || (header[5] != sizeof(traceRecord_t)))
+    {
+        return false;
+    }
+    count = (uint16_t)HostSim_ReadLe(&header[6], 2);
+
+    for (i = 0; i < count; i++)
+    {
+        if (fread(record, sizeof(record), 1, file) != 1)
+        {
+            return false;
+        }
+        for (j = 0; j < sizeof(record); j++)
+        {
+            sum1 = (sum1 + record[j]) % 255;
+            sum2 = (sum2 + sum1) % 255;
+        }
+
+        timestamp = HostSim_ReadLe(&record[0], 4);
+        if (((record[offsetof(traceRecord_t, flags)] & TRACE_FLAG_RUN_START) == 0) && havePrevious &&
+            !HostSim_AppendInterval(generator, &capacity, timestamp - previous))
+        {
+            return false;
+        }
+        previous = timestamp;
+        havePrevious = true;
+    }
+
+    return (fread(checksum, sizeof(checksum), 1, file) == 1) &&
+           (checksum[0] == sum1) && (checksum[1] == sum2);
+}
+
+/**
+ * @brief      Load a power-loss trace
+ *
+ * Either a binary dump from the fixture's Trace menu, or a text file of
+ * intervals in microseconds, one per line, where blank lines and lines
+ * starting with '#' are skipped.
+ */
+static bool HostSim_LoadTrace(const char *path, hostSimGenerator_t *generator)
+{
+    FILE *file = fopen(path, "rb");
+    char line[64];
+    uint32_t capacity = 0;
+    char *end;
+    unsigned long value;
+    bool ok = true;
+
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    if ((fread(line, 4, 1, file) == 1) && (memcmp(line, TRACE_DUMP_MAGIC, 4) == 0))
+    {
+        rewind(file);
+        ok = HostSim_LoadDump(file, generator);
+    }
+    else
+    {
+        rewind(file);
+        while (ok && (fgets(line, sizeof(line), file) != NULL))
+        {
+            if ((line[0] == '#') || (line[0] == '\n') || (line[0] == '\r'))
+            {
+                // Drop the rest of a comment too long for the buffer
+                while ((strchr(line, '\n') == NULL) && (fgets(line, sizeof(line), file) != NULL));
+                continue;
+            }
+            value = strtoul(line, &end, 0);
+            ok = (end != line) && HostSim_AppendInterval(generator, &capacity, (uint32_t)value);
+        }
+    }
+    fclose(file);
+
+    if (!ok)
+    {
+        HostSim_FreeGenerator(generator);
+    }
+
+    return ok;
+}
+
+/**
+ * @brief      Parse a generator from its command line form
+ *
+ * Accepted forms, all times in microseconds:
+ *   periodic:<period>
+ *   exp:<mean>
+ *   bursty:<mean quiet gap>,<mean gap in burst>,<mean burst length>
+ *   weibull:<scale>,<shape>
+ *   trace:<file>        (text intervals or a Trace_Dump() capture)
+ *
+ * @return     false if the spec is malformed or the trace can't be read
+ */
+bool HostSim_ParseGenerator(const char *spec, hostSimGenerator_t *generator)
+{
+    const char *args = strchr(spec, ':');
+    size_t nameLength;
+    int parsed;
+
+    memset(generator, 0, sizeof(*generator));
+    if (args == NULL)
+    {
+        return false;
+    }
+    nameLength = (size_t)(args - spec);
+    args++;
+
+    if ((nameLength == 8) && (strncmp(spec, "periodic", nameLength) == 0))
+    {
+        generator->type = HOST_SIM_GEN_PERIODIC;
+        parsed = sscanf(args, "%lf", &generator->intervalMicroseconds);
+        return (parsed == 1) && (generator->intervalMicroseconds > 0.0);
+    }
+    if ((nameLength == 3) && (strncmp(spec, "exp", nameLength) == 0))
+    {
+        generator->type = HOST_SIM_GEN_EXPONENTIAL;
+        parsed = sscanf(args, "%lf", &generator->intervalMicroseconds);
+        return (parsed == 1) && (generator->intervalMicroseconds > 0.0);
+    }
+    if ((nameLength == 6) && (strncmp(spec, "bursty", nameLength) == 0))
+    {
+        generator->type = HOST_SIM_GEN_BURSTY;
+        parsed = sscanf(args, "%lf,%lf,%lf", &generator->intervalMicroseconds,
+                        &generator->burstIntervalMicroseconds, &generator->burstLength);
+        return (parsed == 3) && (generator->intervalMicroseconds > 0.0) &&
+               (generator->burstIntervalMicroseconds > 0.0) && (generator->burstLength >= 1.0);
+    }
+    if ((nameLength == 7) && (strncmp(spec, "weibull", nameLength) == 0))
+    {
+        generator->type = HOST_SIM_GEN_WEIBULL;
+        parsed = sscanf(args, "%lf,%lf", &generator->intervalMicroseconds, &generator->shape);
+        return (parsed == 2) && (generator->intervalMicroseconds > 0.0) && (generator->shape > 0.0);
+    }
+    if ((nameLength == 5) && (strncmp(spec, "trace", nameLength) == 0))
+    {
+        generator->type = HOST_SIM_GEN_TRACE;
+        return HostSim_LoadTrace(args, generator);
+    }
+
+    return false;
+}
+
+/**
+ * @brief      Parse chunk size bounds from their command line form,
+ *             <min>-<max> in bytes
+ *
+ * @return     false if malformed, not whole blocks or out of order
+ */
+bool HostSim_ParseChunkBounds(const char *spec, uint32_t *minChunkSize, uint32_t *maxChunkSize)
+{
+    unsigned long first;
+    unsigned long last;
+    char extra;
+
+    if ((sscanf(spec, "%lu-%lu%c", &first, &last, &extra) != 2) ||
+        (first < AES_MINIMUM_CHUNK_SIZE) || (last > CHUNK_SIZE_LIMIT) || (first > last) ||
+        ((first % AES_MINIMUM_CHUNK_SIZE) != 0) || ((last % AES_MINIMUM_CHUNK_SIZE) != 0))
+    {
+        return false;
+    }
+    *minChunkSize = (uint32_t)first;
+    *maxChunkSize = (uint32_t)last;
+
+    return true;
+}
+
+/**
+ * @brief      Release what HostSim_ParseGenerator() allocated
+ */
+void HostSim_FreeGenerator(hostSimGenerator_t *generator)
+{
+    if (generator->type == HOST_SIM_GEN_TRACE)
+    {
+        free((void *)generator->traceMicroseconds);
+        generator->traceMicroseconds = NULL;
+        generator->traceLength = 0;
+    }
+}
+
+/**
+ * @brief      Get the time of the next pending power loss
+ *
+ * @return     Event time in cycles, HOST_SIM_NEVER if none is pending
+ */
+uint64_t HostSim_NextEventCycles(const hostSim_t *sim)
+{
+    return (sim->numEvents != 0) ? sim->events[0].timeCycles : HOST_SIM_NEVER;
+}
+
+/**
+ * @brief      Deliver the next pending power loss, moving time up to it
+ *
+ * @return     Event time in cycles, HOST_SIM_NEVER if none is pending
+ */
+uint64_t HostSim_PopEvent(hostSim_t *sim)
+{
+    hostSimEvent_t event;
+
+    if (sim->numEvents == 0)
+    {
+        return HOST_SIM_NEVER;
+    }
+    event = sim->events[0];
+    sim->numEvents--;
+    if (sim->numEvents != 0)
+    {
+        sim->events[0] = sim->events[sim->numEvents];
+        HostSim_SiftDown(sim, 0);
+    }
+    if (event.timeCycles > sim->nowCycles)
+    {
+        sim->nowCycles = event.timeCycles;
+    }
+    sim->powerLosses++;
+    if (sim->ctx != NULL)
+    {
+        Checkpointing_ObservePowerLoss(sim->ctx, (uint32_t)(event.timeCycles / HOST_SIM_CYCLES_PER_US));
+    }
+    HostSim_Schedule(sim, event.generator, event.timeCycles);
+
+    return event.timeCycles;
+}
+
+/**
+ * @brief      Move time forward, delivering every power loss on the way
+ *
+ * @return     Number of power losses delivered
+ */
+uint32_t HostSim_AdvanceTo(hostSim_t *sim, uint64_t timeCycles)
+{
+    uint32_t delivered = 0;
+
+    while (HostSim_NextEventCycles(sim) <= timeCycles)
+    {
+        HostSim_PopEvent(sim);
+        delivered++;
+    }
+    if (timeCycles > sim->nowCycles)
+    {
+        sim->nowCycles = timeCycles;
+    }
+
+    return delivered;
+}
+
+/**
+ * @brief      Check whether the cost model covers an instance's workload
+ *
+ * Its unit cost is a block of the blocking engine's ECB runs, the one
+ * Calibration_Run() measures. The other workloads, engines and modes cost
+ * something else per unit and are not modelled.
+ *
+ * @param[in]  ctx   The fixture instance
+ */
+bool HostSim_IsModelled(const checkpointingObj_t *ctx)
+{
+    return (ctx->workload == WORKLOAD_AES) &&
+           (ctx->workloadState.stream.engine == CIPHER_ENGINE_BLOCKING) &&
+           (ctx->workloadState.stream.mode == CIPHER_MODE_ECB);
+}
+
+/**
+ * @brief      Simulate one chunk of Checkpointing_DoChunk()
+ *
+ * The unit loop checks the power-loss flag after every unit, so a power
+ * loss cuts the chunk short at the end of the unit it landed in. One that
+ * lands in the chunk's overhead, after the last unit, still fails the chunk
+ * but leaves every unit finished.
+ *
+ * @param[out] unitsRun  Number of workload units run before the chunk ended
+ * @param[out] inUnit    Set if the power loss landed inside a unit, the last
+ *                       one run
+ *
+ * @return     true if a power loss hit the chunk
+ */
+static bool HostSim_RunChunk(hostSim_t *sim, const hostSimTiming_t *timing, uint32_t chunkSize,
+                             uint32_t unitSize, uint64_t *unitsRun, bool *inUnit)
+{
+    uint64_t start = sim->nowCycles;
+    uint64_t units = (chunkSize + unitSize - 1) / unitSize;
+    uint64_t unitCycles = (uint64_t)timing->aesBlockCycles + timing->blockPollCycles;
+    uint64_t next = HostSim_NextEventCycles(sim);
+
+    *inUnit = (next < (start + (units * unitCycles))) && (unitCycles != 0);
+    if (*inUnit)
+    {
+        units = ((next - start) / unitCycles) + 1;
+    }
+    *unitsRun = units;
+
+    return (HostSim_AdvanceTo(sim, start + (units * unitCycles) + timing->chunkOverheadCycles) != 0);
+}
+
+static uint32_t HostSim_Microseconds(const checkpointingObj_t *ctx)
+{
+    const hostSim_t *sim = ctx->platform->context;
+
+    return (uint32_t)(sim->nowCycles / HOST_SIM_CYCLES_PER_US);
+}
+
+/**
+ * @brief      Run a chunk in virtual time, for Checkpointing_DoChunk()
+ *
+ * Hands the outcome to the instance the way the PORT8 ISR and the unit loop
+ * would: the power-loss flag, the units finished and what a power loss
+ * salvaged. The chunk's state moves on by the units it finished.
+ */
+static uint32_t HostSim_PlatformRunChunk(checkpointingObj_t *ctx, workloadState_t *state, uint32_t chunkSize)
+{
+    hostSim_t *sim = ctx->platform->context;
+    const workload_t *workload = &workloadTable[(unsigned int)ctx->workload];
+    uint64_t chunkStart = sim->nowCycles;
+    uint64_t unitsRun;
+    bool lossInUnit;
+
+    if (HostSim_RunChunk(sim, sim->timing, chunkSize, workload->unitSize, &unitsRun, &lossInUnit))
+    {
+        sim->result->chunksFailed++;
+        sim->result->wastedCycles += sim->nowCycles - chunkStart;
+        // A power loss inside a unit leaves the ones before it done. One in
+        // the overhead after the last unit leaves them all done.
+        ctx->powerLoss = true;
+        ctx->chunkUnitsDone = (uint16_t)(lossInUnit ? (unitsRun - 1) : unitsRun);
+        ctx->salvageUnits = ctx->chunkUnitsDone;
+    }
+    else
+    {
+        sim->result->chunksCompleted++;
+        ctx->chunkUnitsDone = (uint16_t)unitsRun;
+    }
+    workload->advance(state, ctx->chunkUnitsDone);
+
+    return (uint32_t)(unitsRun * workload->unitSize);
+}
+
+/**
+ * @brief      Move time on to a dead-time's end, for
+ *             Checkpointing_WaitDeadTime()
+ *
+ * The wait overshoots by the modelled dead-time overhead. A power loss on the
+ * way stops it there, and the dead-time restarts from it. Power losses closer
+ * together than the dead-time would hold the workload there for good, as they
+ * would on target, so past the deadline they are left for the next chunk.
+ */
+static void HostSim_PlatformWaitUntil(checkpointingObj_t *ctx, uint32_t microseconds)
+{
+    hostSim_t *sim = ctx->platform->context;
+    uint64_t nowMicroseconds = sim->nowCycles / HOST_SIM_CYCLES_PER_US;
+    uint64_t end = ((nowMicroseconds + (uint32_t)(microseconds - (uint32_t)nowMicroseconds)) *
+                    HOST_SIM_CYCLES_PER_US) + sim->timing->deadTimeOverheadCycles;
+
+    if ((end < sim->deadlineCycles) && (HostSim_NextEventCycles(sim) <= end))
+    {
+        HostSim_PopEvent(sim);
+        ctx->powerLoss = true;
+        return;
+    }
+    if (end > sim->nowCycles)
+    {
+        sim->nowCycles = end;
+    }
+}
+
+/**
+ * @brief      Commit in virtual time, for Checkpointing_DoChunk()
+ *
+ * The commit runs to the end whatever lands meanwhile, a power loss during it
+ * just raises the flag for the dead-time wait.
+ */
+static bool HostSim_PlatformCommit(checkpointingObj_t *ctx)
+{
+    hostSim_t *sim = ctx->platform->context;
+
+    if (HostSim_AdvanceTo(sim, sim->nowCycles + sim->timing->checkpointCycles) != 0)
+    {
+        ctx->powerLoss = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief      Simulate Checkpointing_WorkloadLoop() with the current settings
+ *
+ * Settings are taken from the fixture instance, as PowerLossEmu_Setup() leaves
+ * them. The caller seeds the instance for the randomized policies. A workload
+ * the cost model doesn't cover (HostSim_IsModelled()) isn't run, and the
+ * result is left as a run that didn't complete.
+ *
+ * @param      sim              The simulation, with its generators added
+ * @param      ctx              The fixture instance under test
+ * @param[in]  timing           Cost model
+ * @param[in]  timeLimitCycles  Give up after this much virtual time
+ * @param[out] result           Outcome of the run
+ */
+void HostSim_RunWorkload(hostSim_t *sim, checkpointingObj_t *ctx, const hostSimTiming_t *timing,
+                         uint64_t timeLimitCycles, hostSimResult_t *result)
+{
+    uint64_t workloadStart;
+    uint64_t sampleCycles = (uint64_t)ctx->sampleIntervalMicroseconds * HOST_SIM_CYCLES_PER_US;
+    uint64_t nextSample = HOST_SIM_NEVER;
+    uint32_t powerLossesStart;
+
+    memset(result, 0, sizeof(*result));
+    if (!HostSim_IsModelled(ctx))
+    {
+        return;
+    }
+
+    // Reset runtime variables
+    Checkpointing_SetChunkSize(ctx, ctx->startingChunkSize);
+    ctx->unitCostQ8 = 0;
+    Checkpointing_ResetBandit(ctx);
+    ctx->bytesProcessed = 0;
+    ctx->workloadFails = 0;
+    ctx->workloadSuccesses = 0;
+    workloadTable[(unsigned int)ctx->workload].init(&ctx->workloadState);
+    Checkpointing_ResetStats(ctx);
+
+    // The instance runs its chunks and dead-times on this simulation
+    sim->ctx = ctx;
+    sim->platform.getMicroseconds = HostSim_Microseconds;
+    sim->platform.markWork = NULL;
+    sim->platform.runChunk = HostSim_PlatformRunChunk;
+    sim->platform.waitUntil = HostSim_PlatformWaitUntil;
+    sim->platform.commit = HostSim_PlatformCommit;
+    sim->platform.context = sim;
+    sim->timing = timing;
+    sim->result = result;
+    ctx->platform = &sim->platform;
+
+    // Wait for the first power-loss pulse from the power-loss emulator
+    if (HostSim_NextEventCycles(sim) != HOST_SIM_NEVER)
+    {
+        HostSim_PopEvent(sim);
+    }
+    ctx->powerLoss = false;
+
+    workloadStart = sim->nowCycles;
+    sim->deadlineCycles = workloadStart + timeLimitCycles;
+    powerLossesStart = sim->powerLosses;
+    if ((sim->samples != NULL) && (sampleCycles != 0))
+    {
+        Sampler_Reset(sim->samples);
+        Sampler_Record(sim->samples, ctx, 0, 0);
+        nextSample = workloadStart + sampleCycles;
+    }
+    for (;;)
+    {
+        // The workload loop's own steps
+        Checkpointing_DoChunk(ctx);
+        Checkpointing_WaitDeadTime(ctx);
+
+        // Sampled between chunks, as the workload loop does
+        if (sim->nowCycles >= nextSample)
+        {
+            Sampler_Record(sim->samples, ctx, (uint32_t)((sim->nowCycles - workloadStart) / HOST_SIM_CYCLES_PER_US),
+                           sim->powerLosses - powerLossesStart);
+            nextSample = sim->nowCycles + sampleCycles;
+        }
+
+        if (ctx->bytesProcessed >= ctx->totalWorkloadSizeBytes)
+        {
+            result->completed = true;
+            break;
+        }
+        if ((sim->nowCycles - workloadStart) >= timeLimitCycles)
+        {
+            break;
+        }
+    }
+
+    if (nextSample != HOST_SIM_NEVER)
+    {
+        Sampler_Record(sim->samples, ctx, (uint32_t)((sim->nowCycles - workloadStart) / HOST_SIM_CYCLES_PER_US),
+                       sim->powerLosses - powerLossesStart);
+    }
+
+    result->bytesProcessed = ctx->bytesProcessed;
+    result->wastedBytes = ctx->stats.wastedBytes;
+    result->elapsedCycles = sim->nowCycles - workloadStart;
+    result->powerLosses = sim->powerLosses - powerLossesStart;
+}
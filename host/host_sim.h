@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef HOST_SIM_H
+#define HOST_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "host_cpu.h"
+#include "checkpointing_test_fixture.h"
+#include "sampler.h"
+
+// Virtual time is kept in MCLK cycles, like HostCpu_GetCycles()
+#define HOST_SIM_CYCLES_PER_US          (HOST_MCLK_HZ / 1000000ULL)
+#define HOST_SIM_NEVER                  (UINT64_MAX)
+
+// Power-loss sources that can be superimposed in one simulation
+#define HOST_SIM_MAX_GENERATORS         (8)
+
+// Default cost model, in MCLK cycles, used until a profile measured on the
+// board by Calibration_Run() is loaded with HostSim_LoadProfile(). The AES
+// block is what Calibration_Run() measures for a block of its 64-block
+// AES256_encryptBlocks() call on fixture_host, the median of seven runs
+// (262 to 324 cycles); the blocking engine encrypts ECB chunks in such runs
+// (Cipher_WaitChunk()). The chunk overhead covers the message copy, the work
+// start/end GPIO marks and Checkpointing_ExecutePolicy() itself. A checkpoint
+// commit is the CRC32 of the slot fed a word at a time, the 51 word FRAM
+// write and the two uptime reads around it. The per-block poll and the
+// dead-time overshoot are left out of the estimate.
+#define HOST_SIM_DEFAULT_AES_BLOCK_CYCLES       (287)
+#define HOST_SIM_DEFAULT_BLOCK_POLL_CYCLES      (0)
+#define HOST_SIM_DEFAULT_CHUNK_OVERHEAD_CYCLES  (350)
+#define HOST_SIM_DEFAULT_DEAD_TIME_OVERHEAD_CYCLES  (0)
+#define HOST_SIM_DEFAULT_CHECKPOINT_CYCLES      (700)
+
+// Cost profile version HostSim_LoadProfile() understands, as printed by
+// Calibration_PrintProfile()
+#define HOST_SIM_PROFILE_VERSION        (1)
+
+typedef enum
+{
+    HOST_SIM_GEN_PERIODIC = 0,
+    HOST_SIM_GEN_EXPONENTIAL = 1,
+    HOST_SIM_GEN_BURSTY = 2,
+    HOST_SIM_GEN_WEIBULL = 3,
+    HOST_SIM_GEN_TRACE = 4,
+    HOST_SIM_GEN_NUM = 5,
+} hostSimGeneratorType_e;
+
+typedef struct
+{
+    // Kind of inter-arrival distribution
+    hostSimGeneratorType_e type;
+    // Period (periodic), mean (exponential), mean quiet gap (bursty) or scale
+    // (Weibull) of the inter-arrival time
+    double intervalMicroseconds;
+    // Mean inter-arrival time within a burst (bursty)
+    double burstIntervalMicroseconds;
+    // Mean number of power losses per burst (bursty)
+    double burstLength;
+    // Shape parameter (Weibull)
+    double shape;
+    // Recorded inter-arrival times (trace), shared between copies
+    const uint32_t *traceMicroseconds;
+    // Number of recorded intervals (trace)
+    uint32_t traceLength;
+    // Next trace interval to replay (trace), wraps around
+    uint32_t traceIndex;
+    // Power losses left in the current burst (bursty)
+    uint32_t burstRemaining;
+} hostSimGenerator_t;
+
+typedef struct
+{
+    // Virtual time the event fires at
+    uint64_t timeCycles;
+    // Generator that produced the event
+    uint8_t generator;
+} hostSimEvent_t;
+
+typedef struct
+{
+    // Cost of one AES256_encryptBlocks() call for one block
+    uint32_t aesBlockCycles;
+    // Loop overhead per block on top of the AES call, the powerLoss poll
+    uint32_t blockPollCycles;
+    // Fixed cost of every chunk on top of its AES blocks
+    uint32_t chunkOverheadCycles;
+    // Time a dead-time wait takes on top of the dead-time itself
+    uint32_t deadTimeOverheadCycles;
+    // Cost of the checkpoint commit after a chunk that committed
+    uint32_t checkpointCycles;
+} hostSimTiming_t;
+
+typedef struct
+{
+    // Bytes processed by successful chunks
+    uint64_t bytesProcessed;
+    // Virtual time from sync to the end of the workload
+    uint64_t elapsedCycles;
+    // Chunks that ran to completion without a power loss
+    uint32_t chunksCompleted;
+    // Chunks aborted or invalidated by a power loss
+    uint32_t chunksFailed;
+    // Power losses delivered during the workload
+    uint32_t powerLosses;
+    // Bytes encrypted by chunks that then failed, less what they salvaged
+    uint64_t wastedBytes;
+    // Virtual time spent in chunks that then failed
+    uint64_t wastedCycles;
+    // False if the time limit hit before the workload finished
+    bool completed;
+} hostSimResult_t;
+
+typedef struct
+{
+    // Current virtual time
+    uint64_t nowCycles;
+    // Generator RNG state, independent of the fixture instance's
+    uint64_t rngState;
+    // Power-loss generators
+    hostSimGenerator_t generators[HOST_SIM_MAX_GENERATORS];
+    unsigned int numGenerators;
+    // Pending events, a min-heap on timeCycles with one entry per generator
+    hostSimEvent_t events[HOST_SIM_MAX_GENERATORS];
+    unsigned int numEvents;
+    // Power losses delivered so far
+    uint32_t powerLosses;
+    // Instance each power loss is signalled to, as the PORT8 ISR would, or
+    // NULL for none
+    checkpointingObj_t *ctx;
+    // Where to take goodput samples every ctx->sampleIntervalMicroseconds,
+    // or NULL for none
+    samplerRing_t *samples;
+    // What the instance's chunks and dead-times run on during
+    // HostSim_RunWorkload(): the virtual clock, the cost model, where the
+    // outcome goes and the time past which a power loss no longer restarts
+    // a dead-time
+    checkpointingPlatform_t platform;
+    const hostSimTiming_t *timing;
+    hostSimResult_t *result;
+    uint64_t deadlineCycles;
+} hostSim_t;
+
+void HostSim_DefaultTiming(hostSimTiming_t *timing);
+bool HostSim_LoadProfile(const char *path, hostSimTiming_t *timing);
+void HostSim_Init(hostSim_t *sim, uint64_t seed);
+bool HostSim_AddGenerator(hostSim_t *sim, const hostSimGenerator_t *generator);
+bool HostSim_ParseGenerator(const char *spec, hostSimGenerator_t *generator);
+void HostSim_FreeGenerator(hostSimGenerator_t *generator);
+bool HostSim_ParseChunkBounds(const char *spec, uint32_t *minChunkSize, uint32_t *maxChunkSize);
+uint64_t HostSim_NextEventCycles(const hostSim_t *sim);
+uint64_t HostSim_PopEvent(hostSim_t *sim);
+uint32_t HostSim_AdvanceTo(hostSim_t *sim, uint64_t timeCycles);
+bool HostSim_IsModelled(const checkpointingObj_t *ctx);
+void HostSim_RunWorkload(hostSim_t *sim, checkpointingObj_t *ctx, const hostSimTiming_t *timing,
+                         uint64_t timeLimitCycles, hostSimResult_t *result);
+
+#endif // HOST_SIM_H
@@ -0,0 +1,250 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Command line front end of the discrete-event simulator (host_sim.c).
+ *
+ *   fixture_sim [options] -g <generator> [-g <generator> ...]
+ *
+ *   -g <spec>   Power-loss generator, see HostSim_ParseGenerator()
+ *   -m <MB>     Total workload size in MB (default 5)
+ *   -c <B>      Starting chunk size in bytes
+ *   -b <range>  Chunk size bounds in bytes, <min>-<max> (default 16-1024)
+ *   -d <us>     Dead-time between chunks
+ *   -s <n>      Success policy change threshold
+ *   -f <n>      Failure policy change threshold
+ *   -p <n>      Workload scaling policy, 0 to 7
+ *   -r <seed>   Seed for the generators and the random policies
+ *   -S <ms>     Goodput sample interval, printed after the run (default none)
+ *   -P <file>   Cost profile from the fixture's Calibrate menu
+ *   -a <cycles> AES block cost
+ *   -o <cycles> Per-chunk overhead
+ *   -l <s>      Virtual time limit (default 3600)
+ *
+ * Defaults for the fixture parameters are those of Checkpointing_Init(). The
+ * cost model is the estimate in host_sim.h unless a profile is given; -a and
+ * -o override single costs after it. It covers the AES workload on the
+ * blocking engine in ECB mode only, see HostSim_IsModelled().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_sim.h"
+#include "checkpointing_test_fixture.h"
+
+static void HostSimMain_Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-m MB] [-c bytes] [-b min-max] [-d us] [-s n] [-f n] [-p policy] [-k mode] [-r seed]\n"
+            "       [-S ms] [-P profile] [-a cycles] [-o cycles] [-l s] -g generator [-g generator ...]\n"
+            "generators: periodic:<us> exp:<mean us> bursty:<quiet us>,<burst us>,<length>\n"
+            "            weibull:<scale us>,<shape> trace:<file>\n",
+            name);
+}
+
+static double HostSimMain_Seconds(uint64_t cycles)
+{
+    return (double)cycles / (double)HOST_MCLK_HZ;
+}
+
+int main(int argc, char *argv[])
+{
+    hostSimGenerator_t generators[HOST_SIM_MAX_GENERATORS];
+    unsigned int numGenerators = 0;
+    hostSimTiming_t timing;
+    unsigned long timeLimitSeconds = 3600;
+    unsigned long seed = 1;
+    static samplerRing_t samples;
+    hostSimResult_t result;
+    checkpointingObj_t ctx;
+    uint32_t startingChunkSize;
+    uint32_t minChunkSize;
+    uint32_t maxChunkSize;
+    hostSim_t sim;
+    struct timespec hostStart;
+    struct timespec hostEnd;
+    unsigned int i;
+    int opt;
+
+    Checkpointing_Init(&ctx);
+    ctx.sampleIntervalMicroseconds = 0;
+    startingChunkSize = ctx.startingChunkSize;
+    minChunkSize = ctx.minChunkSize;
+    maxChunkSize = ctx.maxChunkSize;
+    HostSim_DefaultTiming(&timing);
+
+    while ((opt = getopt(argc, argv, "g:m:c:b:d:s:f:p:k:r:S:P:a:o:l:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'g':
+            {
+                if ((numGenerators >= HOST_SIM_MAX_GENERATORS) ||
+                    !HostSim_ParseGenerator(optarg, &generators[numGenerators]))
+                {
+                    fprintf(stderr, "bad generator: %s\n", optarg);
+                    return 1;
+                }
+                numGenerators++;
+                break;
+            }
+            case 'm':
+            {
+                ctx.totalWorkloadSizeBytes = 1024ULL * 1024ULL * strtoull(optarg, NULL, 0);
+                break;
+            }
+            case 'c':
+            {
+                startingChunkSize = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'b':
+            {
+                if (!HostSim_ParseChunkBounds(optarg, &minChunkSize, &maxChunkSize))
+                {
+                    fprintf(stderr, "bad chunk size bounds: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'd':
+            {
+                ctx.deadTimeMicroseconds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 's':
+            {
+                ctx.successThresh = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'f':
+            {
+                ctx.failThresh = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'p':
+            {
+                ctx.policy = (workloadScalingPolicy_e)(strtoul(optarg, NULL, 0) % WORKLOAD_SCALING_NUM);
+                break;
+            }
+            case 'k':
+            {
+                ctx.commitMode = (commitMode_e)(strtoul(optarg, NULL, 0) % COMMIT_MODE_NUM);
+                break;
+            }
+            case 'r':
+            {
+                seed = strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'S':
+            {
+                ctx.sampleIntervalMicroseconds = 1000UL * (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'P':
+            {
+                if (!HostSim_LoadProfile(optarg, &timing))
+                {
+                    fprintf(stderr, "bad cost profile: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            }
+            case 'a':
+            {
+                timing.aesBlockCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'o':
+            {
+                timing.chunkOverheadCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'l':
+            {
+                timeLimitSeconds = strtoul(optarg, NULL, 0);
+                break;
+            }
+            default:
+            {
+                HostSimMain_Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+            }
+        }
+    }
+    if (numGenerators == 0)
+    {
+        HostSimMain_Usage(argv[0]);
+        return 1;
+    }
+
+    Checkpointing_SetChunkBounds(&ctx, startingChunkSize, minChunkSize, maxChunkSize);
+    if (!HostSim_IsModelled(&ctx))
+    {
+        fprintf(stderr, "the cost model only covers the AES workload on the blocking engine in ECB mode\n");
+        return 1;
+    }
+
+    HostSim_Init(&sim, seed);
+    sim.samples = &samples;
+    for (i = 0; i < numGenerators; i++)
+    {
+        HostSim_AddGenerator(&sim, &generators[i]);
+    }
+    Checkpointing_Seed(&ctx, (uint32_t)seed);
+
+    Checkpointing_PrintSettings(&ctx);
+
+    clock_gettime(CLOCK_MONOTONIC, &hostStart);
+    HostSim_RunWorkload(&sim, &ctx, &timing, timeLimitSeconds * HOST_MCLK_HZ, &result);
+    clock_gettime(CLOCK_MONOTONIC, &hostEnd);
+
+    printf("%s\n", result.completed ? "Workload complete!" : "Workload timed out!");
+    printf("Processed %llu bytes\n", (unsigned long long)result.bytesProcessed);
+    printf("Took %f s\n", HostSimMain_Seconds(result.elapsedCycles));
+    printf("Chunks completed: %lu\n", (unsigned long)result.chunksCompleted);
+    printf("Chunks failed: %lu\n", (unsigned long)result.chunksFailed);
+    printf("Power losses: %lu\n", (unsigned long)result.powerLosses);
+    printf("Wasted work: %llu bytes, %f s\n", (unsigned long long)result.wastedBytes,
+           HostSimMain_Seconds(result.wastedCycles));
+    Checkpointing_PrintStats(&ctx, (uint32_t)(result.elapsedCycles / HOST_SIM_CYCLES_PER_US));
+    Checkpointing_PrintChunkStats(&ctx);
+    if (ctx.sampleIntervalMicroseconds != 0)
+    {
+        Sampler_Print(&samples);
+    }
+    printf("Host time: %f s\n", (double)(hostEnd.tv_sec - hostStart.tv_sec) +
+                                ((double)(hostEnd.tv_nsec - hostStart.tv_nsec) / 1e9));
+
+    for (i = 0; i < numGenerators; i++)
+    {
+        HostSim_FreeGenerator(&generators[i]);
+    }
+
+    return result.completed ? 0 : 2;
+}
@@ -0,0 +1,582 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Parameter sweep over the discrete-event simulator (host_sim.c).
+ *
+ *   fixture_sweep [options] -g <generator> [-g <generator> ...]
+ *
+ * Runs every combination of the parameter lists below against every
+ * generator, spread over a work-stealing pool (host_pool.c), and writes one
+ * CSV row per run in grid order. Lists are comma separated values or ranges,
+ * e.g. "0,2,4" or "0-7".
+ *
+ *   -c <list>   Starting chunk sizes in bytes (default 1024,512,256,128,64,32,16)
+ *   -b <range>  Chunk size bounds in bytes, <min>-<max> (default 16-1024)
+ *   -s <list>   Success policy change thresholds (default 2)
+ *   -f <list>   Failure policy change thresholds (default 2)
+ *   -d <list>   Dead-times in us (default 1000)
+ *   -p <list>   Workload scaling policies (default 0-7)
+ *   -g <spec>   Power-loss generator, see HostSim_ParseGenerator()
+ *   -n <n>      Runs per configuration, each with its own seed (default 1)
+ *   -r <seed>   First seed (default 1)
+ *   -m <MB>     Total workload size in MB (default 5)
+ *   -P <file>   Cost profile from the fixture's Calibrate menu
+ *   -a <cycles> AES block cost
+ *   -o <cycles> Per-chunk overhead
+ *   -l <s>      Virtual time limit per run (default 3600)
+ *   -j <n>      Worker threads (default one per core)
+ *   -w <file>   Write the CSV here instead of stdout
+ *   -S <pct>    Scaling test: run the grid on 1, 2, 4, ... up to -j workers,
+ *               fail if any run differs from the single worker one or the
+ *               parallel efficiency drops below <pct> percent
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host_pool.h"
+#include "host_sim.h"
+#include "checkpointing_test_fixture.h"
+
+#define HOST_SWEEP_MAX_VALUES   (64)
+
+typedef struct
+{
+    unsigned long values[HOST_SWEEP_MAX_VALUES];
+    unsigned int numValues;
+} hostSweepList_t;
+
+typedef struct
+{
+    hostSweepList_t chunkSizes;
+    hostSweepList_t successThresholds;
+    hostSweepList_t failThresholds;
+    hostSweepList_t deadTimes;
+    hostSweepList_t policies;
+    const char *generatorSpecs[HOST_SIM_MAX_GENERATORS];
+    hostSimGenerator_t generators[HOST_SIM_MAX_GENERATORS];
+    unsigned int numGenerators;
+    unsigned long numSeeds;
+    unsigned long firstSeed;
+    uint64_t totalWorkloadSizeBytes;
+    uint32_t minChunkSize;
+    uint32_t maxChunkSize;
+    hostSimTiming_t timing;
+    uint64_t timeLimitCycles;
+    // One per job
+    hostSimResult_t *results;
+} hostSweep_t;
+
+typedef struct
+{
+    uint32_t chunkSize;
+    uint16_t successThresh;
+    uint16_t failThresh;
+    uint32_t deadTimeMicroseconds;
+    workloadScalingPolicy_e policy;
+    unsigned int generator;
+    unsigned long seed;
+} hostSweepConfig_t;
+
+/**
+ * @brief      Parse a list of values and ranges, e.g. "0,2,4-6"
+ *
+ * @return     false if malformed, empty or too long
+ */
+static bool HostSweep_ParseList(const char *text, hostSweepList_t *list)
+{
+    const char *p = text;
+    char *end;
+    unsigned long first;
+    unsigned long last;
+
+    list->numValues = 0;
+    for (;;)
+    {
+        first = strtoul(p, &end, 0);
+        if (end == p)
+        {
+            return false;
+        }
+        last = first;
+        p = end;
+        if (*p == '-')
+        {
+            p++;
+            last = strtoul(p, &end, 0);
+            if ((end == p) || (last < first))
+            {
+                return false;
+            }
+            p = end;
+        }
+        for (; first <= last; first++)
+        {
+            if (list->numValues >= HOST_SWEEP_MAX_VALUES)
+            {
+                return false;
+            }
+            list->values[list->numValues++] = first;
+        }
+        if (*p == '\0')
+        {
+            return true;
+        }
+        if (*p != ',')
+        {
+            return false;
+        }
+        p++;
+    }
+}
+
+static unsigned int HostSweep_NumJobs(const hostSweep_t *sweep)
+{
+    return sweep->chunkSizes.numValues * sweep->successThresholds.numValues *
+           sweep->failThresholds.numValues * sweep->deadTimes.numValues *
+           sweep->policies.numValues * sweep->numGenerators * (unsigned int)sweep->numSeeds;
+}
+
+/**
+ * @brief      Decode a job index into its point on the grid
+ *
+ * Seeds vary fastest and chunk sizes slowest.
+ */
+static void HostSweep_GetConfig(const hostSweep_t *sweep, unsigned int job, hostSweepConfig_t *config)
+{
+    config->seed = sweep->firstSeed + (job % sweep->numSeeds);
+    job /= (unsigned int)sweep->numSeeds;
+    config->generator = job % sweep->numGenerators;
+    job /= sweep->numGenerators;
+    config->policy = (workloadScalingPolicy_e)sweep->policies.values[job % sweep->policies.numValues];
+    job /= sweep->policies.numValues;
+    config->deadTimeMicroseconds = (uint32_t)sweep->deadTimes.values[job % sweep->deadTimes.numValues];
+    job /= sweep->deadTimes.numValues;
+    config->failThresh = (uint16_t)sweep->failThresholds.values[job % sweep->failThresholds.numValues];
+    job /= sweep->failThresholds.numValues;
+    config->successThresh = (uint16_t)sweep->successThresholds.values[job % sweep->successThresholds.numValues];
+    job /= sweep->successThresholds.numValues;
+    config->chunkSize = (uint32_t)sweep->chunkSizes.values[job];
+}
+
+/**
+ * @brief      Simulate one point of the grid, run in a pool worker
+ */
+static void HostSweep_RunJob(unsigned int job, void *arg)
+{
+    hostSweep_t *sweep = arg;
+    hostSweepConfig_t config;
+    checkpointingObj_t ctx;
+    hostSim_t sim;
+
+    HostSweep_GetConfig(sweep, job, &config);
+
+    Checkpointing_Init(&ctx);
+    ctx.totalWorkloadSizeBytes = sweep->totalWorkloadSizeBytes;
+    Checkpointing_SetChunkBounds(&ctx, config.chunkSize, sweep->minChunkSize, sweep->maxChunkSize);
+    ctx.deadTimeMicroseconds = config.deadTimeMicroseconds;
+    ctx.successThresh = config.successThresh;
+    ctx.failThresh = config.failThresh;
+    ctx.policy = config.policy;
+
+    HostSim_Init(&sim, config.seed);
+    HostSim_AddGenerator(&sim, &sweep->generators[config.generator]);
+    Checkpointing_Seed(&ctx, (uint32_t)config.seed);
+
+    HostSim_RunWorkload(&sim, &ctx, &sweep->timing, sweep->timeLimitCycles, &sweep->results[job]);
+}
+
+/**
+ * @brief      Run the whole grid on a pool of workers
+ *
+ * @return     Host wall-clock seconds taken, or a negative value if the pool
+ *             could not be started
+ */
+static double HostSweep_Run(hostSweep_t *sweep, unsigned int numWorkers)
+{
+    struct timespec hostStart;
+    struct timespec hostEnd;
+    bool ok;
+
+    memset(sweep->results, 0, HostSweep_NumJobs(sweep) * sizeof(*sweep->results));
+    clock_gettime(CLOCK_MONOTONIC, &hostStart);
+    ok = HostPool_Run(HostSweep_NumJobs(sweep), numWorkers, HostSweep_RunJob, sweep);
+    clock_gettime(CLOCK_MONOTONIC, &hostEnd);
+
+    if (!ok)
+    {
+        return -1.0;
+    }
+    return (double)(hostEnd.tv_sec - hostStart.tv_sec) + ((double)(hostEnd.tv_nsec - hostStart.tv_nsec) / 1e9);
+}
+
+static bool HostSweep_SameResult(const hostSimResult_t *a, const hostSimResult_t *b)
+{
+    return (a->bytesProcessed == b->bytesProcessed) &&
+           (a->elapsedCycles == b->elapsedCycles) &&
+           (a->chunksCompleted == b->chunksCompleted) &&
+           (a->chunksFailed == b->chunksFailed) &&
+           (a->powerLosses == b->powerLosses) &&
+           (a->wastedBytes == b->wastedBytes) &&
+           (a->wastedCycles == b->wastedCycles) &&
+           (a->completed == b->completed);
+}
+
+/**
+ * @brief      Check the sweep scales with the number of workers
+ *
+ * Runs the grid on one worker for reference, then on twice as many each time
+ * up to numWorkers. Every run must reproduce the reference results exactly,
+ * since jobs share nothing, and keep speedup / workers at or above
+ * minEfficiency. Leaves the last run's results in sweep->results.
+ *
+ * @return     false on a mismatch, an efficiency below the floor or a pool
+ *             failure
+ */
+static bool HostSweep_CheckScaling(hostSweep_t *sweep, unsigned int numWorkers, double minEfficiency)
+{
+    unsigned int numJobs = HostSweep_NumJobs(sweep);
+    hostSimResult_t *reference;
+    double referenceSeconds;
+    double seconds;
+    double efficiency;
+    unsigned int workers;
+    unsigned int job;
+    bool ok = true;
+
+    reference = malloc(numJobs * sizeof(*reference));
+    if (reference == NULL)
+    {
+        fprintf(stderr, "out of memory for %u results\n", numJobs);
+        return false;
+    }
+
+    referenceSeconds = HostSweep_Run(sweep, 1);
+    if (referenceSeconds < 0.0)
+    {
+        free(reference);
+        return false;
+    }
+    memcpy(reference, sweep->results, numJobs * sizeof(*reference));
+    fprintf(stderr, "%u runs on 1 worker in %f s\n", numJobs, referenceSeconds);
+    if (numWorkers < 2)
+    {
+        fprintf(stderr, "one worker only, nothing to scale\n");
+    }
+
+    for (workers = 2; ok && (workers < 2 * numWorkers); workers *= 2)
+    {
+        if (workers > numWorkers)
+        {
+            workers = numWorkers;
+        }
+        seconds = HostSweep_Run(sweep, workers);
+        if (seconds < 0.0)
+        {
+            ok = false;
+            break;
+        }
+        for (job = 0; job < numJobs; job++)
+        {
+            if (!HostSweep_SameResult(&reference[job], &sweep->results[job]))
+            {
+                fprintf(stderr, "run %u differs on %u workers\n", job, workers);
+                ok = false;
+            }
+        }
+        efficiency = (seconds > 0.0) ? (referenceSeconds / seconds) / (double)workers : 0.0;
+        fprintf(stderr, "%u runs on %u workers in %f s, speedup %.2f, efficiency %.0f%%%s\n", numJobs, workers,
+                seconds, referenceSeconds / seconds, 100.0 * efficiency,
+                (efficiency < minEfficiency) ? " (below the floor)" : "");
+        if (efficiency < minEfficiency)
+        {
+            ok = false;
+        }
+    }
+
+    free(reference);
+    return ok;
+}
+
+static void HostSweep_WriteCsv(const hostSweep_t *sweep, FILE *out)
+{
+    unsigned int numJobs = HostSweep_NumJobs(sweep);
+    hostSweepConfig_t config;
+    const hostSimResult_t *result;
+    double seconds;
+    unsigned int job;
+
+    fprintf(out, "policy,starting_chunk_bytes,success_thresh,fail_thresh,dead_time_us,generator,seed,"
+                 "completed,bytes_processed,completion_s,goodput_Bps,wasted_bytes,wasted_s,"
+                 "chunks_completed,chunks_failed,power_losses\n");
+    for (job = 0; job < numJobs; job++)
+    {
+        HostSweep_GetConfig(sweep, job, &config);
+        result = &sweep->results[job];
+        seconds = (double)result->elapsedCycles / (double)HOST_MCLK_HZ;
+        fprintf(out, "%u,%u,%u,%u,%lu,\"%s\",%lu,%d,%llu,%.6f,%.1f,%llu,%.6f,%lu,%lu,%lu\n",
+                (unsigned int)config.policy,
+                (unsigned int)config.chunkSize,
+                (unsigned int)config.successThresh,
+                (unsigned int)config.failThresh,
+                (unsigned long)config.deadTimeMicroseconds,
+                sweep->generatorSpecs[config.generator],
+                config.seed,
+                result->completed ? 1 : 0,
+                (unsigned long long)result->bytesProcessed,
+                seconds,
+                (seconds > 0.0) ? ((double)result->bytesProcessed / seconds) : 0.0,
+                (unsigned long long)result->wastedBytes,
+                (double)result->wastedCycles / (double)HOST_MCLK_HZ,
+                (unsigned long)result->chunksCompleted,
+                (unsigned long)result->chunksFailed,
+                (unsigned long)result->powerLosses);
+    }
+}
+
+static void HostSweep_Usage(const char *name)
+{
+    fprintf(stderr,
+            "usage: %s [-c list] [-b min-max] [-s list] [-f list] [-d list] [-p list] [-n runs] [-r seed]\n"
+            "       [-m MB] [-P profile] [-a cycles] [-o cycles] [-l s] [-j workers] [-w file]\n"
+            "       [-S efficiency%%] -g generator [-g generator ...]\n",
+            name);
+}
+
+int main(int argc, char *argv[])
+{
+    static hostSweep_t sweep;
+    unsigned long timeLimitSeconds = 3600;
+    unsigned int numWorkers = 0;
+    const char *outPath = NULL;
+    double minEfficiency = -1.0;
+    double seconds;
+    unsigned int numJobs;
+    FILE *out = stdout;
+    bool ok;
+    unsigned int i;
+    int opt;
+
+    HostSweep_ParseList("1024,512,256,128,64,32,16", &sweep.chunkSizes);
+    HostSweep_ParseList("2", &sweep.successThresholds);
+    HostSweep_ParseList("2", &sweep.failThresholds);
+    HostSweep_ParseList("1000", &sweep.deadTimes);
+    HostSweep_ParseList("0-7", &sweep.policies);
+    sweep.numSeeds = 1;
+    sweep.firstSeed = 1;
+    sweep.totalWorkloadSizeBytes = 5 * 1024ULL * 1024ULL;
+    HostSim_ParseChunkBounds("16-1024", &sweep.minChunkSize, &sweep.maxChunkSize);
+    HostSim_DefaultTiming(&sweep.timing);
+
+    while ((opt = getopt(argc, argv, "c:b:s:f:d:p:g:n:r:m:P:a:o:l:j:w:S:h")) != -1)
+    {
+        ok = true;
+        switch (opt)
+        {
+            case 'c':
+            {
+                ok = HostSweep_ParseList(optarg, &sweep.chunkSizes);
+                break;
+            }
+            case 'b':
+            {
+                ok = HostSim_ParseChunkBounds(optarg, &sweep.minChunkSize, &sweep.maxChunkSize);
+                break;
+            }
+            case 's':
+            {
+                ok = HostSweep_ParseList(optarg, &sweep.successThresholds);
+                break;
+            }
+            case 'f':
+            {
+                ok = HostSweep_ParseList(optarg, &sweep.failThresholds);
+                break;
+            }
+            case 'd':
+            {
+                ok = HostSweep_ParseList(optarg, &sweep.deadTimes);
+                break;
+            }
+            case 'p':
+            {
+                ok = HostSweep_ParseList(optarg, &sweep.policies);
+                break;
+            }
+            case 'g':
+            {
+                ok = (sweep.numGenerators < HOST_SIM_MAX_GENERATORS) &&
+                     HostSim_ParseGenerator(optarg, &sweep.generators[sweep.numGenerators]);
+                if (ok)
+                {
+                    sweep.generatorSpecs[sweep.numGenerators++] = optarg;
+                }
+                break;
+            }
+            case 'n':
+            {
+                sweep.numSeeds = strtoul(optarg, NULL, 0);
+                ok = (sweep.numSeeds != 0);
+                break;
+            }
+            case 'r':
+            {
+                sweep.firstSeed = strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'm':
+            {
+                sweep.totalWorkloadSizeBytes = 1024ULL * 1024ULL * strtoull(optarg, NULL, 0);
+                break;
+            }
+            case 'P':
+            {
+                ok = HostSim_LoadProfile(optarg, &sweep.timing);
+                break;
+            }
+            case 'a':
+            {
+                sweep.timing.aesBlockCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'o':
+            {
+                sweep.timing.chunkOverheadCycles = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'l':
+            {
+                timeLimitSeconds = strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'j':
+            {
+                numWorkers = (unsigned int)strtoul(optarg, NULL, 0);
+                break;
+            }
+            case 'w':
+            {
+                outPath = optarg;
+                break;
+            }
+            case 'S':
+            {
+                minEfficiency = strtod(optarg, NULL) / 100.0;
+                ok = (minEfficiency >= 0.0);
+                break;
+            }
+            default:
+            {
+                HostSweep_Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+            }
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "bad value for -%c: %s\n", opt, optarg);
+            return 1;
+        }
+    }
+    if (sweep.numGenerators == 0)
+    {
+        HostSweep_Usage(argv[0]);
+        return 1;
+    }
+    for (i = 0; i < sweep.chunkSizes.numValues; i++)
+    {
+        if ((sweep.chunkSizes.values[i] < sweep.minChunkSize) || (sweep.chunkSizes.values[i] > sweep.maxChunkSize) ||
+            ((sweep.chunkSizes.values[i] % AES_MINIMUM_CHUNK_SIZE) != 0))
+        {
+            fprintf(stderr, "bad chunk size: %lu\n", sweep.chunkSizes.values[i]);
+            return 1;
+        }
+    }
+    for (i = 0; i < sweep.policies.numValues; i++)
+    {
+        if (sweep.policies.values[i] >= WORKLOAD_SCALING_NUM)
+        {
+            fprintf(stderr, "bad policy: %lu\n", sweep.policies.values[i]);
+            return 1;
+        }
+    }
+    sweep.timeLimitCycles = timeLimitSeconds * HOST_MCLK_HZ;
+
+    numJobs = HostSweep_NumJobs(&sweep);
+    sweep.results = calloc(numJobs, sizeof(*sweep.results));
+    if (sweep.results == NULL)
+    {
+        fprintf(stderr, "out of memory for %u results\n", numJobs);
+        return 1;
+    }
+    if (numWorkers == 0)
+    {
+        numWorkers = HostPool_DefaultWorkers();
+    }
+
+    if (minEfficiency >= 0.0)
+    {
+        if (!HostSweep_CheckScaling(&sweep, numWorkers, minEfficiency))
+        {
+            fprintf(stderr, "sweep does not scale\n");
+            return 1;
+        }
+    }
+    else
+    {
+        seconds = HostSweep_Run(&sweep, numWorkers);
+        if (seconds < 0.0)
+        {
+            fprintf(stderr, "sweep failed\n");
+            return 1;
+        }
+        fprintf(stderr, "%u runs on %u workers in %f s\n", numJobs, numWorkers, seconds);
+    }
+
+    if (outPath != NULL)
+    {
+        out = fopen(outPath, "w");
+        if (out == NULL)
+        {
+            perror(outPath);
+            return 1;
+        }
+    }
+    HostSweep_WriteCsv(&sweep, out);
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+
+    free(sweep.results);
+    for (i = 0; i < sweep.numGenerators; i++)
+    {
+        HostSim_FreeGenerator(&sweep.generators[i]);
+    }
+
+    return 0;
+}
@@ -0,0 +1,280 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Timer_A0, Timer_A1 and Timer_B0 models. The counter is derived from the CPU cycle
+ * count, using the clock source and input dividers programmed into TxCTL and
+ * TxEX0. Only the up and continuous modes are modelled; each rollover raises
+ * TxIFG once, and each time the counter reaches TxCCR0 raises CCIFG in
+ * TxCCTL0. Timer_A and Timer_B share the register layout used here.
+ */
+
+#include <stddef.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+#include "host_cpu.h"
+
+#define HOST_TIMER_SIZE         (0x30)
+
+typedef struct
+{
+    // Register block of this timer
+    uint16_t baseAddress;
+    // Vector of TxIFG, and of CCR0's CCIFG or -1 if not wired up
+    int overflowVector;
+    int ccr0Vector;
+    // Cycle count when the counter was (re)started
+    uint64_t startCycles;
+    // Rollovers flagged so far
+    uint64_t rollovers;
+    // Ticks up to which CCR0 matches have been looked for
+    uint64_t compareTicks;
+} hostTimer_t;
+
+static hostTimer_t hostTimerA0State = {TIMER_A0_BASE, TIMER0_A1_VECTOR, -1};
+static hostTimer_t hostTimerA1State = {TIMER_A1_BASE, -1, -1};
+static hostTimer_t hostTimerB0State = {TIMER_B0_BASE, -1, TIMER0_B0_VECTOR};
+
+static uint16_t HostTimer_Reg(const hostTimer_t *timer, uint16_t offset)
+{
+    return HostRegs_Read16(timer->baseAddress + offset);
+}
+
+static uint32_t HostTimer_Divider(const hostTimer_t *timer)
+{
+    uint16_t ctl = HostTimer_Reg(timer, OFS_TAxCTL);
+    return (1UL << ((ctl >> 6) & 0x3)) * ((HostTimer_Reg(timer, OFS_TAxEX0) & TAIDEX_7) + 1);
+}
+
+static uint32_t HostTimer_Period(const hostTimer_t *timer)
+{
+    if ((HostTimer_Reg(timer, OFS_TAxCTL) & MC_3) == MC_1)
+    {
+        return (uint32_t)HostTimer_Reg(timer, OFS_TAxCCR0) + 1;
+    }
+
+    return 0x10000UL;
+}
+
+/**
+ * @brief      Number of timer ticks since the counter was (re)started
+ */
+static uint64_t HostTimer_Ticks(const hostTimer_t *timer)
+{
+    uint64_t cycles = HostCpu_GetCycles() - timer->startCycles;
+
+    if ((HostTimer_Reg(timer, OFS_TAxCTL) & TASSEL__INCLK) == TASSEL__ACLK)
+    {
+        cycles = (cycles * HOST_ACLK_HZ) / HOST_MCLK_HZ;
+    }
+
+    return cycles / HostTimer_Divider(timer);
+}
+
+static void HostTimer_Restart(hostTimer_t *timer)
+{
+    timer->startCycles = HostCpu_GetCycles();
+    timer->rollovers = 0;
+    timer->compareTicks = 0;
+}
+
+static void HostTimer_Read(hostTimer_t *timer, uint16_t offset)
+{
+    if ((offset == OFS_TAxR) && ((HostTimer_Reg(timer, OFS_TAxCTL) & MC_3) != MC_0))
+    {
+        HostRegs_Write16(timer->baseAddress + OFS_TAxR,
+                         (uint16_t)(HostTimer_Ticks(timer) % HostTimer_Period(timer)));
+    }
+}
+
+static void HostTimer_Write(hostTimer_t *timer, uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    if (offset == OFS_TAxCTL)
+    {
+        if ((newValue & TACLR) != 0)
+        {
+            // TACLR resets the counter and divider logic, and reads back as 0
+            HostRegs_Write16(timer->baseAddress + OFS_TAxCTL, newValue & ~TACLR);
+            HostTimer_Restart(timer);
+        }
+        else if (((oldValue & MC_3) == MC_0) && ((newValue & MC_3) != MC_0))
+        {
+            HostTimer_Restart(timer);
+        }
+    }
+}
+
+static void HostTimer_Service(hostTimer_t *timer)
+{
+    uint16_t ctl = HostTimer_Reg(timer, OFS_TAxCTL);
+    uint32_t period;
+    uint64_t ticks;
+    uint64_t match;
+
+    if ((ctl & MC_3) == MC_0)
+    {
+        return;
+    }
+    period = HostTimer_Period(timer);
+    ticks = HostTimer_Ticks(timer);
+
+    // Raise TxIFG once per rollover. If the service routine fell behind, the
+    // next rollover is flagged as soon as it clears the previous one.
+    if (((ctl & TAIFG) == 0) && ((ticks / period) > timer->rollovers))
+    {
+        timer->rollovers++;
+        HostRegs_Write16(timer->baseAddress + OFS_TAxCTL, ctl | TAIFG);
+    }
+
+    // Raise CCIFG if the counter went through TxCCR0 since the last look
+    if (ticks > timer->compareTicks)
+    {
+        match = timer->compareTicks - (timer->compareTicks % period) +
+                (HostTimer_Reg(timer, OFS_TAxCCR0) % period);
+        if (match <= timer->compareTicks)
+        {
+            match += period;
+        }
+        if (match <= ticks)
+        {
+            HostRegs_Write16(timer->baseAddress + OFS_TAxCCTL0,
+                             HostTimer_Reg(timer, OFS_TAxCCTL0) | CCIFG);
+        }
+        timer->compareTicks = ticks;
+    }
+}
+
+static int HostTimer_PendingVector(const hostTimer_t *timer)
+{
+    uint16_t ctl = HostTimer_Reg(timer, OFS_TAxCTL);
+    uint16_t cctl0 = HostTimer_Reg(timer, OFS_TAxCCTL0);
+
+    if ((timer->ccr0Vector >= 0) && ((cctl0 & CCIFG) != 0) && ((cctl0 & CCIE) != 0))
+    {
+        return timer->ccr0Vector;
+    }
+    if ((timer->overflowVector >= 0) && ((ctl & TAIFG) != 0) && ((ctl & TAIE) != 0))
+    {
+        return timer->overflowVector;
+    }
+
+    return -1;
+}
+
+static void HostTimerA0_Read(uint16_t offset)
+{
+    HostTimer_Read(&hostTimerA0State, offset);
+}
+
+static void HostTimerA0_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    HostTimer_Write(&hostTimerA0State, offset, oldValue, newValue);
+}
+
+static void HostTimerA0_Service(void)
+{
+    HostTimer_Service(&hostTimerA0State);
+}
+
+static int HostTimerA0_PendingVector(void)
+{
+    return HostTimer_PendingVector(&hostTimerA0State);
+}
+
+static void HostTimerA1_Read(uint16_t offset)
+{
+    HostTimer_Read(&hostTimerA1State, offset);
+}
+
+static void HostTimerA1_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    HostTimer_Write(&hostTimerA1State, offset, oldValue, newValue);
+}
+
+static void HostTimerA1_Service(void)
+{
+    HostTimer_Service(&hostTimerA1State);
+}
+
+static int HostTimerA1_PendingVector(void)
+{
+    return HostTimer_PendingVector(&hostTimerA1State);
+}
+
+static void HostTimerB0_Read(uint16_t offset)
+{
+    HostTimer_Read(&hostTimerB0State, offset);
+}
+
+static void HostTimerB0_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    HostTimer_Write(&hostTimerB0State, offset, oldValue, newValue);
+}
+
+static void HostTimerB0_Service(void)
+{
+    HostTimer_Service(&hostTimerB0State);
+}
+
+static int HostTimerB0_PendingVector(void)
+{
+    return HostTimer_PendingVector(&hostTimerB0State);
+}
+
+const hostPeripheral_t hostTimerA0 =
+{
+    "Timer_A0",
+    TIMER_A0_BASE,
+    HOST_TIMER_SIZE,
+    NULL,
+    HostTimerA0_Read,
+    HostTimerA0_Write,
+    HostTimerA0_Service,
+    HostTimerA0_PendingVector,
+};
+
+const hostPeripheral_t hostTimerA1 =
+{
+    "Timer_A1",
+    TIMER_A1_BASE,
+    HOST_TIMER_SIZE,
+    NULL,
+    HostTimerA1_Read,
+    HostTimerA1_Write,
+    HostTimerA1_Service,
+    HostTimerA1_PendingVector,
+};
+
+const hostPeripheral_t hostTimerB0 =
+{
+    "Timer_B0",
+    TIMER_B0_BASE,
+    HOST_TIMER_SIZE,
+    NULL,
+    HostTimerB0_Read,
+    HostTimerB0_Write,
+    HostTimerB0_Service,
+    HostTimerB0_PendingVector,
+};
@@ -0,0 +1,180 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * eUSCI_A0 model in UART mode. Transmitted bytes go straight out to a host file
+ * descriptor (stdout or a pseudo-terminal) and received bytes are polled from
+ * another one, so the fixture's console works unmodified. Transmission is
+ * instantaneous, UCTXIFG always reads set.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "driverlib.h"
+#include "host_board.h"
+
+#define HOST_UART_A0_SIZE           (0x20)
+// Back-to-back polls of UCA0IFG with nothing else in between means the CPU is
+// spinning on the receiver. Past this many, block briefly on the host instead.
+#define HOST_UART_IDLE_POLLS        (1000)
+#define HOST_UART_IDLE_TIMEOUT_MS   (1)
+
+static int hostUartInFd = -1;
+static int hostUartOutFd = -1;
+static bool hostUartRxValid;
+static uint8_t hostUartRxByte;
+static bool hostUartLastWasCr;
+static uint32_t hostUartLastPoll;
+static uint32_t hostUartIdlePolls;
+
+static void HostUartA0_SetFlags(uint16_t set, uint16_t clear)
+{
+    uint16_t ifg = HostRegs_Read16(EUSCI_A0_BASE + OFS_UCAxIFG);
+    HostRegs_Write16(EUSCI_A0_BASE + OFS_UCAxIFG, (ifg | set) & ~clear);
+}
+
+/**
+ * @brief      Pull the next received byte from the host, if there is one
+ */
+static void HostUartA0_Poll(void)
+{
+    struct pollfd pfd;
+    uint32_t accessCount = HostRegs_GetAccessCount();
+    uint8_t c;
+    ssize_t n;
+
+    if (hostUartRxValid || (hostUartInFd < 0))
+    {
+        return;
+    }
+
+    hostUartIdlePolls = (accessCount == (hostUartLastPoll + 1)) ? (hostUartIdlePolls + 1) : 0;
+    hostUartLastPoll = accessCount;
+
+    pfd.fd = hostUartInFd;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, (hostUartIdlePolls > HOST_UART_IDLE_POLLS) ? HOST_UART_IDLE_TIMEOUT_MS : 0) <= 0)
+    {
+        return;
+    }
+
+    n = read(hostUartInFd, &c, 1);
+    if (n == 0)
+    {
+        // Nobody left to type to us, there is no point spinning forever
+        fprintf(stderr, "host: UART input closed\n");
+        exit(0);
+    }
+    if (n < 0)
+    {
+        return;
+    }
+
+    // A serial terminal sends a lone CR for enter, fold host line endings into that
+    if ((c == '\n') && hostUartLastWasCr)
+    {
+        hostUartLastWasCr = false;
+        return;
+    }
+    hostUartLastWasCr = (c == '\r');
+    hostUartRxByte = (c == '\n') ? '\r' : c;
+    hostUartRxValid = true;
+    HostUartA0_SetFlags(UCRXIFG, 0);
+}
+
+static uint8_t HostUartA0_RegFlags(uint16_t offset)
+{
+    switch (offset)
+    {
+        case OFS_UCAxTXBUF:
+            return HOST_REG_WRITE_FIFO;
+        case OFS_UCAxRXBUF:
+            return HOST_REG_READ_FIFO;
+        default:
+            return HOST_REG_PLAIN;
+    }
+}
+
+static void HostUartA0_Read(uint16_t offset)
+{
+    switch (offset)
+    {
+        case OFS_UCAxIFG:
+        {
+            HostUartA0_Poll();
+            HostUartA0_SetFlags(UCTXIFG, 0);
+            break;
+        }
+        case OFS_UCAxRXBUF:
+        {
+            HostUartA0_Poll();
+            HostRegs_Write16(EUSCI_A0_BASE + OFS_UCAxRXBUF, hostUartRxByte);
+            hostUartRxValid = false;
+            HostUartA0_SetFlags(0, UCRXIFG);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void HostUartA0_Write(uint16_t offset, uint16_t oldValue, uint16_t newValue)
+{
+    uint8_t c = (uint8_t)newValue;
+
+    if ((offset == OFS_UCAxTXBUF) && (hostUartOutFd >= 0))
+    {
+        while ((write(hostUartOutFd, &c, 1) < 0) && (errno == EINTR));
+    }
+}
+
+/**
+ * @brief      Connect the UART to host file descriptors
+ *
+ * @param[in]  inFd   Where received bytes come from (-1 for nothing)
+ * @param[in]  outFd  Where transmitted bytes go (-1 to discard)
+ */
+void HostUart_Init(int inFd, int outFd)
+{
+    hostUartInFd = inFd;
+    hostUartOutFd = outFd;
+    hostUartRxValid = false;
+    HostUartA0_SetFlags(UCTXIFG, UCRXIFG);
+}
+
+const hostPeripheral_t hostUartA0 =
+{
+    "eUSCI_A0",
+    EUSCI_A0_BASE,
+    HOST_UART_A0_SIZE,
+    HostUartA0_RegFlags,
+    HostUartA0_Read,
+    HostUartA0_Write,
+    NULL,
+    NULL,
+};
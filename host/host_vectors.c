@@ -0,0 +1,48 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Interrupt vector table for the host build of the fixture. Plays the part of
+ * the "#pragma vector" bindings in interrupts.c, which the host compiler
+ * ignores.
+ */
+
+#include "driverlib.h"
+#include "host_cpu.h"
+
+// Service routines defined in interrupts.c
+void PORT8_ISR(void);
+void TIMER0_A1_ISR(void);
+void TIMER0_B0_ISR(void);
+void AES256_ISR(void);
+void DMA_ISR(void);
+
+const hostIsr_t hostVectorTable[HOST_NUM_VECTORS] =
+{
+    [PORT8_VECTOR] = PORT8_ISR,
+    [TIMER0_A1_VECTOR] = TIMER0_A1_ISR,
+    [TIMER0_B0_VECTOR] = TIMER0_B0_ISR,
+    [AES256_VECTOR] = AES256_ISR,
+    [DMA_VECTOR] = DMA_ISR,
+};
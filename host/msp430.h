@@ -0,0 +1,639 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Host stand-in for the MSP430FR5994 device header. Only the peripherals that
+ * the fixture and the driverlib modules built by host/Makefile touch are
+ * described here. Base addresses and bit positions follow the device header so
+ * that the real driverlib sources compile and behave unmodified against the
+ * simulated register file in host_regs.c.
+ */
+
+#ifndef HOST_MSP430_H
+#define HOST_MSP430_H
+
+#include <stdint.h>
+
+/*
+ * Intrinsics
+ */
+#define __interrupt
+void HostCpu_EnableInterrupts(void);
+void HostCpu_DisableInterrupts(void);
+unsigned short HostCpu_GetInterruptState(void);
+void HostCpu_SetInterruptState(unsigned short state);
+void HostCpu_Nop(void);
+void HostCpu_DelayCycles(uint32_t cycles);
+void HostCpu_SetStatusBits(uint16_t bits);
+void HostCpu_ClearStatusBitsOnExit(uint16_t bits);
+#define __enable_interrupt()    HostCpu_EnableInterrupts()
+#define __disable_interrupt()   HostCpu_DisableInterrupts()
+#define __get_interrupt_state() HostCpu_GetInterruptState()
+#define __set_interrupt_state(x) HostCpu_SetInterruptState(x)
+#define __no_operation()        HostCpu_Nop()
+#define __delay_cycles(x)       HostCpu_DelayCycles(x)
+#define __bis_SR_register(x)    HostCpu_SetStatusBits(x)
+#define __bic_SR_register_on_exit(x) HostCpu_ClearStatusBitsOnExit(x)
+// Address registers take the host address, see host_dma.c
+#define __data16_write_addr(addr, src) \
+    do { HWREG32(addr) = (uint32_t)(src); } while (0)
+
+/*
+ * Status register
+ */
+#define GIE                     (0x0008)
+#define CPUOFF                  (0x0010)
+#define OSCOFF                  (0x0020)
+#define SCG0                    (0x0040)
+#define SCG1                    (0x0080)
+#define LPM0_bits               (CPUOFF)
+
+/*
+ * Interrupt vectors (indices into the host vector table, see host_regs.h)
+ */
+#define PORT8_VECTOR            (0)
+#define TIMER0_A1_VECTOR        (1)
+#define TIMER0_B0_VECTOR        (2)
+#define AES256_VECTOR           (3)
+#define DMA_VECTOR              (4)
+#define HOST_NUM_VECTORS        (5)
+
+/*
+ * Peripherals present
+ */
+#define __MSP430_HAS_SFR__
+#define __MSP430_BASEADDRESS_SFR__          0x0100
+#define __MSP430_HAS_PMM_FRAM__
+#define __MSP430_BASEADDRESS_PMM_FRAM__     0x0120
+#define __MSP430_HAS_FRAM__
+#define __MSP430_BASEADDRESS_FRAM__         0x0140
+#define __MSP430_HAS_CS__
+#define __MSP430_BASEADDRESS_CS__           0x0160
+#define __MSP430_HAS_WDT_A__
+#define __MSP430_BASEADDRESS_WDT_A__        0x015C
+#define __MSP430_HAS_PORTA_R__
+#define __MSP430_HAS_PORT1_R__
+#define __MSP430_BASEADDRESS_PORT1_R__      0x0200
+#define __MSP430_HAS_PORT2_R__
+#define __MSP430_BASEADDRESS_PORT2_R__      0x0200
+#define __MSP430_HAS_PORT3_R__
+#define __MSP430_BASEADDRESS_PORT3_R__      0x0220
+#define __MSP430_HAS_PORT4_R__
+#define __MSP430_BASEADDRESS_PORT4_R__      0x0220
+#define __MSP430_HAS_PORT5_R__
+#define __MSP430_BASEADDRESS_PORT5_R__      0x0240
+#define __MSP430_HAS_PORT6_R__
+#define __MSP430_BASEADDRESS_PORT6_R__      0x0240
+#define __MSP430_HAS_PORT7_R__
+#define __MSP430_BASEADDRESS_PORT7_R__      0x0260
+#define __MSP430_HAS_PORT8_R__
+#define __MSP430_BASEADDRESS_PORT8_R__      0x0260
+#define __MSP430_HAS_PORTJ_R__
+#define __MSP430_BASEADDRESS_PORTJ_R__      0x0320
+#define __MSP430_HAS_TxA7__
+#define __MSP430_HAS_T0A3__
+#define __MSP430_BASEADDRESS_T0A3__         0x0340
+#define __MSP430_HAS_T1A3__
+#define __MSP430_BASEADDRESS_T1A3__         0x0380
+#define __MSP430_HAS_TxB7__
+#define __MSP430_HAS_T0B7__
+#define __MSP430_BASEADDRESS_T0B7__         0x03C0
+#define __MSP430_HAS_EUSCI_Ax__
+#define __MSP430_HAS_EUSCI_A0__
+#define __MSP430_BASEADDRESS_EUSCI_A0__     0x05C0
+#define __MSP430_HAS_DMAX_6__
+#define __MSP430_BASEADDRESS_DMAX_6__       0x0500
+#define __MSP430_HAS_AES256__
+#define __MSP430_BASEADDRESS_AES256__       0x09C0
+#define __MSP430_HAS_CRC32__
+#define __MSP430_BASEADDRESS_CRC32__        0x0980
+#define __MSP430_HAS_MPY32__
+#define __MSP430_BASEADDRESS_MPY32__        0x04C0
+#define __MSP430_HAS_ADC12_B__
+#define __MSP430_BASEADDRESS_ADC12_B__      0x0800
+
+#define SFR_BASE        __MSP430_BASEADDRESS_SFR__
+#define PMM_BASE        __MSP430_BASEADDRESS_PMM_FRAM__
+#define CS_BASE         __MSP430_BASEADDRESS_CS__
+#define WDT_A_BASE      __MSP430_BASEADDRESS_WDT_A__
+#define TIMER_A0_BASE   __MSP430_BASEADDRESS_T0A3__
+#define TIMER_A1_BASE   __MSP430_BASEADDRESS_T1A3__
+#define TIMER_B0_BASE   __MSP430_BASEADDRESS_T0B7__
+#define EUSCI_A0_BASE   __MSP430_BASEADDRESS_EUSCI_A0__
+#define DMA_BASE        __MSP430_BASEADDRESS_DMAX_6__
+#define AES256_BASE     __MSP430_BASEADDRESS_AES256__
+#define FRAM_BASE       __MSP430_BASEADDRESS_FRAM__
+#define CRC32_BASE      __MSP430_BASEADDRESS_CRC32__
+#define MPY32_BASE      __MSP430_BASEADDRESS_MPY32__
+#define ADC12_B_BASE    __MSP430_BASEADDRESS_ADC12_B__
+
+/*
+ * Special function registers
+ */
+#define OFS_SFRIE1              (0x0000)
+#define OFS_SFRIE1_L            OFS_SFRIE1
+#define OFS_SFRIFG1             (0x0002)
+#define OFS_SFRIFG1_L           OFS_SFRIFG1
+#define OFS_SFRRPCR             (0x0004)
+#define OFS_SFRRPCR_L           OFS_SFRRPCR
+#define WDTIE                   (0x0001)
+#define OFIE                    (0x0002)
+#define VMAIE                   (0x0008)
+#define NMIIE                   (0x0010)
+#define JMBINIE                 (0x0040)
+#define JMBOUTIE                (0x0080)
+#define WDTIFG                  (0x0001)
+#define OFIFG                   (0x0002)
+#define SYSNMI                  (0x0001)
+#define SYSNMIIES               (0x0002)
+#define SYSRSTUP                (0x0004)
+#define SYSRSTRE                (0x0008)
+
+/*
+ * Power management module
+ */
+#define OFS_PMMCTL0             (0x0000)
+#define OFS_PMMCTL0_L           OFS_PMMCTL0
+#define OFS_PMMCTL0_H           (0x0001)
+#define OFS_PMMIFG              (0x000A)
+#define OFS_PM5CTL0             (0x0010)
+#define PM5CTL0                 HWREG16(PMM_BASE + OFS_PM5CTL0)
+#define PMMPW                   (0xA500)
+#define PMMPW_H                 (0xA5)
+#define PMMSWBOR                (0x0004)
+#define PMMSWPOR                (0x0008)
+#define PMMREGOFF               (0x0010)
+#define SVSHE                   (0x0040)
+#define PMMBORIFG               (0x0100)
+#define PMMRSTIFG               (0x0200)
+#define PMMPORIFG               (0x0400)
+#define SVSHIFG                 (0x2000)
+#define PMMLPM5IFG              (0x8000)
+#define LOCKLPM5                (0x0001)
+
+/*
+ * Clock system
+ */
+#define OFS_CSCTL0              (0x0000)
+#define OFS_CSCTL0_H            (0x0001)
+#define OFS_CSCTL1              (0x0002)
+#define OFS_CSCTL2              (0x0004)
+#define OFS_CSCTL3              (0x0006)
+#define OFS_CSCTL4              (0x0008)
+#define OFS_CSCTL4_L            OFS_CSCTL4
+#define OFS_CSCTL5              (0x000A)
+#define OFS_CSCTL6              (0x000C)
+#define CSKEY                   (0xA500)
+#define CSKEY_H                 (0xA5)
+#define DCORSEL                 (0x0040)
+#define DCOFSEL_0               (0x0000)
+#define DCOFSEL_1               (0x0002)
+#define DCOFSEL_2               (0x0004)
+#define DCOFSEL_3               (0x0006)
+#define DCOFSEL_4               (0x0008)
+#define DCOFSEL_5               (0x000A)
+#define DCOFSEL_6               (0x000C)
+#define DCOFSEL_7               (0x000E)
+#define SELM_7                  (0x0007)
+#define SELM__LFXTCLK           (0x0000)
+#define SELM__VLOCLK            (0x0001)
+#define SELM__LFMODOSC          (0x0002)
+#define SELM__DCOCLK            (0x0003)
+#define SELM__MODOSC            (0x0004)
+#define SELM__HFXTCLK           (0x0005)
+#define SELS_7                  (0x0070)
+#define SELA_7                  (0x0700)
+#define DIVM0                   (0x0001)
+#define DIVM1                   (0x0002)
+#define DIVM2                   (0x0004)
+#define DIVM__1                 (0x0000)
+#define DIVM__2                 (0x0001)
+#define DIVM__4                 (0x0002)
+#define DIVM__8                 (0x0003)
+#define DIVM__16                (0x0004)
+#define DIVM__32                (0x0005)
+#define DIVS0                   (0x0010)
+#define DIVS1                   (0x0020)
+#define DIVS2                   (0x0040)
+#define DIVA0                   (0x0100)
+#define DIVA1                   (0x0200)
+#define DIVA2                   (0x0400)
+#define LFXTOFF                 (0x0001)
+#define SMCLKOFF                (0x0002)
+#define VLOOFF                  (0x0008)
+#define LFXTBYPASS              (0x0010)
+#define LFXTDRIVE0              (0x0040)
+#define LFXTDRIVE0_L            LFXTDRIVE0
+#define LFXTDRIVE1              (0x0080)
+#define LFXTDRIVE1_L            LFXTDRIVE1
+#define LFXTDRIVE_0             (0x0000)
+#define LFXTDRIVE_1             (0x0040)
+#define LFXTDRIVE_2             (0x0080)
+#define LFXTDRIVE_3             (0x00C0)
+#define HFXTOFF                 (0x0100)
+#define HFFREQ_1                (0x0400)
+#define HFFREQ_2                (0x0800)
+#define HFFREQ_3                (0x0C00)
+#define HFXTBYPASS              (0x1000)
+#define HFXTDRIVE_0             (0x0000)
+#define HFXTDRIVE_1             (0x4000)
+#define HFXTDRIVE_2             (0x8000)
+#define HFXTDRIVE_3             (0xC000)
+#define LFXTOFFG                (0x0001)
+#define HFXTOFFG                (0x0002)
+#define MODCLKREQEN             (0x0008)
+
+/*
+ * Watchdog timer
+ */
+#define OFS_WDTCTL              (0x0000)
+#define WDTPW                   (0x5A00)
+#define WDTHOLD                 (0x0080)
+#define WDTTMSEL                (0x0010)
+#define WDTCNTCL                (0x0008)
+
+/*
+ * Digital I/O (port pairs share one 16-bit register block)
+ */
+#define OFS_PAIN                (0x0000)
+#define OFS_PAOUT               (0x0002)
+#define OFS_PADIR               (0x0004)
+#define OFS_PAREN               (0x0006)
+#define OFS_PASEL0              (0x000A)
+#define OFS_PASEL1              (0x000C)
+#define OFS_PAIES               (0x0018)
+#define OFS_PAIE                (0x001A)
+#define OFS_PAIFG               (0x001C)
+#define OFS_PAIFG_H             (0x001D)
+
+/*
+ * Timer_A
+ */
+#define OFS_TAxCTL              (0x0000)
+#define OFS_TAxCCTL0            (0x0002)
+#define OFS_TAxR                (0x0010)
+#define OFS_TAxCCR0             (0x0012)
+#define OFS_TAxEX0              (0x0020)
+#define OFS_TAxIV               (0x002E)
+#define TAIFG                   (0x0001)
+#define TAIE                    (0x0002)
+#define TACLR                   (0x0004)
+#define MC_0                    (0x0000)
+#define MC_1                    (0x0010)
+#define MC_2                    (0x0020)
+#define MC_3                    (0x0030)
+#define ID__8                   (0x00C0)
+#define TASSEL__TACLK           (0x0000)
+#define TASSEL__ACLK            (0x0100)
+#define TASSEL__SMCLK           (0x0200)
+#define TASSEL__INCLK           (0x0300)
+#define TAIDEX_7                (0x0007)
+#define CCIFG                   (0x0001)
+#define COV                     (0x0002)
+#define OUT                     (0x0004)
+#define CCI                     (0x0008)
+#define CCIE                    (0x0010)
+#define OUTMOD_0                (0x0000)
+#define OUTMOD_1                (0x0020)
+#define OUTMOD_2                (0x0040)
+#define OUTMOD_3                (0x0060)
+#define OUTMOD_4                (0x0080)
+#define OUTMOD_5                (0x00A0)
+#define OUTMOD_6                (0x00C0)
+#define OUTMOD_7                (0x00E0)
+#define CAP                     (0x0100)
+#define SCCI                    (0x0400)
+#define SCS                     (0x0800)
+#define CCIS_0                  (0x0000)
+#define CCIS_1                  (0x1000)
+#define CCIS_2                  (0x2000)
+#define CCIS_3                  (0x3000)
+#define CM_0                    (0x0000)
+#define CM_1                    (0x4000)
+#define CM_2                    (0x8000)
+#define CM_3                    (0xC000)
+
+/*
+ * Timer_B (same layout as Timer_A for the registers modelled)
+ */
+#define OFS_TBxCTL              (0x0000)
+#define OFS_TBxCCTL0            (0x0002)
+#define OFS_TBxR                (0x0010)
+#define OFS_TBxCCR0             (0x0012)
+#define OFS_TBxEX0              (0x0020)
+#define OFS_TBxIV               (0x002E)
+#define TBIFG                   (0x0001)
+#define TBIE                    (0x0002)
+#define TBCLR                   (0x0004)
+#define CNTL_0                  (0x0000)
+#define CNTL_1                  (0x0800)
+#define CNTL_2                  (0x1000)
+#define CNTL_3                  (0x1800)
+#define TBCLGRP_0               (0x0000)
+#define TBCLGRP_1               (0x2000)
+#define TBCLGRP_2               (0x4000)
+#define TBCLGRP_3               (0x6000)
+#define TBSSEL__TACLK           (0x0000)
+#define TBSSEL__ACLK            (0x0100)
+#define TBSSEL__SMCLK           (0x0200)
+#define TBSSEL__INCLK           (0x0300)
+#define TBIDEX_7                (0x0007)
+#define CLLD_0                  (0x0000)
+#define CLLD_1                  (0x0200)
+#define CLLD_2                  (0x0400)
+#define CLLD_3                  (0x0600)
+
+/*
+ * eUSCI_A (UART mode)
+ */
+#define OFS_UCAxCTLW0           (0x0000)
+#define OFS_UCAxCTLW1           (0x0002)
+#define OFS_UCAxBRW             (0x0006)
+#define OFS_UCAxMCTLW           (0x0008)
+#define OFS_UCAxSTATW           (0x000A)
+#define OFS_UCAxRXBUF           (0x000C)
+#define OFS_UCAxTXBUF           (0x000E)
+#define OFS_UCAxIE              (0x001A)
+#define OFS_UCAxIFG             (0x001C)
+#define UCSWRST                 (0x0001)
+#define UCTXBRK                 (0x0002)
+#define UCTXADDR                (0x0004)
+#define UCDORM                  (0x0008)
+#define UCBRKIE                 (0x0010)
+#define UCRXEIE                 (0x0020)
+#define UCSSEL_3                (0x00C0)
+#define UCSSEL__UCLK            (0x0000)
+#define UCSSEL__ACLK            (0x0040)
+#define UCSSEL__SMCLK           (0x0080)
+#define UCSYNC                  (0x0100)
+#define UCMODE_0                (0x0000)
+#define UCMODE_1                (0x0200)
+#define UCMODE_2                (0x0400)
+#define UCMODE_3                (0x0600)
+#define UCSPB                   (0x0800)
+#define UC7BIT                  (0x1000)
+#define UCMSB                   (0x2000)
+#define UCPAR                   (0x4000)
+#define UCPEN                   (0x8000)
+#define UCGLIT0                 (0x0001)
+#define UCGLIT1                 (0x0002)
+#define UCBUSY                  (0x0001)
+#define UCADDR                  (0x0002)
+#define UCIDLE                  (0x0002)
+#define UCRXERR                 (0x0004)
+#define UCBRK                   (0x0008)
+#define UCPE                    (0x0010)
+#define UCOE                    (0x0020)
+#define UCFE                    (0x0040)
+#define UCLISTEN                (0x0080)
+#define UCRXIE                  (0x0001)
+#define UCTXIE                  (0x0002)
+#define UCSTTIE                 (0x0004)
+#define UCTXCPTIE               (0x0008)
+#define UCRXIFG                 (0x0001)
+#define UCTXIFG                 (0x0002)
+#define UCSTTIFG                (0x0004)
+#define UCTXCPTIFG              (0x0008)
+
+/*
+ * AES256 accelerator
+ */
+#define OFS_AESACTL0            (0x0000)
+#define OFS_AESACTL1            (0x0002)
+#define OFS_AESASTAT            (0x0004)
+#define OFS_AESAKEY             (0x0006)
+#define OFS_AESADIN             (0x0008)
+#define OFS_AESADOUT            (0x000A)
+#define OFS_AESAXDIN            (0x000C)
+#define OFS_AESAXIN             (0x000E)
+#define AESOP0                  (0x0001)
+#define AESOP1                  (0x0002)
+#define AESOP_3                 (0x0003)
+#define AESKL0                  (0x0004)
+#define AESKL1                  (0x0008)
+#define AESKL_1                 (0x0004)
+#define AESKL_2                 (0x0008)
+#define AESKL__128              (0x0000)
+#define AESKL__192              (0x0004)
+#define AESKL__256              (0x0008)
+#define AESCM0                  (0x0020)
+#define AESCM1                  (0x0040)
+#define AESSWRST                (0x0080)
+#define AESRDYIFG               (0x0100)
+#define AESERRFG                (0x0800)
+#define AESRDYIE                (0x1000)
+#define AESCMEN                 (0x8000)
+#define AESBUSY                 (0x0001)
+#define AESKEYWR                (0x0002)
+#define AESDINWR                (0x0004)
+#define AESDOUTRD               (0x0008)
+
+/*
+ * DMA controller
+ */
+#define OFS_DMACTL0             (0x0000)
+#define OFS_DMACTL1             (0x0002)
+#define OFS_DMACTL2             (0x0004)
+#define OFS_DMACTL4             (0x0008)
+#define OFS_DMAIV               (0x000E)
+#define OFS_DMA0CTL             (0x0010)
+#define OFS_DMA0SA              (0x0012)
+#define OFS_DMA0DA              (0x0016)
+#define OFS_DMA0SZ              (0x001A)
+#define ENNMI                   (0x0001)
+#define ROUNDROBIN              (0x0002)
+#define DMARMWDIS               (0x0004)
+#define DMAREQ                  (0x0001)
+#define DMAABORT                (0x0002)
+#define DMAIE                   (0x0004)
+#define DMAIFG                  (0x0008)
+#define DMAEN                   (0x0010)
+#define DMALEVEL                (0x0020)
+#define DMASRCBYTE              (0x0040)
+#define DMADSTBYTE              (0x0080)
+#define DMASRCINCR0             (0x0100)
+#define DMASRCINCR1             (0x0200)
+#define DMASRCINCR_0            (0x0000)
+#define DMASRCINCR_2            (0x0200)
+#define DMASRCINCR_3            (0x0300)
+#define DMADSTINCR0             (0x0400)
+#define DMADSTINCR1             (0x0800)
+#define DMADSTINCR_0            (0x0000)
+#define DMADSTINCR_2            (0x0800)
+#define DMADSTINCR_3            (0x0C00)
+#define DMADT0                  (0x1000)
+#define DMADT1                  (0x2000)
+#define DMADT2                  (0x4000)
+#define DMADT_0                 (0x0000)
+#define DMADT_1                 (0x1000)
+#define DMADT_2                 (0x2000)
+#define DMADT_3                 (0x3000)
+#define DMADT_4                 (0x4000)
+#define DMADT_5                 (0x5000)
+#define DMADT_6                 (0x6000)
+#define DMADT_7                 (0x7000)
+
+/*
+ * FRAM controller (wait states only, the model treats FRAM as plain memory)
+ */
+#define OFS_FRCTL0              (0x0000)
+#define OFS_FRCTL0_L            OFS_FRCTL0
+#define OFS_GCCTL0              (0x0004)
+#define OFS_GCCTL0_L            OFS_GCCTL0
+#define OFS_GCCTL1              (0x0006)
+#define FWPW                    (0xA500)
+#define NWAITS0                 (0x0010)
+#define NWAITS1                 (0x0020)
+#define NWAITS2                 (0x0040)
+#define NWAITS_0                (0x0000)
+#define NWAITS_1                (0x0010)
+#define NWAITS_2                (0x0020)
+#define NWAITS_3                (0x0030)
+#define NWAITS_4                (0x0040)
+#define NWAITS_5                (0x0050)
+#define NWAITS_6                (0x0060)
+#define NWAITS_7                (0x0070)
+#define FRLPMPWR                (0x0002)
+#define FRPWR                   (0x0004)
+#define ACCTEIE                 (0x0010)
+#define CBDIE                   (0x0020)
+#define UBDIE                   (0x0040)
+#define UBDRSTEN                (0x0080)
+#define CBDIFG                  (0x0002)
+#define UBDIFG                  (0x0004)
+#define ACCTEIFG                (0x0008)
+
+/*
+ * CRC32 module
+ */
+#define OFS_CRC32DIW0           (0x0000)
+#define OFS_CRC32DIW0_L         OFS_CRC32DIW0
+#define OFS_CRC32DIW1           (0x0002)
+#define OFS_CRC32DIRBW1         (0x0004)
+#define OFS_CRC32DIRBW1_L       OFS_CRC32DIRBW1
+#define OFS_CRC32DIRBW0         (0x0006)
+#define OFS_CRC32INIRESW0       (0x0008)
+#define OFS_CRC32INIRESW1       (0x000A)
+#define OFS_CRC32RESRW1         (0x000C)
+#define OFS_CRC32RESRW0         (0x000E)
+#define OFS_CRC16DIW0           (0x0010)
+#define OFS_CRC16DIW0_L         OFS_CRC16DIW0
+#define OFS_CRC16DIRBW0         (0x0016)
+#define OFS_CRC16DIRBW0_L       OFS_CRC16DIRBW0
+#define OFS_CRC16INIRESW0       (0x0018)
+#define OFS_CRC16RESRW0         (0x001E)
+
+/*
+ * 32-bit hardware multiplier
+ */
+#define OFS_MPY                 (0x0000)
+#define OFS_MPYS                (0x0002)
+#define OFS_MAC                 (0x0004)
+#define OFS_MACS                (0x0006)
+#define OFS_OP2                 (0x0008)
+#define OFS_RESLO               (0x000A)
+#define OFS_RESHI               (0x000C)
+#define OFS_SUMEXT              (0x000E)
+#define OFS_MPY32L              (0x0010)
+#define OFS_MPY32H              (0x0012)
+#define OFS_MPYS32L             (0x0014)
+#define OFS_MPYS32H             (0x0016)
+#define OFS_MAC32L              (0x0018)
+#define OFS_MAC32H              (0x001A)
+#define OFS_MACS32L             (0x001C)
+#define OFS_MACS32H             (0x001E)
+#define OFS_OP2L                (0x0020)
+#define OFS_OP2H                (0x0022)
+#define OFS_RES0                (0x0024)
+#define OFS_RES1                (0x0026)
+#define OFS_RES2                (0x0028)
+#define OFS_RES3                (0x002A)
+#define OFS_MPY32CTL0           (0x002C)
+#define OFS_MPY32CTL0_L         OFS_MPY32CTL0
+#define MPYC                    (0x0001)
+#define MPYFRAC                 (0x0004)
+#define MPYSAT                  (0x0008)
+#define MPYM0                   (0x0010)
+#define MPYM1                   (0x0020)
+#define MPYOP1_32               (0x0040)
+#define MPYOP2_32               (0x0080)
+#define MPYDLYWRTEN             (0x0100)
+#define MPYDLY32                (0x0200)
+
+/*
+ * ADC12_B
+ */
+#define OFS_ADC12CTL0           (0x0000)
+#define OFS_ADC12CTL0_L         OFS_ADC12CTL0
+#define OFS_ADC12CTL1           (0x0002)
+#define OFS_ADC12CTL1_L         OFS_ADC12CTL1
+#define OFS_ADC12CTL2           (0x0004)
+#define OFS_ADC12CTL2_L         OFS_ADC12CTL2
+#define OFS_ADC12CTL3           (0x0006)
+#define OFS_ADC12LO             (0x0008)
+#define OFS_ADC12HI             (0x000A)
+#define OFS_ADC12IFGR0          (0x000C)
+#define OFS_ADC12IFGR1          (0x000E)
+#define OFS_ADC12IFGR2          (0x0010)
+#define OFS_ADC12IER0           (0x0012)
+#define OFS_ADC12IER1           (0x0014)
+#define OFS_ADC12IER2           (0x0016)
+#define OFS_ADC12IV             (0x0018)
+#define OFS_ADC12MCTL0          (0x0020)
+#define OFS_ADC12MEM0           (0x0060)
+#define ADC12SC                 (0x0001)
+#define ADC12ENC                (0x0002)
+#define ADC12ON                 (0x0010)
+#define ADC12MSC                (0x0080)
+#define ADC12SHT0_2             (0x0200)
+#define ADC12SHT0_15            (0x0F00)
+#define ADC12SHT1_15            (0xF000)
+#define ADC12BUSY               (0x0001)
+#define ADC12CONSEQ_0           (0x0000)
+#define ADC12CONSEQ_2           (0x0004)
+#define ADC12CONSEQ_3           (0x0006)
+#define ADC12SSEL_0             (0x0000)
+#define ADC12DIV_0              (0x0000)
+#define ADC12DIV_7              (0x00E0)
+#define ADC12ISSH               (0x0100)
+#define ADC12SHP                (0x0200)
+#define ADC12SHS_0              (0x0000)
+#define ADC12PDIV__1            (0x0000)
+#define ADC12PDIV__64           (0x6000)
+#define ADC12PWRMD              (0x0001)
+#define ADC12DF                 (0x0008)
+#define ADC12RES_2              (0x0020)
+#define ADC12RES_3              (0x0030)
+#define ADC12RES__12BIT         (0x0020)
+#define ADC12CSTARTADD_31       (0x001F)
+#define ADC12INCH_2             (0x0002)
+#define ADC12EOS                (0x0080)
+#define ADC12VRSEL_0            (0x0000)
+#define ADC12DIF                (0x2000)
+#define ADC12WINC               (0x4000)
+#define ADC12IE0                (0x0001)
+#define ADC12IFG0               (0x0001)
+#define ADC12OVIFG              (0x0002)
+
+#endif // HOST_MSP430_H
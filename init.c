@@ -25,6 +25,7 @@
 #include "driverlib.h"
 #include "init.h"
 #include "utils.h"
+#include "cipher.h"
 
 /**
  * @brief      System pre-init, run before main()
@@ -101,6 +102,8 @@ void Gpio_Init(void)
  */
 void Clock_Init(void)
 {
+    // FRAM needs a wait state above 8 MHz, set it before raising MCLK
+    FRAMCtl_configureWaitStateControl(FRAMCTL_ACCESS_TIME_CYCLES_1);
     // Set DCO frequency to 16 MHz
     CS_setDCOFreq(CS_DCORSEL_1, CS_DCOFSEL_4);
     // Set external clock frequency to 32.768 KHz
@@ -183,5 +186,39 @@ bool Uart_Init(void)
 void Aes_Init(uint8_t * cypherKey)
 {
     // Load a cipher key to module
-    AES256_setCipherKey(AES256_BASE, cypherKey, AES256_KEYLENGTH_256BIT);
+    Cipher_SetKey(cypherKey);
+}
+
+/**
+ * @brief      Setup the ADC12_B for the sensor-sampling workload: A2 (P1.2)
+ *             into ADC12MEM0, converted back to back by the sampling timer
+ *             once a conversion is started
+ */
+void Adc_Init(void)
+{
+    ADC12_B_initParam initParam = {0};
+    ADC12_B_configureMemoryParam memoryParam = {0};
+
+    // Configure P1.2 - A2
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1, GPIO_PIN2, GPIO_TERNARY_MODULE_FUNCTION);
+
+    // Software triggered, on MODOSC (~5 MHz)
+    initParam.sampleHoldSignalSourceSelect = ADC12_B_SAMPLEHOLDSOURCE_SC;
+    initParam.clockSourceSelect = ADC12_B_CLOCKSOURCE_ADC12OSC;
+    initParam.clockSourceDivider = ADC12_B_CLOCKDIVIDER_1;
+    initParam.clockSourcePredivider = ADC12_B_CLOCKPREDIVIDER__1;
+    initParam.internalChannelMap = ADC12_B_NOINTCH;
+    ADC12_B_init(ADC12_B_BASE, &initParam);
+    ADC12_B_enable(ADC12_B_BASE);
+    // 16 cycle sample-and-hold, the next conversion right after the last
+    ADC12_B_setupSamplingTimer(ADC12_B_BASE, ADC12_B_CYCLEHOLD_16_CYCLES, ADC12_B_CYCLEHOLD_16_CYCLES,
+                               ADC12_B_MULTIPLESAMPLESENABLE);
+
+    memoryParam.memoryBufferControlIndex = ADC12_B_MEMORY_0;
+    memoryParam.inputSourceSelect = ADC12_B_INPUT_A2;
+    memoryParam.refVoltageSourceSelect = ADC12_B_VREFPOS_AVCC_VREFNEG_VSS;
+    memoryParam.endOfSequence = ADC12_B_ENDOFSEQUENCE;
+    memoryParam.windowComparatorSelect = ADC12_B_WINDOW_COMPARATOR_DISABLE;
+    memoryParam.differentialModeSelect = ADC12_B_DIFFERENTIAL_MODE_DISABLE;
+    ADC12_B_configureMemory(ADC12_B_BASE, &memoryParam);
 }
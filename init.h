@@ -37,5 +37,6 @@ void Clock_Init(void);
 void Timer_Init(void);
 bool Uart_Init(void);
 void Aes_Init(uint8_t * cypherKey);
+void Adc_Init(void);
 
 #endif // INIT_H
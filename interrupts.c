@@ -30,6 +30,9 @@
 #include "utils.h"
 #include "console.h"
 #include "checkpointing_test_fixture.h"
+#include "replay.h"
+#include "cipher.h"
+#include "workload.h"
 
 /*
  * Timer0_A1 Interrupt Vector handler
@@ -52,9 +55,45 @@ __interrupt void TIMER0_A1_ISR(void)
 __interrupt void PORT8_ISR(void)
 {
     // Signal that power loss has occurred
-    checkpointingObj.powerLoss = true;
+    Checkpointing_SignalPowerLoss(&checkpointingObj);
     // P8.1 IFG cleared
     GPIO_clearInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    // Wake up a chunk sleeping through the DMA
+    __bic_SR_register_on_exit(LPM0_bits);
 }
 
+/*
+ * TIMER0_B0_VECTOR Interrupt Vector handler
+ *
+ */
+#pragma vector=TIMER0_B0_VECTOR
+__interrupt void TIMER0_B0_ISR(void)
+{
+    // Replay compare event
+    Replay_Service();
+}
+
+/*
+ * AES256_VECTOR Interrupt Vector handler
+ *
+ */
+#pragma vector=AES256_VECTOR
+__interrupt void AES256_ISR(void)
+{
+    // A pipelined block is ready
+    Cipher_ServiceReady();
+}
 
+/*
+ * DMA_VECTOR Interrupt Vector handler
+ *
+ */
+#pragma vector=DMA_VECTOR
+__interrupt void DMA_ISR(void)
+{
+    // A DMA segment of a chunk is done
+    Cipher_ServiceDma();
+    Workload_ServiceDma();
+    // Wake up the chunk, it checks whether it's done
+    __bic_SR_register_on_exit(LPM0_bits);
+}
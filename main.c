@@ -37,6 +37,7 @@
 #include "uartlib.h"
 #include "utils.h"
 #include "checkpointing_test_fixture.h"
+#include "checkpoint.h"
 
 #pragma PERSISTENT(cipherKey)
 uint8_t cipherKey[32] =
@@ -60,11 +61,14 @@ void main(void)
     Clock_Init();
     Timer_Init();
     Aes_Init(cipherKey);
+    Adc_Init();
     success = Uart_Init();
     UartLib_Init();
 
     // Initialize program variables
-    Checkpointing_Init();
+    Checkpointing_Init(&checkpointingObj);
+    // Checkpoint to FRAM, and pick up a run a reset cut short
+    Checkpointing_AttachStore(&checkpointingObj, &checkpointStore);
 
     // Setup console interface
     consoleSettings_t consoleSettings = 
@@ -25,6 +25,9 @@
 #include "menus.h"
 #include "utils.h"
 #include "checkpointing_test_fixture.h"
+#include "trace.h"
+#include "replay.h"
+#include "calibration.h"
 
 splash_t splashScreen =
 {
@@ -44,6 +47,7 @@ splash_t splashScreen =
 
 // All menus need to be externed up here
 extern consoleMenu_t mainMenu;
+extern consoleMenu_t replayMenu;
 
 consoleMenuItem_t mainMenuItems[] = 
 {
@@ -51,5 +55,17 @@ consoleMenuItem_t mainMenuItems[] =
     {{"Setup",  "Setup checkpointing parameters"},  NO_SUB_MENU,    PowerLossEmu_Setup},
     {{"Current",  "Display current parameters"},    NO_SUB_MENU,    Checkpointing_CurrentSettings},
     {{"Run", "Run checkpointing workload"},         NO_SUB_MENU,    Checkpointing_WorkloadLoop},
+    {{"Trace", "Send power-loss trace (binary)"},   NO_SUB_MENU,    Trace_Dump},
+    {{"Clear trace", "Clear power-loss trace"},     NO_SUB_MENU,    Trace_Clear},
+    {{"Replay", "Replay a recorded power-loss trace"}, &replayMenu, NO_FUNCTION_POINTER},
+    {{"Calibrate", "Measure workload costs for the simulator"}, NO_SUB_MENU, Calibration_Run},
+    {{"AES bench", "Compare cycles per block of the AES engines"}, NO_SUB_MENU, Calibration_BenchmarkAes},
 };
 consoleMenu_t mainMenu = {{"Main Menu", "This is the main menu."}, mainMenuItems, NO_TOP_MENU, MENU_SIZE(mainMenuItems)};
+
+consoleMenuItem_t replayMenuItems[] =
+{
+    {{"Load", "Load the last run in the trace"},     NO_SUB_MENU,    Replay_Load},
+    {{"Run", "Run workload against the replay"},    NO_SUB_MENU,    Replay_Run},
+};
+consoleMenu_t replayMenu = {{"Replay Menu", "Replays recorded power losses on Timer_B0."}, replayMenuItems, &mainMenu, MENU_SIZE(replayMenuItems)};
@@ -0,0 +1,287 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Power-loss replay. Regenerates a recorded power-loss pattern on the board
+ * itself: Timer_B0 CCR0 compare events land at the recorded offsets and
+ * signal the power loss through Checkpointing_SignalPowerLoss(), the same
+ * path the PORT8 ISR takes. Timer_B0 runs at 1 us per tick, like Timer_A0.
+ *
+ * Each compare is set relative to the previous one rather than to the
+ * current count, so ISR latency does not accumulate over a replay. Offsets
+ * longer than the 16-bit counter are covered in steps.
+ */
+
+#include <stdbool.h>
+#include "driverlib.h"
+#include "replay.h"
+#include "trace.h"
+#include "checkpointing_test_fixture.h"
+
+// Longest compare step, well inside the 16-bit counter range
+#define REPLAY_MAX_STEP_TICKS       (0x8000)
+// Shortest interval, so a compare is never set behind the counter
+#define REPLAY_MIN_INTERVAL_TICKS   (50)
+
+// Loaded replay, kept in FRAM so it can be run again after a reset
+#pragma PERSISTENT(replayIntervals)
+uint32_t replayIntervals[REPLAY_MAX_EVENTS] = {0};
+#pragma PERSISTENT(replayLength)
+uint16_t replayLength = 0;
+
+// Replay state
+static volatile bool replayActive;
+static uint16_t replayIndex;
+static uint32_t replayRemainingTicks;
+static uint16_t replayCompare;
+
+/**
+ * @brief      Load the most recent run in the trace as the replay
+ *
+ * The run is everything after the last run start marker. The first power
+ * loss is the sync pulse, the rest keep their recorded offsets from the sync.
+ * Without a marker, every power loss in the trace is used, unless the ring
+ * has overwritten records: the marker may have been one of them, and a power
+ * loss from the middle of the run would be taken for the sync pulse.
+ *
+ * @return     Number of power losses loaded, 0 if none or if the run start
+ *             has been overwritten
+ */
+uint16_t Replay_LoadFromTrace(void)
+{
+    uint16_t count = Trace_GetCount();
+    uint16_t first = 0;
+    uint16_t i;
+    const traceRecord_t *record;
+    uint32_t previous;
+
+    // Find the start of the last run
+    for (i = count; i > 0; i--)
+    {
+        if ((Trace_GetRecord(i - 1)->flags & TRACE_FLAG_RUN_START) != 0)
+        {
+            first = i;
+            break;
+        }
+    }
+
+    // The power loss right before the marker is the sync pulse, and offsets
+    // are kept relative to it
+    if ((first > 1) && ((Trace_GetRecord(first - 2)->flags & TRACE_FLAG_RUN_START) == 0))
+    {
+        previous = Trace_GetRecord(first - 2)->timestampMicroseconds;
+    }
+    else if (first != 0)
+    {
+        previous = Trace_GetRecord(first - 1)->timestampMicroseconds;
+    }
+    else if ((count != 0) && (traceRing.totalRecords == count))
+    {
+        previous = Trace_GetRecord(0)->timestampMicroseconds;
+        first = 1;
+    }
+    else
+    {
+        replayLength = 0;
+        return 0;
+    }
+
+    replayLength = 0;
+    replayIntervals[replayLength++] = REPLAY_SYNC_LEAD_MICROSECONDS;
+    for (i = first; (i < count) && (replayLength < REPLAY_MAX_EVENTS); i++)
+    {
+        record = Trace_GetRecord(i);
+        if ((record->flags & TRACE_FLAG_RUN_START) != 0)
+        {
+            continue;
+        }
+        replayIntervals[replayLength++] = record->timestampMicroseconds - previous;
+        previous = record->timestampMicroseconds;
+    }
+
+    return replayLength;
+}
+
+/**
+ * @brief      Set the next compare, at most one step further
+ */
+static void Replay_Arm(void)
+{
+    uint32_t step = replayRemainingTicks;
+    uint16_t now;
+
+    if (step > REPLAY_MAX_STEP_TICKS)
+    {
+        step = REPLAY_MAX_STEP_TICKS;
+    }
+    replayRemainingTicks -= step;
+    replayCompare += (uint16_t)step;
+
+    // If the counter has already gone past the compare, fire as soon as
+    // possible instead of waiting a full wrap, and carry on from there
+    now = Timer_B_getCounterValue(TIMER_B0_BASE);
+    if ((uint16_t)(replayCompare - now) > REPLAY_MAX_STEP_TICKS)
+    {
+        replayCompare = now + REPLAY_MIN_INTERVAL_TICKS;
+    }
+    Timer_B_setCompareValue(TIMER_B0_BASE, TIMER_B_CAPTURECOMPARE_REGISTER_0, replayCompare);
+}
+
+static void Replay_LoadInterval(void)
+{
+    replayRemainingTicks = replayIntervals[replayIndex];
+    if (replayRemainingTicks < REPLAY_MIN_INTERVAL_TICKS)
+    {
+        replayRemainingTicks = REPLAY_MIN_INTERVAL_TICKS;
+    }
+}
+
+/**
+ * @brief      Start replaying the loaded power losses
+ */
+void Replay_Start(void)
+{
+    Timer_B_initContinuousModeParam timerParam = {0};
+    Timer_B_initCompareModeParam compareParam = {0};
+
+    if (replayLength == 0)
+    {
+        return;
+    }
+
+    replayIndex = 0;
+    replayCompare = 0;
+    Replay_LoadInterval();
+
+    // SMCLK (16 MHz) / 16 = 1 us per tick, counter cleared but not started
+    timerParam.clockSource = TIMER_B_CLOCKSOURCE_SMCLK;
+    timerParam.clockSourceDivider = TIMER_B_CLOCKSOURCE_DIVIDER_16;
+    timerParam.timerInterruptEnable_TBIE = TIMER_B_TBIE_INTERRUPT_DISABLE;
+    timerParam.timerClear = TIMER_B_DO_CLEAR;
+    timerParam.startTimer = false;
+    Timer_B_initContinuousMode(TIMER_B0_BASE, &timerParam);
+
+    compareParam.compareRegister = TIMER_B_CAPTURECOMPARE_REGISTER_0;
+    compareParam.compareInterruptEnable = TIMER_B_CAPTURECOMPARE_INTERRUPT_ENABLE;
+    compareParam.compareOutputMode = TIMER_B_OUTPUTMODE_OUTBITVALUE;
+    compareParam.compareValue = 0;
+    Timer_B_initCompareMode(TIMER_B0_BASE, &compareParam);
+    Replay_Arm();
+
+    replayActive = true;
+    Timer_B_startCounter(TIMER_B0_BASE, TIMER_B_CONTINUOUS_MODE);
+}
+
+/**
+ * @brief      Stop the replay
+ */
+void Replay_Stop(void)
+{
+    Timer_B_disableCaptureCompareInterrupt(TIMER_B0_BASE, TIMER_B_CAPTURECOMPARE_REGISTER_0);
+    Timer_B_stop(TIMER_B0_BASE);
+    replayActive = false;
+}
+
+/**
+ * @brief      Handle a Timer_B0 CCR0 compare, called from its ISR
+ */
+void Replay_Service(void)
+{
+    Timer_B_clearCaptureCompareInterrupt(TIMER_B0_BASE, TIMER_B_CAPTURECOMPARE_REGISTER_0);
+
+    if (!replayActive)
+    {
+        return;
+    }
+
+    // Part way through a long interval
+    if (replayRemainingTicks != 0)
+    {
+        Replay_Arm();
+        return;
+    }
+
+    // Same path as a power loss seen on P8.1
+    Checkpointing_SignalPowerLoss(&checkpointingObj);
+
+    replayIndex++;
+    if (replayIndex >= replayLength)
+    {
+        Replay_Stop();
+        return;
+    }
+    Replay_LoadInterval();
+    Replay_Arm();
+}
+
+/**
+ * @brief      Load the last run in the trace as the replay
+ */
+functionResult_e Replay_Load(unsigned int numArgs, int args[])
+{
+    uint16_t count = Replay_LoadFromTrace();
+
+    if ((count == 0) && (Trace_GetCount() != 0))
+    {
+        Console_Print(ANSI_COLOR_RED"The run start has been overwritten in the trace, "
+                      "record a run of under %u power losses!"ANSI_COLOR_RESET, TRACE_RING_SIZE - 2);
+        return ERROR;
+    }
+    if (count == 0)
+    {
+        Console_Print(ANSI_COLOR_RED"No power losses in the trace!"ANSI_COLOR_RESET);
+        return ERROR;
+    }
+    Console_Print("Loaded %u power losses from the trace.", count);
+
+    return SUCCESS;
+}
+
+/**
+ * @brief      Run the workload against the loaded replay instead of the
+ *             power-loss emulator
+ */
+functionResult_e Replay_Run(unsigned int numArgs, int args[])
+{
+    functionResult_e result;
+
+    if (replayLength == 0)
+    {
+        Console_Print(ANSI_COLOR_RED"No replay loaded!"ANSI_COLOR_RESET);
+        return ERROR;
+    }
+    Console_Print("Replaying %u power losses.", replayLength);
+
+    // Ignore the power-loss emulator for the duration
+    GPIO_disableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    Replay_Start();
+    result = Checkpointing_WorkloadLoop(0, 0);
+    Replay_Stop();
+
+    GPIO_clearInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    GPIO_enableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    return result;
+}
@@ -0,0 +1,45 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include "console.h"
+
+// Most power losses a replay can hold (a full trace ring)
+#define REPLAY_MAX_EVENTS               (1024)
+// Delay from the start of a replay to its first power loss, which the
+// workload takes as the emulator sync pulse. Long enough for the settings
+// printout to finish so the workload is already waiting for it.
+#define REPLAY_SYNC_LEAD_MICROSECONDS   (100000)
+
+uint16_t Replay_LoadFromTrace(void);
+void Replay_Start(void);
+void Replay_Stop(void);
+void Replay_Service(void);
+functionResult_e Replay_Load(unsigned int numArgs, int args[]);
+functionResult_e Replay_Run(unsigned int numArgs, int args[]);
+
+#endif // REPLAY_H
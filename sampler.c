@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Goodput time series. The workload loop takes a sample of its progress
+ * every sample interval into a ring, which is printed after the run as
+ * throughput over time. It shows how adaptive policies converge and how fast
+ * they recover from a burst of power losses.
+ */
+
+#include <stddef.h>
+#include "sampler.h"
+#include "console.h"
+
+// Kept in FRAM like the trace, so the last run can be looked at after a reset
+#pragma PERSISTENT(samplerRing)
+samplerRing_t samplerRing = {0};
+
+/**
+ * @brief      Empty a ring
+ */
+void Sampler_Reset(samplerRing_t *ring)
+{
+    ring->head = 0;
+    ring->count = 0;
+    ring->totalSamples = 0;
+}
+
+/**
+ * @brief      Take a sample of a run
+ *
+ * @param      ring                   The ring to add it to
+ * @param[in]  ctx                    The fixture instance doing the run
+ * @param[in]  timestampMicroseconds  Time since the start of the run
+ * @param[in]  powerLosses            Power losses since the start of the run
+ */
+void Sampler_Record(samplerRing_t *ring, const checkpointingObj_t *ctx, uint32_t timestampMicroseconds,
+                    uint32_t powerLosses)
+{
+    samplerSample_t *sample = &ring->samples[ring->head];
+    uint32_t aborts = 0;
+    unsigned int i;
+
+    for (i = 0; i < CHUNK_STATS_BUCKETS; i++)
+    {
+        aborts += ctx->stats.chunks[i].aborts;
+    }
+
+    sample->timestampMicroseconds = timestampMicroseconds;
+    sample->bytesProcessed = (uint32_t)ctx->bytesProcessed;
+    sample->aborts = aborts;
+    sample->powerLosses = powerLosses;
+    sample->chunkSize = ctx->currentChunkSize;
+
+    ring->head = (ring->head + 1) % SAMPLER_RING_SIZE;
+    if (ring->count < SAMPLER_RING_SIZE)
+    {
+        ring->count++;
+    }
+    ring->totalSamples++;
+}
+
+/**
+ * @brief      Get a sample from a ring
+ *
+ * @param[in]  ring   The ring
+ * @param[in]  index  The sample, 0 being the oldest
+ *
+ * @return     The sample
+ */
+const samplerSample_t *Sampler_GetSample(const samplerRing_t *ring, uint16_t index)
+{
+    return &ring->samples[(ring->head + SAMPLER_RING_SIZE - ring->count + index) % SAMPLER_RING_SIZE];
+}
+
+/**
+ * @brief      Print a ring as a throughput-over-time series, one CSV row per
+ *             sample. Goodput is over the interval since the previous sample.
+ */
+void Sampler_Print(const samplerRing_t *ring)
+{
+    const samplerSample_t *sample;
+    const samplerSample_t *previous = NULL;
+    uint32_t elapsed;
+    double goodput;
+    uint16_t i;
+
+    if (ring->totalSamples > ring->count)
+    {
+        Console_Print("%lu oldest samples were overwritten", ring->totalSamples - ring->count);
+    }
+    Console_Print("time_s,bytes,goodput_Bps,chunk_bytes,aborts,power_losses");
+    for (i = 0; i < ring->count; i++)
+    {
+        sample = Sampler_GetSample(ring, i);
+        goodput = 0.0;
+        if (previous != NULL)
+        {
+            elapsed = sample->timestampMicroseconds - previous->timestampMicroseconds;
+            if (elapsed != 0)
+            {
+                goodput = ((double)(sample->bytesProcessed - previous->bytesProcessed) * 1000000.0) /
+                          (double)elapsed;
+            }
+        }
+        Console_Print("%.3f,%lu,%.0f,%lu,%lu,%lu",
+                      sample->timestampMicroseconds / 1000000.0, sample->bytesProcessed, goodput,
+                      sample->chunkSize, sample->aborts,
+                      sample->powerLosses);
+        previous = sample;
+    }
+}
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+#include "checkpointing_test_fixture.h"
+
+// Number of samples kept, oldest are overwritten first
+#define SAMPLER_RING_SIZE           (256)
+
+typedef struct
+{
+    // Time since the start of the run
+    uint32_t timestampMicroseconds;
+    // Bytes committed so far
+    uint32_t bytesProcessed;
+    // Chunks aborted so far
+    uint32_t aborts;
+    // Power losses seen so far
+    uint32_t powerLosses;
+    // Chunk size in use, in bytes
+    uint32_t chunkSize;
+} samplerSample_t;
+
+typedef struct
+{
+    // Next sample to write
+    uint16_t head;
+    // Valid samples in the ring
+    uint16_t count;
+    // Samples taken since the ring was reset, overwritten ones included
+    uint32_t totalSamples;
+    // The samples
+    samplerSample_t samples[SAMPLER_RING_SIZE];
+} samplerRing_t;
+
+// The ring filled by Checkpointing_WorkloadLoop()
+extern samplerRing_t samplerRing;
+
+void Sampler_Reset(samplerRing_t *ring);
+void Sampler_Record(samplerRing_t *ring, const checkpointingObj_t *ctx, uint32_t timestampMicroseconds,
+                    uint32_t powerLosses);
+const samplerSample_t *Sampler_GetSample(const samplerRing_t *ring, uint16_t index);
+void Sampler_Print(const samplerRing_t *ring);
+
+#endif // SAMPLER_H
@@ -0,0 +1,179 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "driverlib.h"
+#include "trace.h"
+#include "uartlib.h"
+#include "utils.h"
+
+// Kept in FRAM so the trace of a run survives a reset or a real power loss
+#pragma PERSISTENT(traceRing)
+traceRing_t traceRing = {0};
+
+/**
+ * @brief      Append a record to the ring
+ *
+ * The record is filled in before head and count move, so an interrupted write
+ * never exposes a half-written record. Two appends must not interleave
+ * though, so callers outside the ISRs append with interrupts off.
+ */
+static void Trace_Append(uint32_t timestampMicroseconds, uint32_t chunkSize, uint8_t flags)
+{
+    traceRecord_t *record = &traceRing.records[traceRing.head];
+
+    record->timestampMicroseconds = timestampMicroseconds;
+    record->chunkSize = chunkSize;
+    record->flags = flags;
+    memset(record->reserved, 0, sizeof(record->reserved));
+
+    traceRing.head = (traceRing.head + 1) % TRACE_RING_SIZE;
+    if (traceRing.count < TRACE_RING_SIZE)
+    {
+        traceRing.count++;
+    }
+    traceRing.totalRecords++;
+}
+
+/**
+ * @brief      Record a power-loss edge, called from the PORT8 ISR
+ *
+ * @param[in]  ctx   The fixture instance the power loss interrupted
+ */
+void Trace_RecordPowerLoss(const checkpointingObj_t *ctx)
+{
+    Trace_Append(Utils_GetUptimeMicroseconds(),
+                 ctx->currentChunkSize,
+                 ctx->currentlyWorking ? TRACE_FLAG_ABORTED_WORK : 0);
+}
+
+/**
+ * @brief      Record that a workload run is starting
+ *
+ * @param[in]  ctx   The fixture instance starting its run
+ */
+void Trace_MarkRunStart(const checkpointingObj_t *ctx)
+{
+    uint16_t interruptState;
+
+    // Called with the power-loss interrupts on, and an append isn't atomic
+    interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    Trace_Append(Utils_GetUptimeMicroseconds(),
+                 ctx->startingChunkSize,
+                 TRACE_FLAG_RUN_START);
+    __set_interrupt_state(interruptState);
+}
+
+/**
+ * @brief      Get the number of records in the ring
+ */
+uint16_t Trace_GetCount(void)
+{
+    return traceRing.count;
+}
+
+/**
+ * @brief      Get a record from the ring
+ *
+ * @param[in]  index  The record, 0 being the oldest
+ *
+ * @return     The record
+ */
+const traceRecord_t *Trace_GetRecord(uint16_t index)
+{
+    return &traceRing.records[(traceRing.head + TRACE_RING_SIZE - traceRing.count + index) % TRACE_RING_SIZE];
+}
+
+/**
+ * @brief      Stream the ring out over the UART in the binary dump format
+ */
+functionResult_e Trace_Dump(unsigned int numArgs, int args[])
+{
+    uint8_t header[12] = {'P', 'L', 'T', 'R', TRACE_DUMP_VERSION, sizeof(traceRecord_t)};
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    uint8_t checksum[2];
+    const uint8_t *bytes;
+    uint16_t i;
+    uint8_t j;
+
+    Console_Print("%u power-loss records in the trace (%lu taken since cleared)",
+                  traceRing.count, traceRing.totalRecords);
+    Console_Print("Start capturing on the host, then press any key to send them.");
+    Console_PromptForAnyKeyBlocking();
+    fflush(stdout);
+
+    // Keep the ISR off the ring while it goes out
+    GPIO_disableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    header[6] = (uint8_t)(traceRing.count);
+    header[7] = (uint8_t)(traceRing.count >> 8);
+    header[8] = (uint8_t)(traceRing.totalRecords);
+    header[9] = (uint8_t)(traceRing.totalRecords >> 8);
+    header[10] = (uint8_t)(traceRing.totalRecords >> 16);
+    header[11] = (uint8_t)(traceRing.totalRecords >> 24);
+    UartLib_WriteBinary(header, sizeof(header));
+
+    // Oldest record first
+    for (i = 0; i < traceRing.count; i++)
+    {
+        bytes = (const uint8_t *)Trace_GetRecord(i);
+        for (j = 0; j < sizeof(traceRecord_t); j++)
+        {
+            sum1 = (sum1 + bytes[j]) % 255;
+            sum2 = (sum2 + sum1) % 255;
+        }
+        UartLib_WriteBinary(bytes, sizeof(traceRecord_t));
+    }
+
+    checksum[0] = (uint8_t)(sum1);
+    checksum[1] = (uint8_t)(sum2);
+    UartLib_WriteBinary(checksum, sizeof(checksum));
+
+    GPIO_clearInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    GPIO_enableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    Console_PrintNewLine();
+    Console_Print("Trace sent.");
+
+    return SUCCESS;
+}
+
+/**
+ * @brief      Empty the ring
+ */
+functionResult_e Trace_Clear(unsigned int numArgs, int args[])
+{
+    GPIO_disableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+    traceRing.head = 0;
+    traceRing.count = 0;
+    traceRing.totalRecords = 0;
+    GPIO_enableInterrupt(GPIO_PORT_P8, GPIO_PIN1);
+
+    Console_Print("Trace cleared.");
+
+    return SUCCESS;
+}
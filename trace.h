@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include "console.h"
+#include "checkpointing_test_fixture.h"
+
+// Number of records kept in the FRAM ring, oldest are overwritten first
+#define TRACE_RING_SIZE             (1024)
+
+// Record flags
+#define TRACE_FLAG_ABORTED_WORK     (0x01) // Power loss landed while a chunk was in flight
+#define TRACE_FLAG_RUN_START        (0x02) // Not an edge, marks the start of a workload run
+
+// Dump format, all fields little-endian:
+//   'P' 'L' 'T' 'R'  magic
+//   uint8_t          TRACE_DUMP_VERSION
+//   uint8_t          sizeof(traceRecord_t)
+//   uint16_t         number of records that follow
+//   uint32_t         records taken since the trace was cleared
+//   traceRecord_t    records, oldest first
+//   uint16_t         Fletcher-16 of the records
+#define TRACE_DUMP_MAGIC            "PLTR"
+#define TRACE_DUMP_VERSION          (2)
+
+typedef struct
+{
+    // Uptime when the edge was seen
+    uint32_t timestampMicroseconds;
+    // Chunk size being worked on (or to be worked on next), in bytes
+    uint32_t chunkSize;
+    // TRACE_FLAG_*
+    uint8_t flags;
+    uint8_t reserved[3];
+} traceRecord_t;
+
+typedef struct
+{
+    // Next record to write
+    uint16_t head;
+    // Valid records in the ring
+    uint16_t count;
+    // Records taken since the trace was cleared, overwritten ones included
+    uint32_t totalRecords;
+    // The records
+    traceRecord_t records[TRACE_RING_SIZE];
+} traceRing_t;
+
+// The ring filled by the PORT8 ISR and Checkpointing_WorkloadLoop()
+extern traceRing_t traceRing;
+
+void Trace_RecordPowerLoss(const checkpointingObj_t *ctx);
+uint16_t Trace_GetCount(void);
+const traceRecord_t *Trace_GetRecord(uint16_t index);
+void Trace_MarkRunStart(const checkpointingObj_t *ctx);
+functionResult_e Trace_Dump(unsigned int numArgs, int args[]);
+functionResult_e Trace_Clear(unsigned int numArgs, int args[]);
+
+#endif // TRACE_H
@@ -52,6 +52,9 @@ static char stdoutBuff[IO_BUFF_SIZE];
 
 static UartLib_Object_t UartLib_Object;
 
+static inline void UartLib_WriteData(void);
+static inline void UartLib_ReadData(void);
+
 void UartLib_Init(void)
 {
     /* Add the UART device to the system. */
@@ -152,7 +155,20 @@ int UartLib_WritePolling(const void *buffer, size_t size)
     return (UartLib_Object.writeCount);
 }
 
-void UartLib_WriteData()
+int UartLib_WriteBinary(const void *buffer, size_t size)
+{
+    UartLib_DataMode_e writeDataMode = UartLib_Object.writeDataMode;
+    int ret;
+
+    /* Send the data as-is, without adding returns before newlines. */
+    UartLib_Object.writeDataMode = UART_DATA_BINARY;
+    ret = UartLib_WritePolling(buffer, size);
+    UartLib_Object.writeDataMode = writeDataMode;
+
+    return (ret);
+}
+
+static inline void UartLib_WriteData(void)
 {
     /* If mode is TEXT process the characters */
     if (UartLib_Object.writeDataMode == UART_DATA_TEXT)
@@ -187,7 +203,7 @@ void UartLib_WriteData()
     }
 }
 
-void UartLib_ReadData()
+static inline void UartLib_ReadData(void)
 {
     uint8_t readIn;
 
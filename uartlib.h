@@ -108,8 +108,7 @@ int UartLib_DeviceUnlink(const char *path);
 int UartLib_DeviceRename(const char *old_name, const char *new_name);
 int UartLib_ReadPolling(void *buffer, size_t size);
 int UartLib_WritePolling(const void *buffer, size_t size);
-inline void UartLib_WriteData(void);
-inline void UartLib_ReadData(void);
+int UartLib_WriteBinary(const void *buffer, size_t size);
 void UartLib_FlushBuff(void);
 
 #endif // UARTLIB_H
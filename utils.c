@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "driverlib.h"
+#include "init.h"
 #include "utils.h"
 #include "console.h"
 
@@ -30,9 +31,29 @@ volatile uint32_t uptimeTicksMicroseconds;
 
 uint32_t Utils_GetUptimeMicroseconds(void)
 {
+    uint32_t ticks;
+    uint16_t count;
+
+    // If the rollover ISR ran between reading the ticks and the count, the
+    // count belongs to the next period. Read both again.
+    do
+    {
+        ticks = uptimeTicksMicroseconds;
+        count = Timer_A_getCounterValue(TIMER_A0_BASE);
+    }
+    while (ticks != uptimeTicksMicroseconds);
+
+    // From inside another ISR, a rollover may not have been counted yet. Read
+    // the count again after seeing the flag, in case it rolled over between.
+    if (Timer_A_getInterruptStatus(TIMER_A0_BASE) == TIMER_A_INTERRUPT_PENDING)
+    {
+        count = Timer_A_getCounterValue(TIMER_A0_BASE);
+        ticks += TIMER_PERIOD_TICKS;
+    }
+
     // Since we're only incrementing system tick on counting rollovers, we need
     // to add the current timer count to it.
-    return (uptimeTicksMicroseconds + Timer_A_getCounterValue(TIMER_A0_BASE));
+    return (ticks + count);
 }
 
 functionResult_e Utils_DisplayUptime(unsigned int numArgs, int args[])
@@ -0,0 +1,767 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * The workloads a fixture run can checkpoint, behind one descriptor each.
+ * Checkpointing_DoChunk() runs a chunk as a run of units on a copy of the
+ * committed state and only moves the committed state on once the chunk (or
+ * the part of it a just-in-time commit salvages) is committed.
+ *
+ * The AES workload is the cipher stream of cipher.c. The copy workload moves
+ * a FRAM region to another a word at a time, all memory traffic and no state
+ * beyond its position. The checksum workload runs a Fletcher-32 over the same
+ * region in software, all CPU and a pair of running sums. Both read a region
+ * filled with a pattern at the start of a run; what they salvage is worked
+ * out again from FRAM, so it survives a reset.
+ *
+ * The CRC32 workload is the integrity scan a device runs on wake-up: passes
+ * over a larger FRAM region through the CRC32 module, a word pair at a time.
+ * The signature lives in the module during a chunk. The chunk seeds it from
+ * the committed state with CRC32_setSeed() and reads it back at its end with
+ * CRC32_getResult(), so a checkpoint (which borrows the module for its own
+ * CRC) and a reset in between resume it exactly.
+ *
+ * The FIR workload runs the source region as 16-bit samples through a
+ * decimating low-pass filter on the MPY32, one output per window of taps.
+ * Its running sum is the multiplier's 64-bit result, so each unit preloads it
+ * with MPY32_preloadResult(), multiply-accumulates its samples and reads it
+ * back with MPY32_getResult() and MPY32_getSumExtension(). That happens with
+ * interrupts off: compiled multiplies, in service routines or between units,
+ * use the same MPY32 and would run over the result. A checkpoint holds the
+ * result and sum extension, and a restore checks that they agree.
+ *
+ * The ADC workload samples a sensor on the ADC12_B (set up by Adc_Init()) into
+ * a FRAM sample log. A chunk is a batch of samples: the conversions run back
+ * to back and a DMA channel triggered by each result moves it from ADC12MEM0
+ * to the log, while the CPU sleeps in LPM0 (Workload_AdcWaitChunk()). The
+ * batch is then reduced in place to a running minimum, maximum and sum. The
+ * DMA stops at the end of the log, where the DMA interrupt restarts it and
+ * the conversions at the start; a power loss stops both. What a chunk
+ * salvages is reduced from the log, so it survives a reset.
+ */
+
+#include <string.h>
+#include "driverlib.h"
+#include "workload.h"
+
+// Unit of the copy, checksum and CRC32 workloads, and its 16-bit words
+#define WORKLOAD_UNIT_SIZE          (16)
+#define WORKLOAD_UNIT_WORDS         (WORKLOAD_UNIT_SIZE / sizeof(uint16_t))
+#define WORKLOAD_REGION_WORDS       (WORKLOAD_REGION_SIZE / sizeof(uint16_t))
+// Fletcher-32 sums are kept modulo this
+#define WORKLOAD_FLETCHER_MODULUS   (65535UL)
+// 32-bit words per unit of the CRC32 workload, and in its region
+#define WORKLOAD_UNIT_LONGS         (WORKLOAD_UNIT_SIZE / sizeof(uint32_t))
+#define WORKLOAD_SCAN_REGION_LONGS  (WORKLOAD_SCAN_REGION_SIZE / sizeof(uint32_t))
+// Seed of every pass of the CRC32 workload
+#define WORKLOAD_CRC32_SEED         (0xFFFFFFFFUL)
+// Taps of the FIR workload, one output per this many samples, and the
+// outputs it keeps
+#define WORKLOAD_FIR_TAPS           (32)
+#define WORKLOAD_FIR_OUTPUTS        (64)
+// Fraction bits of the taps (Q15)
+#define WORKLOAD_FIR_FRACTION_BITS  (15)
+// Samples (one per 16-bit word) per unit of the ADC workload
+#define WORKLOAD_ADC_UNIT_SAMPLES   (WORKLOAD_UNIT_WORDS)
+// DMA channel of the ADC workload and the ADC12 trigger it answers to (see the
+// MSP430FR5994 datasheet's DMA trigger assignments). The AES DMA engine has
+// channels 0 and 1.
+#define WORKLOAD_ADC_DMA_CHANNEL    (DMA_CHANNEL_2)
+#define WORKLOAD_ADC_DMA_TRIGGER    (DMA_TRIGGERSOURCE_26)
+// Conversion memory Adc_Init() sets up
+#define WORKLOAD_ADC_MEMORY         (ADC12_B_MEMORY_0)
+// Full scale of a 12-bit result, the most an extreme can be
+#define WORKLOAD_ADC_MAX_SAMPLE     (0x0FFF)
+
+#pragma PERSISTENT(workloadSourceRegion)
+static uint16_t workloadSourceRegion[WORKLOAD_REGION_WORDS] = {0};
+
+#pragma PERSISTENT(workloadCopyRegion)
+static uint16_t workloadCopyRegion[WORKLOAD_REGION_WORDS] = {0};
+
+#pragma PERSISTENT(workloadScanRegion)
+static uint32_t workloadScanRegion[WORKLOAD_SCAN_REGION_LONGS] = {0};
+
+#pragma PERSISTENT(workloadFirOutput)
+static int32_t workloadFirOutput[WORKLOAD_FIR_OUTPUTS] = {0};
+
+#pragma PERSISTENT(workloadSampleLog)
+static uint16_t workloadSampleLog[WORKLOAD_REGION_WORDS] = {0};
+
+// ADC workload state: where the running DMA segment starts, samples left to
+// hand to the DMA after it, samples in it and samples finished before it
+static uint64_t workloadAdcOffset;
+static uint16_t workloadAdcSamplesLeft;
+static uint16_t workloadAdcSegmentSamples;
+static uint16_t workloadAdcSamplesDone;
+// Between Workload_AdcBeginChunk() and Workload_AdcEndChunk(), and while the
+// DMA runs
+static bool workloadAdcActive;
+static volatile bool workloadAdcRunning;
+
+// Triangular window in Q15, summing to one
+static const int16_t workloadFirTaps[WORKLOAD_FIR_TAPS] =
+{
+     120,  240,  360,  480,  600,  720,  840,  960,
+    1080, 1200, 1320, 1440, 1560, 1680, 1800, 1920,
+    1920, 1800, 1680, 1560, 1440, 1320, 1200, 1080,
+     960,  840,  720,  600,  480,  360,  240,  120,
+};
+
+/**
+ * @brief      Get the region word at a position
+ */
+static uint16_t Workload_RegionWord(uint64_t offset)
+{
+    return (uint16_t)((offset % WORKLOAD_REGION_SIZE) / sizeof(uint16_t));
+}
+
+/**
+ * @brief      Fill the source region with a pattern
+ */
+static void Workload_FillSource(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < WORKLOAD_REGION_WORDS; i++)
+    {
+        // Knuth's multiplicative hash of the word index
+        workloadSourceRegion[i] = (uint16_t)((i * 2654435761UL) >> 16);
+    }
+}
+
+static void Workload_AesInit(workloadState_t *state)
+{
+    Cipher_Rewind(&state->stream);
+}
+
+static void Workload_AesBeginChunk(workloadState_t *state, uint16_t units)
+{
+    Cipher_BeginChunk(&state->stream, units);
+}
+
+static void Workload_AesDoUnit(workloadState_t *state)
+{
+    Cipher_EncryptBlock(&state->stream);
+}
+
+static bool Workload_AesWaitChunk(workloadState_t *state, uint16_t *unitsDone)
+{
+    if (!Cipher_RunsWholeChunks(&state->stream))
+    {
+        return false;
+    }
+
+    *unitsDone = Cipher_WaitChunk(&state->stream);
+
+    return true;
+}
+
+static void Workload_AesEndChunk(workloadState_t *state)
+{
+    Cipher_EndChunk(&state->stream);
+}
+
+static void Workload_AesAdvance(workloadState_t *state, uint32_t units)
+{
+    Cipher_Advance(&state->stream, units);
+}
+
+/**
+ * @brief      Save the stream settings and its chaining (CBC) or counter
+ *             (CTR) block
+ */
+static void Workload_AesSaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    saved[0] = (uint8_t)state->stream.mode;
+    saved[1] = (uint8_t)state->stream.source;
+    saved[2] = (uint8_t)state->stream.engine;
+    memcpy(&saved[4], state->stream.chain, sizeof(state->stream.chain));
+}
+
+static bool Workload_AesRestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                     uint64_t offset)
+{
+    if ((saved[0] >= CIPHER_MODE_NUM) || (saved[1] >= CIPHER_SOURCE_NUM) || (saved[2] >= CIPHER_ENGINE_NUM))
+    {
+        return false;
+    }
+
+    state->stream.mode = (cipherMode_e)saved[0];
+    state->stream.source = (cipherSource_e)saved[1];
+    state->stream.engine = (cipherEngine_e)saved[2];
+    state->stream.offset = offset;
+    memcpy(state->stream.chain, &saved[4], sizeof(state->stream.chain));
+
+    return true;
+}
+
+static void Workload_CopyInit(workloadState_t *state)
+{
+    state->offset = 0;
+    Workload_FillSource();
+}
+
+static void Workload_CopyDoUnit(workloadState_t *state)
+{
+    uint16_t word = Workload_RegionWord(state->offset);
+    unsigned int i;
+
+    for (i = 0; i < WORKLOAD_UNIT_WORDS; i++)
+    {
+        workloadCopyRegion[word + i] = workloadSourceRegion[word + i];
+    }
+    state->offset += WORKLOAD_UNIT_SIZE;
+}
+
+static void Workload_CopyAdvance(workloadState_t *state, uint32_t units)
+{
+    // The units' copies are already in FRAM
+    state->offset += (uint64_t)units * WORKLOAD_UNIT_SIZE;
+}
+
+static void Workload_CopySaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    // Nothing beyond the position
+    (void)state;
+    (void)saved;
+}
+
+static bool Workload_CopyRestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                      uint64_t offset)
+{
+    (void)saved;
+    state->offset = offset;
+
+    return true;
+}
+
+static void Workload_ChecksumInit(workloadState_t *state)
+{
+    state->checksum.offset = 0;
+    state->checksum.sum1 = 0;
+    state->checksum.sum2 = 0;
+    Workload_FillSource();
+}
+
+static void Workload_ChecksumDoUnit(workloadState_t *state)
+{
+    workloadChecksumState_t *checksum = &state->checksum;
+    uint16_t word = Workload_RegionWord(checksum->offset);
+    uint32_t sum1 = checksum->sum1;
+    uint32_t sum2 = checksum->sum2;
+    unsigned int i;
+
+    // A unit's worth of words can't overflow the sums before they're reduced
+    for (i = 0; i < WORKLOAD_UNIT_WORDS; i++)
+    {
+        sum1 += workloadSourceRegion[word + i];
+        sum2 += sum1;
+    }
+    checksum->sum1 = (uint16_t)(sum1 % WORKLOAD_FLETCHER_MODULUS);
+    checksum->sum2 = (uint16_t)(sum2 % WORKLOAD_FLETCHER_MODULUS);
+    checksum->offset += WORKLOAD_UNIT_SIZE;
+}
+
+static void Workload_ChecksumAdvance(workloadState_t *state, uint32_t units)
+{
+    // The sums only lived in RAM; fold the units in again from the source
+    while (units-- > 0)
+    {
+        Workload_ChecksumDoUnit(state);
+    }
+}
+
+static void Workload_ChecksumSaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    memcpy(&saved[0], &state->checksum.sum1, sizeof(state->checksum.sum1));
+    memcpy(&saved[2], &state->checksum.sum2, sizeof(state->checksum.sum2));
+}
+
+static bool Workload_ChecksumRestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                          uint64_t offset)
+{
+    memcpy(&state->checksum.sum1, &saved[0], sizeof(state->checksum.sum1));
+    memcpy(&state->checksum.sum2, &saved[2], sizeof(state->checksum.sum2));
+    state->checksum.offset = offset;
+
+    return (state->checksum.sum1 < WORKLOAD_FLETCHER_MODULUS) &&
+           (state->checksum.sum2 < WORKLOAD_FLETCHER_MODULUS);
+}
+
+static void Workload_Crc32Init(workloadState_t *state)
+{
+    uint16_t i;
+
+    state->crc32.offset = 0;
+    state->crc32.signature = WORKLOAD_CRC32_SEED;
+    state->crc32.passSignature = 0;
+    for (i = 0; i < WORKLOAD_SCAN_REGION_LONGS; i++)
+    {
+        // Knuth's multiplicative hash of the word index
+        workloadScanRegion[i] = i * 2654435761UL;
+    }
+}
+
+static void Workload_Crc32BeginChunk(workloadState_t *state, uint16_t units)
+{
+    (void)units;
+    CRC32_setSeed(state->crc32.signature, CRC32_MODE);
+}
+
+static void Workload_Crc32DoUnit(workloadState_t *state)
+{
+    workloadCrc32State_t *crc32 = &state->crc32;
+    uint16_t word = (uint16_t)((crc32->offset % WORKLOAD_SCAN_REGION_SIZE) / sizeof(uint32_t));
+    unsigned int i;
+
+    if ((word == 0) && (crc32->offset != 0))
+    {
+        // A pass is over, the next one starts from the seed again
+        crc32->passSignature = CRC32_getResult(CRC32_MODE);
+        CRC32_setSeed(WORKLOAD_CRC32_SEED, CRC32_MODE);
+    }
+    for (i = 0; i < WORKLOAD_UNIT_LONGS; i++)
+    {
+        CRC32_set32BitData(workloadScanRegion[word + i]);
+    }
+    crc32->offset += WORKLOAD_UNIT_SIZE;
+}
+
+static void Workload_Crc32EndChunk(workloadState_t *state)
+{
+    state->crc32.signature = CRC32_getResult(CRC32_MODE);
+}
+
+static void Workload_Crc32Advance(workloadState_t *state, uint32_t units)
+{
+    // The signature only lived in the module; scan the units again
+    Workload_Crc32BeginChunk(state, 0);
+    while (units-- > 0)
+    {
+        Workload_Crc32DoUnit(state);
+    }
+    Workload_Crc32EndChunk(state);
+}
+
+static void Workload_Crc32SaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    memcpy(&saved[0], &state->crc32.signature, sizeof(state->crc32.signature));
+    memcpy(&saved[4], &state->crc32.passSignature, sizeof(state->crc32.passSignature));
+}
+
+static bool Workload_Crc32RestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                       uint64_t offset)
+{
+    memcpy(&state->crc32.signature, &saved[0], sizeof(state->crc32.signature));
+    memcpy(&state->crc32.passSignature, &saved[4], sizeof(state->crc32.passSignature));
+    state->crc32.offset = offset;
+
+    return true;
+}
+
+static void Workload_FirInit(workloadState_t *state)
+{
+    state->fir.offset = 0;
+    state->fir.accumulator = 0;
+    state->fir.sumExtension = 0;
+    Workload_FillSource();
+}
+
+static void Workload_FirDoUnit(workloadState_t *state)
+{
+    workloadFirState_t *fir = &state->fir;
+    uint16_t word = Workload_RegionWord(fir->offset);
+    uint16_t tap = (uint16_t)((fir->offset / sizeof(uint16_t)) % WORKLOAD_FIR_TAPS);
+    uint16_t interruptState;
+    unsigned int i;
+
+    interruptState = __get_interrupt_state();
+    __disable_interrupt();
+    MPY32_preloadResult(fir->accumulator);
+    for (i = 0; i < WORKLOAD_UNIT_WORDS; i++)
+    {
+        // A 32-bit first operand makes the accumulate 64 bits wide
+        MPY32_setOperandOne32Bit(MPY32_MULTIPLYACCUMULATE_SIGNED,
+                                 (uint32_t)(int32_t)(int16_t)workloadSourceRegion[word + i]);
+        MPY32_setOperandTwo16Bit((uint16_t)workloadFirTaps[tap + i]);
+    }
+    fir->accumulator = MPY32_getResult();
+    fir->sumExtension = MPY32_getSumExtension();
+    __set_interrupt_state(interruptState);
+
+    fir->offset += WORKLOAD_UNIT_SIZE;
+    if ((tap + WORKLOAD_UNIT_WORDS) == WORKLOAD_FIR_TAPS)
+    {
+        // The window is done, put its output out and start the next one
+        workloadFirOutput[(fir->offset / (WORKLOAD_FIR_TAPS * sizeof(uint16_t))) % WORKLOAD_FIR_OUTPUTS] =
+            (int32_t)((int64_t)fir->accumulator >> WORKLOAD_FIR_FRACTION_BITS);
+        fir->accumulator = 0;
+        fir->sumExtension = 0;
+    }
+}
+
+static void Workload_FirAdvance(workloadState_t *state, uint32_t units)
+{
+    // The sum only lived in the multiplier; filter the units again
+    while (units-- > 0)
+    {
+        Workload_FirDoUnit(state);
+    }
+}
+
+static void Workload_FirSaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    memcpy(&saved[0], &state->fir.accumulator, sizeof(state->fir.accumulator));
+    memcpy(&saved[8], &state->fir.sumExtension, sizeof(state->fir.sumExtension));
+}
+
+static bool Workload_FirRestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                     uint64_t offset)
+{
+    memcpy(&state->fir.accumulator, &saved[0], sizeof(state->fir.accumulator));
+    memcpy(&state->fir.sumExtension, &saved[8], sizeof(state->fir.sumExtension));
+    state->fir.offset = offset;
+
+    // A signed accumulate leaves the result's sign in the sum extension
+    return state->fir.sumExtension == (((int64_t)state->fir.accumulator < 0) ? 0xFFFF : 0x0000);
+}
+
+static void Workload_AdcInit(workloadState_t *state)
+{
+    state->adc.offset = 0;
+    state->adc.sum = 0;
+    state->adc.minimum = UINT16_MAX;
+    state->adc.maximum = 0;
+}
+
+/**
+ * @brief      Fold units of samples in the log into the reduction
+ */
+static void Workload_AdcReduce(workloadState_t *state, uint32_t units)
+{
+    workloadAdcState_t *adc = &state->adc;
+    uint16_t word;
+    uint16_t sample;
+    unsigned int i;
+
+    while (units-- > 0)
+    {
+        word = Workload_RegionWord(adc->offset);
+        for (i = 0; i < WORKLOAD_ADC_UNIT_SAMPLES; i++)
+        {
+            sample = workloadSampleLog[word + i];
+            adc->sum += sample;
+            if (sample < adc->minimum)
+            {
+                adc->minimum = sample;
+            }
+            if (sample > adc->maximum)
+            {
+                adc->maximum = sample;
+            }
+        }
+        adc->offset += WORKLOAD_UNIT_SIZE;
+    }
+}
+
+/**
+ * @brief      Hand the DMA the next run of samples that doesn't wrap around
+ *             the log, and start the conversions
+ */
+static void Workload_AdcStartSegment(void)
+{
+    uint16_t position = Workload_RegionWord(workloadAdcOffset);
+    uint16_t samples = WORKLOAD_REGION_WORDS - position;
+
+    if (samples > workloadAdcSamplesLeft)
+    {
+        samples = workloadAdcSamplesLeft;
+    }
+    workloadAdcSegmentSamples = samples;
+    workloadAdcSamplesLeft -= samples;
+
+    DMA_setTransferSize(WORKLOAD_ADC_DMA_CHANNEL, samples);
+    DMA_setSrcAddress(WORKLOAD_ADC_DMA_CHANNEL, ADC12_B_getMemoryAddressForDMA(ADC12_B_BASE, WORKLOAD_ADC_MEMORY),
+                      DMA_DIRECTION_UNCHANGED);
+    DMA_setDstAddress(WORKLOAD_ADC_DMA_CHANNEL, (uint32_t)(uintptr_t)&workloadSampleLog[position],
+                      DMA_DIRECTION_INCREMENT);
+    DMA_enableTransfers(WORKLOAD_ADC_DMA_CHANNEL);
+
+    // A result left from before would never raise the trigger again
+    ADC12_B_clearInterrupt(ADC12_B_BASE, 0, ADC12_B_IFG0);
+    ADC12_B_startConversion(ADC12_B_BASE, WORKLOAD_ADC_MEMORY, ADC12_B_REPEATED_SINGLECHANNEL);
+}
+
+/**
+ * @brief      Fold the running DMA segment into the finished samples, counting
+ *             only what the DMA moved if it was stopped early
+ */
+static void Workload_AdcCountSegment(void)
+{
+    uint16_t samples = workloadAdcSegmentSamples;
+
+    if (DMA_getInterruptStatus(WORKLOAD_ADC_DMA_CHANNEL) != 0)
+    {
+        DMA_clearInterrupt(WORKLOAD_ADC_DMA_CHANNEL);
+    }
+    else
+    {
+        samples -= DMA_getTransferSize(WORKLOAD_ADC_DMA_CHANNEL);
+    }
+    workloadAdcSamplesDone += samples;
+    workloadAdcOffset += (uint64_t)workloadAdcSegmentSamples * sizeof(uint16_t);
+    workloadAdcSegmentSamples = 0;
+}
+
+static void Workload_AdcBeginChunk(workloadState_t *state, uint16_t units)
+{
+    DMA_initParam dmaParam = {0};
+
+    if (units == 0)
+    {
+        return;
+    }
+
+    workloadAdcActive = true;
+    workloadAdcOffset = state->adc.offset;
+    workloadAdcSamplesLeft = units * WORKLOAD_ADC_UNIT_SAMPLES;
+    workloadAdcSamplesDone = 0;
+
+    dmaParam.channelSelect = WORKLOAD_ADC_DMA_CHANNEL;
+    dmaParam.transferModeSelect = DMA_TRANSFER_SINGLE;
+    dmaParam.transferUnitSelect = DMA_SIZE_SRCWORD_DSTWORD;
+    dmaParam.triggerTypeSelect = DMA_TRIGGER_RISINGEDGE;
+    dmaParam.triggerSourceSelect = WORKLOAD_ADC_DMA_TRIGGER;
+    DMA_init(&dmaParam);
+    DMA_clearInterrupt(WORKLOAD_ADC_DMA_CHANNEL);
+    DMA_enableInterrupt(WORKLOAD_ADC_DMA_CHANNEL);
+
+    workloadAdcRunning = true;
+    Workload_AdcStartSegment();
+}
+
+/**
+ * @brief      Sleep in LPM0 while the DMA logs a chunk's samples, until it is
+ *             done or a power loss stops it, then reduce the units it
+ *             finished
+ */
+static bool Workload_AdcWaitChunk(workloadState_t *state, uint16_t *unitsDone)
+{
+    uint16_t units;
+
+    __disable_interrupt();
+    while (workloadAdcRunning)
+    {
+        // Interrupts come back on with the sleep, so a wake-up can't slip in
+        // between the check and the sleep
+        __bis_SR_register(LPM0_bits | GIE);
+        __disable_interrupt();
+    }
+    units = workloadAdcSamplesDone / WORKLOAD_ADC_UNIT_SAMPLES;
+    __enable_interrupt();
+
+    Workload_AdcReduce(state, units);
+    *unitsDone = units;
+
+    return true;
+}
+
+/**
+ * @brief      Stop a chunk the DMA is logging, from the power-loss interrupt
+ */
+static bool Workload_AdcAbortChunk(uint16_t *unitsDone)
+{
+    if (!workloadAdcActive)
+    {
+        return false;
+    }
+
+    if (workloadAdcRunning)
+    {
+        ADC12_B_disableConversions(ADC12_B_BASE, ADC12_B_PREEMPTCONVERSION);
+        DMA_disableTransfers(WORKLOAD_ADC_DMA_CHANNEL);
+        Workload_AdcCountSegment();
+        workloadAdcSamplesLeft = 0;
+        workloadAdcRunning = false;
+    }
+    *unitsDone = workloadAdcSamplesDone / WORKLOAD_ADC_UNIT_SAMPLES;
+
+    return true;
+}
+
+static void Workload_AdcEndChunk(workloadState_t *state)
+{
+    (void)state;
+
+    if (!workloadAdcActive)
+    {
+        return;
+    }
+
+    DMA_disableInterrupt(WORKLOAD_ADC_DMA_CHANNEL);
+    workloadAdcActive = false;
+}
+
+static void Workload_AdcAdvance(workloadState_t *state, uint32_t units)
+{
+    // The units' samples are already in the log
+    Workload_AdcReduce(state, units);
+}
+
+static void Workload_AdcSaveState(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE])
+{
+    memcpy(&saved[0], &state->adc.sum, sizeof(state->adc.sum));
+    memcpy(&saved[8], &state->adc.minimum, sizeof(state->adc.minimum));
+    memcpy(&saved[10], &state->adc.maximum, sizeof(state->adc.maximum));
+}
+
+static bool Workload_AdcRestoreState(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                                     uint64_t offset)
+{
+    memcpy(&state->adc.sum, &saved[0], sizeof(state->adc.sum));
+    memcpy(&state->adc.minimum, &saved[8], sizeof(state->adc.minimum));
+    memcpy(&state->adc.maximum, &saved[10], sizeof(state->adc.maximum));
+    state->adc.offset = offset;
+
+    if (offset == 0)
+    {
+        // Nothing reduced yet
+        return (state->adc.sum == 0) && (state->adc.minimum == UINT16_MAX) && (state->adc.maximum == 0);
+    }
+
+    return (state->adc.minimum <= state->adc.maximum) && (state->adc.maximum <= WORKLOAD_ADC_MAX_SAMPLE);
+}
+
+/**
+ * @brief      Handle the DMA interrupt: the ADC workload's channel finished a
+ *             segment
+ */
+void Workload_ServiceDma(void)
+{
+    if (!workloadAdcRunning || (DMA_getInterruptStatus(WORKLOAD_ADC_DMA_CHANNEL) == 0))
+    {
+        return;
+    }
+
+    // Stop converting while the DMA is handed the next segment
+    ADC12_B_disableConversions(ADC12_B_BASE, ADC12_B_PREEMPTCONVERSION);
+    Workload_AdcCountSegment();
+    if (workloadAdcSamplesLeft != 0)
+    {
+        Workload_AdcStartSegment();
+    }
+    else
+    {
+        workloadAdcRunning = false;
+    }
+}
+
+const workload_t workloadTable[WORKLOAD_NUM] =
+{
+    // WORKLOAD_AES
+    {
+        "AES",
+        CIPHER_BLOCK_SIZE,
+        Workload_AesInit,
+        Workload_AesBeginChunk,
+        Workload_AesDoUnit,
+        Workload_AesWaitChunk,
+        Cipher_AbortChunk,
+        Workload_AesEndChunk,
+        Workload_AesAdvance,
+        Workload_AesSaveState,
+        Workload_AesRestoreState,
+    },
+    // WORKLOAD_COPY
+    {
+        "FRAM Copy",
+        WORKLOAD_UNIT_SIZE,
+        Workload_CopyInit,
+        NULL,
+        Workload_CopyDoUnit,
+        NULL,
+        NULL,
+        NULL,
+        Workload_CopyAdvance,
+        Workload_CopySaveState,
+        Workload_CopyRestoreState,
+    },
+    // WORKLOAD_CHECKSUM
+    {
+        "Fletcher-32 Checksum",
+        WORKLOAD_UNIT_SIZE,
+        Workload_ChecksumInit,
+        NULL,
+        Workload_ChecksumDoUnit,
+        NULL,
+        NULL,
+        NULL,
+        Workload_ChecksumAdvance,
+        Workload_ChecksumSaveState,
+        Workload_ChecksumRestoreState,
+    },
+    // WORKLOAD_CRC32
+    {
+        "CRC32 Integrity Scan",
+        WORKLOAD_UNIT_SIZE,
+        Workload_Crc32Init,
+        Workload_Crc32BeginChunk,
+        Workload_Crc32DoUnit,
+        NULL,
+        NULL,
+        Workload_Crc32EndChunk,
+        Workload_Crc32Advance,
+        Workload_Crc32SaveState,
+        Workload_Crc32RestoreState,
+    },
+    // WORKLOAD_FIR
+    {
+        "MPY32 Decimating FIR",
+        WORKLOAD_UNIT_SIZE,
+        Workload_FirInit,
+        NULL,
+        Workload_FirDoUnit,
+        NULL,
+        NULL,
+        NULL,
+        Workload_FirAdvance,
+        Workload_FirSaveState,
+        Workload_FirRestoreState,
+    },
+    // WORKLOAD_ADC
+    {
+        "ADC12 Sensor Sampling",
+        WORKLOAD_UNIT_SIZE,
+        Workload_AdcInit,
+        Workload_AdcBeginChunk,
+        NULL,
+        Workload_AdcWaitChunk,
+        Workload_AdcAbortChunk,
+        Workload_AdcEndChunk,
+        Workload_AdcAdvance,
+        Workload_AdcSaveState,
+        Workload_AdcRestoreState,
+    },
+};
@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2020 Michel Kakulphimp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ ******************************************************************************/
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cipher.h"
+
+// Bytes of a workload's state a checkpoint holds, besides its position
+#define WORKLOAD_SAVED_STATE_SIZE   (20)
+// Size of the FRAM regions the copy and checksum workloads stream through,
+// the position wraps around them (multiple of every unit size)
+#define WORKLOAD_REGION_SIZE        (4096)
+// Size of the FRAM region the CRC32 workload scans, one pass per wrap
+#define WORKLOAD_SCAN_REGION_SIZE   (8192)
+
+typedef enum
+{
+    // AES encryption through the cipher stream
+    WORKLOAD_AES = 0,
+    // FRAM to FRAM copy, memory bound and stateless
+    WORKLOAD_COPY = 1,
+    // Fletcher-32 checksum in software, CPU bound with running sums
+    WORKLOAD_CHECKSUM = 2,
+    // CRC32 module integrity scan, cheap per byte with its signature in the
+    // module
+    WORKLOAD_CRC32 = 3,
+    // Decimating FIR filter on the MPY32, compute bound with its accumulator
+    // in the multiplier
+    WORKLOAD_FIR = 4,
+    // ADC12_B sensor sampling by DMA into a FRAM log, I/O bound with the CPU
+    // asleep
+    WORKLOAD_ADC = 5,
+    WORKLOAD_NUM = 6,
+} workloadType_e;
+
+typedef struct
+{
+    // Position of the next unit
+    uint64_t offset;
+    // Fletcher-32 running sums, reduced modulo 65535
+    uint16_t sum1;
+    uint16_t sum2;
+} workloadChecksumState_t;
+
+typedef struct
+{
+    // Position of the next unit
+    uint64_t offset;
+    // Signature of the pass so far, the CRC32 module's seed for the next
+    // unit
+    uint32_t signature;
+    // Signature of the last whole pass over the region
+    uint32_t passSignature;
+} workloadCrc32State_t;
+
+typedef struct
+{
+    // Position of the next unit
+    uint64_t offset;
+    // MPY32 result and sum extension after the last unit, the sum of the
+    // output being filtered so far
+    uint64_t accumulator;
+    uint16_t sumExtension;
+} workloadFirState_t;
+
+typedef struct
+{
+    // Position of the next unit
+    uint64_t offset;
+    // Reduction of every sample logged so far: their sum, for the mean, and
+    // their extremes
+    uint64_t sum;
+    uint16_t minimum;
+    uint16_t maximum;
+} workloadAdcState_t;
+
+// State a workload carries from unit to unit, whichever workload it is. Its
+// position is the bytes of work done, so it lines up with bytesProcessed.
+typedef union
+{
+    // WORKLOAD_AES: the cipher stream, settings included
+    cipherStream_t stream;
+    // WORKLOAD_COPY: position of the next unit
+    uint64_t offset;
+    // WORKLOAD_CHECKSUM
+    workloadChecksumState_t checksum;
+    // WORKLOAD_CRC32
+    workloadCrc32State_t crc32;
+    // WORKLOAD_FIR
+    workloadFirState_t fir;
+    // WORKLOAD_ADC
+    workloadAdcState_t adc;
+} workloadState_t;
+
+typedef struct
+{
+    // Name shown in the settings
+    const char *name;
+    // Bytes of work in one unit, the granularity of progress and salvage
+    uint16_t unitSize;
+    // Move the state back to the start of a run, keeping its settings
+    void (*init)(workloadState_t *state);
+    // Get ready for a chunk of units (optional)
+    void (*beginChunk)(workloadState_t *state, uint16_t units);
+    // Do the next unit (optional if waitChunk() runs every chunk)
+    void (*doUnit)(workloadState_t *state);
+    // Run a chunk as a whole, off the CPU while it sleeps or on it in runs
+    // of units, until it is done, and get the units it finished. Returns
+    // false if the chunk's units go through doUnit() instead (optional).
+    bool (*waitChunk)(workloadState_t *state, uint16_t *unitsDone);
+    // Stop a chunk run as a whole, from the power-loss interrupt, and get
+    // the units it finished. Returns false if none is running (optional).
+    bool (*abortChunk)(uint16_t *unitsDone);
+    // Finish a chunk, whether it ran all of its units or not (optional)
+    void (*endChunk)(workloadState_t *state);
+    // Move a committed state past units a chunk finished, from what they
+    // left in FRAM
+    void (*advance)(workloadState_t *state, uint32_t units);
+    // Pack the state into a checkpoint, and unpack it again at a position.
+    // Unpacking fails on state that can't be this workload's.
+    void (*saveState)(const workloadState_t *state, uint8_t saved[WORKLOAD_SAVED_STATE_SIZE]);
+    bool (*restoreState)(workloadState_t *state, const uint8_t saved[WORKLOAD_SAVED_STATE_SIZE],
+                         uint64_t offset);
+} workload_t;
+
+// The workloads, indexed by workloadType_e
+extern const workload_t workloadTable[WORKLOAD_NUM];
+
+void Workload_ServiceDma(void);
+
+#endif // WORKLOAD_H